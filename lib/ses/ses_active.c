@@ -0,0 +1,166 @@
+/* INCLUDES ******************************************************************/
+#include <stdlib.h>
+#include <util/atomic.h>
+
+#include "ses_active.h"
+#include "ses_scheduler.h"
+#include "ses_log.h"
+
+/* PRIVATE VARIABLES *********************************************************/
+
+// started active objects by priority
+static active_t * activeObjects[ACTIVE_MAX];
+
+// one bit per priority with queued events
+static volatile uint8_t readyMask = 0;
+
+// one bit per priority of the subscribers of each signal
+static uint8_t subscribers[ACTIVE_MAX_SIGNALS];
+
+// highest set bit of a nibble
+static const uint8_t highestBit[16] = {
+    0, 0, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3
+};
+
+/*
+ * Dispatches the ready active objects. It has a period of 1ms only while
+ * events are queued; after the last event its period drops to 0 and the
+ * scheduler removes it, a post gives it the period back. The cyclic
+ * executive runs active_dispatchOne in its frame table instead.
+ */
+static task_descriptor_t dispatchTask;
+
+/*FUNCTION DEFINITION ********************************************************/
+
+static uint8_t active_highestReady(uint8_t mask) {
+    return (mask & 0xF0) ? highestBit[mask >> 4] + 4 : highestBit[mask];
+}
+
+/* takes the oldest event of the highest ready priority, false if none is
+queued; called in an atomic section */
+static bool active_take(active_t ** ao, fsm_event_t * event) {
+    if(readyMask == 0){
+        return false;
+    }
+
+    *ao = activeObjects[active_highestReady(readyMask)];
+    *event = (*ao)->queue[(*ao)->head];
+    (*ao)->head = ((*ao)->head + 1 < (*ao)->queueLength) ? (*ao)->head + 1 : 0;
+    if(--(*ao)->count == 0){
+        readyMask &= ~(1 << (*ao)->priority);
+    }
+    return true;
+}
+
+static void active_dispatchTask(void * param) {
+    for(;;){
+        fsm_event_t event;
+        active_t * ao;
+
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+            if(!active_take(&ao, &event)){
+                dispatchTask.period = 0;
+                return;
+            }
+        }
+
+        // run to completion, events posted meanwhile are queued
+        fsm_dispatch(&ao->machine, &event);
+    }
+}
+
+void active_dispatchOne(void * param) {
+    fsm_event_t event;
+    active_t * ao;
+    bool taken;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        taken = active_take(&ao, &event);
+    }
+
+    if(taken){
+        fsm_dispatch(&ao->machine, &event);
+    }
+}
+
+bool active_start(active_t * ao, uint8_t priority, fsm_event_t * queue, uint8_t length,
+                  const fsm_definition_t * definition, void * context, uint8_t initial) {
+    if(ao == NULL || queue == NULL || length == 0 || priority >= ACTIVE_MAX || activeObjects[priority] != NULL){
+        return false;
+    }
+
+    ao->queue       = queue;
+    ao->queueLength = length;
+    ao->head        = 0;
+    ao->count       = 0;
+    ao->priority    = priority;
+
+    dispatchTask.task  = active_dispatchTask;
+    dispatchTask.param = NULL;
+
+    fsm_init(&ao->machine, definition, context, initial);
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        activeObjects[priority] = ao;
+    }
+    return true;
+}
+
+bool active_post(active_t * ao, const fsm_event_t * event) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        if(ao->count >= ao->queueLength){
+            LOG2(ACTIVE_DROPPED, ao->priority, event->signal);
+            return false;
+        }
+
+        uint8_t tail = ao->head + ao->count;
+        if(tail >= ao->queueLength){
+            tail -= ao->queueLength;
+        }
+        ao->queue[tail] = *event;
+        ao->count++;
+        readyMask |= 1 << ao->priority;
+
+#if SCHEDULER_MODE != SCHEDULER_CYCLIC
+        // the dispatcher may still be in the task list, then its period keeps it there
+        if(dispatchTask.period == 0){
+            dispatchTask.expire = 1;
+            dispatchTask.period = 1;
+            scheduler_add(&dispatchTask);
+        }
+#endif
+    }
+    return true;
+}
+
+void active_subscribe(const active_t * ao, uint8_t signal) {
+    if(signal < ACTIVE_MAX_SIGNALS){
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+            subscribers[signal] |= 1 << ao->priority;
+        }
+    }
+}
+
+void active_unsubscribe(const active_t * ao, uint8_t signal) {
+    if(signal < ACTIVE_MAX_SIGNALS){
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+            subscribers[signal] &= ~(1 << ao->priority);
+        }
+    }
+}
+
+uint8_t active_publish(const fsm_event_t * event) {
+    uint8_t delivered = 0;
+
+    if(event->signal >= ACTIVE_MAX_SIGNALS){
+        return 0;
+    }
+
+    uint8_t mask = subscribers[event->signal];
+    for(uint8_t priority = 0; mask != 0; priority++, mask >>= 1){
+        if((mask & 1) && active_post(activeObjects[priority], event)){
+            delivered++;
+        }
+    }
+    return delivered;
+}
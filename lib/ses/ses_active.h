@@ -0,0 +1,92 @@
+#ifndef SES_ACTIVE_H_
+#define SES_ACTIVE_H_
+
+/* INCLUDES ******************************************************************/
+
+#include <stdbool.h>
+#include <inttypes.h>
+#include "ses_fsm.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+/* number of priorities, each is taken by one active object; 0 is the lowest */
+#define ACTIVE_MAX              8
+
+/* signals which can be published, signals are shared by all active objects */
+#ifndef ACTIVE_MAX_SIGNALS
+#define ACTIVE_MAX_SIGNALS      16
+#endif
+
+/* TYPES *********************************************************************/
+
+/**
+ * An active object: a state machine with its own event queue and priority.
+ * Events are posted from tasks or interrupts and dispatched one at a time,
+ * each runs to completion before the next one is taken.
+ */
+typedef struct {
+    fsm_machine_t machine;  ///< the state machine
+    fsm_event_t * queue;    ///< ring buffer of queueLength events
+    uint8_t queueLength;
+    uint8_t head;           ///< oldest event
+    uint8_t count;          ///< queued events
+    uint8_t priority;       ///< 0 ... ACTIVE_MAX - 1, higher is dispatched first
+} active_t;
+
+/* FUNCTION PROTOTYPES *******************************************************/
+
+/**
+ * Starts an active object and runs the entry actions of its initial state.
+ *
+ * @param ao          the active object
+ * @param priority    unused priority 0 ... ACTIVE_MAX - 1
+ * @param queue       storage of the event queue
+ * @param length      events of the queue
+ * @param definition  transition table and states of the state machine
+ * @param context     passed to all actions
+ * @param initial     initial state
+ *
+ * @return            false, if the priority is invalid or taken
+ */
+bool active_start(active_t * ao, uint8_t priority, fsm_event_t * queue, uint8_t length,
+                  const fsm_definition_t * definition, void * context, uint8_t initial);
+
+/**
+ * Queues an event for an active object and releases the dispatcher task,
+ * may be called from interrupts.
+ *
+ * @return        false, if the queue is full and the event was dropped
+ */
+bool active_post(active_t * ao, const fsm_event_t * event);
+
+/**
+ * Dispatches the oldest event of the highest ready priority, if any. The
+ * dynamic scheduler dispatches all queued events in a task of its own; the
+ * cyclic executive runs this function in a slot of its frame table, which
+ * bounds the work of the slot to one event.
+ *
+ * @param param   unused
+ */
+void active_dispatchOne(void * param);
+
+/**
+ * Posts the events of a signal to an active object from now on.
+ *
+ * @param signal  signal below ACTIVE_MAX_SIGNALS
+ */
+void active_subscribe(const active_t * ao, uint8_t signal);
+
+/**
+ * Stops posting the events of a signal to an active object.
+ */
+void active_unsubscribe(const active_t * ao, uint8_t signal);
+
+/**
+ * Posts an event to every active object which subscribed its signal, may be
+ * called from interrupts.
+ *
+ * @return        number of active objects the event was queued for
+ */
+uint8_t active_publish(const fsm_event_t * event);
+
+#endif /* SES_ACTIVE_H_ */
@@ -1,5 +1,14 @@
+#define ADC_LUT_TABLES
 #include "ses_adc.h"
+#include <stdbool.h>
+#include <stdlib.h>
 #include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <avr/sleep.h>
+#include <util/atomic.h>
+#include "ses_board.h"
+#include "ses_timer.h"
 
 /* ADC clock prescaler: division factor is 128 */
 #define ADC_PRESCALE            0x07
@@ -8,6 +17,11 @@
 /* ADPS0-2 bit position in ADEN */
 #define ADC_PRESCALE_BIT_POS    ADPS0
 
+/* ADC clock cycles of a conversion, except the first one after enabling */
+#define ADC_CONVERSION_CYCLES   13
+/* CPU cycles of a conversion */
+#define ADC_CONVERSION_CPU_CYC  (ADC_CONVERSION_CYCLES * 128)
+
 /* ADC external reference voltage source */
 #define ADC_VREF_SRC            0x00
 /* ADC reference voltage source mask */
@@ -15,52 +29,104 @@
 /* REFS0-REFS1 bit position in ADMUX register */
 #define ADC_VREF_BIT_POS        REFS0
 
+/* ADC auto trigger source mask, free running mode is 0 */
+#define ADC_TRIGGER_SRC_MASK    0x07
+/* ADTS0-2 bit position in ADCSRB register */
+#define ADC_TRIGGER_SRC_BIT_POS ADTS0
+
 /* ADC channel mux mask */
 #define ADC_MUX_BIT_MASK        0x1F
 /* MUX0-4 bit position in ADMUX register*/
 #define ADC_MUX_BIT_POS         MUX0
 
-/* Interpolation low temperature */
-#define ADC_TEMP_LOW            10
-/* Interpolation high temperature */
-#define ADC_TEMP_HIGH           30
+/* largest raw ADC value */
+#define ADC_RAW_MAX             1023
+
+/* number of channels with a lookup table */
+#define ADC_LUT_CHANNELS        2
+
+
+/* number of channels converted by the sampler */
+#define ADC_SAMPLER_CHANNELS    3
+
+/* marks a channel which is not converted by the sampler */
+#define ADC_SAMPLER_NO_INDEX    0xFF
+
+/* TYPES *********************************************************************/
+
+/* samples of one channel, written by the ADC interrupt */
+typedef struct {
+    volatile uint16_t latest;
+    uint16_t samples[ADC_SAMPLER_BUFFER_SIZE];
+    volatile uint8_t head;
+    volatile uint8_t tail;
+    adc_filter_t filter;
+    volatile bool filterEnabled;
+    volatile uint16_t filtered;
+} adc_channelBuffer_t;
+
+
+/* lookup table of a sensor, generated into flash or given by the user in RAM */
+typedef struct {
+    uint8_t channel;
+    const adc_lutPoint_t * flashTable;
+    uint8_t flashSize;
+    const adc_lutPoint_t * userTable;
+    uint8_t userSize;
+} adc_lut_t;
+
+
+/* PRIVATE VARIABLES *********************************************************/
+
+static adc_lut_t lookupTables[ADC_LUT_CHANNELS] = {
+    { .channel = ADC_TEMP_CH,  .flashTable = adc_lut_temperature, .flashSize = ADC_LUT_TEMPERATURE_SIZE },
+    { .channel = ADC_LIGHT_CH, .flashTable = adc_lut_light,       .flashSize = ADC_LUT_LIGHT_SIZE },
+};
+
+/* channels converted by the sampler, in conversion order */
+static const uint8_t samplerChannels[ADC_SAMPLER_CHANNELS] = { ADC_LIGHT_CH, ADC_POTI_CH, ADC_TEMP_CH };
 
-/* ADC raw value for the low temperature (10 Celsius) */
-#define ADC_TEMP_RAW_LOW        553
-/* ADC raw value for the high temperature (30 Celsius) */
-#define ADC_TEMP_RAW_HIGH       857
+static adc_channelBuffer_t channelBuffers[ADC_SAMPLER_CHANNELS];
 
+/* index of the channel whose result arrives with the next interrupt */
+static volatile uint8_t convertingIndex;
+/* index of the channel of the conversion started after it */
+static volatile uint8_t nextIndex;
 
-/* SES-board potentiometer PORT, DDR and PIN register macros */
-#define POTI_PORT            PORTF
-#define POTI_DDR             DDRF
-#define POTI_PIN             PINF
-#define POTI_BIT             6
+static volatile bool samplerRunning = false;
 
-/* SES-board temperature sensor PORT, DDR and PIN register macros */
-#define TEMP_PORT       PORTF
-#define TEMP_DDR        DDRF
-#define TEMP_PIN        PINF
-#define TEMP_BIT        7
+/* set by the interrupt when a noise reduced conversion is complete */
+static volatile bool conversionDone;
 
-/* SES-board light sensor PORT, DDR and PIN register macros */
-#define LIGHT_PORT     PORTF
-#define LIGHT_DDR      DDRF
-#define LIGHT_PIN      PINF
-#define LIGHT_BIT      0
+
+/* FUNCTION DEFINITION *******************************************************/
+
+static uint8_t adc_samplerIndex(uint8_t adc_channel){
+    for(uint8_t i = 0; i < ADC_SAMPLER_CHANNELS; i++){
+        if(samplerChannels[i] == adc_channel){
+            return i;
+        }
+    }
+    return ADC_SAMPLER_NO_INDEX;
+}
+
+static void adc_selectChannel(uint8_t adc_channel){
+    ADMUX &= ~(ADC_MUX_BIT_MASK << ADC_MUX_BIT_POS);
+    ADMUX |=  (ADC_MUX_BIT_MASK & adc_channel) << ADC_MUX_BIT_POS;
+}
 
 void adc_init(void){
     // Configure potentiometer analog input and disable internal pull-up resistor
-    POTI_DDR &= ~(1 << POTI_BIT);
-    POTI_PORT &= ~(1 << POTI_BIT);
+    pin_POTI_input();
+    pin_POTI_low();
 
     // Configure temperature sensor analog input and disable internal pull-up resistor
-    TEMP_DDR &= ~(1 << TEMP_BIT);
-    TEMP_PORT &= ~(1 << TEMP_BIT);
+    pin_TEMP_input();
+    pin_TEMP_low();
 
-    // Configure temperature sensor analog input and disable internal pull-up resistor
-    LIGHT_DDR &= ~(1 << LIGHT_BIT);
-    LIGHT_PORT &= ~(1 << LIGHT_BIT);
+    // Configure light sensor analog input and disable internal pull-up resistor
+    pin_LIGHT_input();
+    pin_LIGHT_low();
 
     // Disable ADC power reduction mode
     PRR0 &= ~(1 << PRADC);
@@ -95,9 +161,13 @@ uint16_t adc_read(uint8_t adc_channel){
         return ADC_INVALID_CHANNEL;
     }
 
+    // The sampler owns the ADC: return its latest sample instead of waiting
+    if(samplerRunning){
+        return adc_getLatest(adc_channel);
+    }
+
     // Select the correct channel
-    ADMUX &= ~(ADC_MUX_BIT_MASK << ADC_MUX_BIT_POS);
-    ADMUX |=  (ADC_MUX_BIT_MASK & adc_channel) << ADC_MUX_BIT_POS;
+    adc_selectChannel(adc_channel);
 
     // Start a single conversion
     ADCSRA |= (1 << ADSC);
@@ -110,9 +180,262 @@ uint16_t adc_read(uint8_t adc_channel){
 
 }
 
-int16_t adc_getTemperature(void){
+void adc_startSampler(void){
 
-    int32_t adc_raw = adc_read(ADC_TEMP_CH);
-    return (int16_t)(((adc_raw - ADC_TEMP_RAW_LOW) * (ADC_TEMP_HIGH - ADC_TEMP_LOW)) / (ADC_TEMP_RAW_HIGH - ADC_TEMP_RAW_LOW)) + ADC_TEMP_LOW;
+    if(samplerRunning){
+        return;
+    }
+
+    // Free running mode: the next conversion starts when the previous one completes
+    ADCSRB &= ~(ADC_TRIGGER_SRC_MASK << ADC_TRIGGER_SRC_BIT_POS);
+
+    /* The channel is latched one ADC clock after ADSC is set, so changing
+    the channel right after the start would switch the first conversion.
+    The second conversion keeps the first channel instead and the first
+    interrupt selects the second channel, like it does for every other one. */
+    convertingIndex = 0;
+    nextIndex = 0;
+    samplerRunning = true;
+
+    adc_selectChannel(samplerChannels[convertingIndex]);
+    ADCSRA |= (1 << ADIE) | (1 << ADATE) | (1 << ADSC);
+}
+
+void adc_stopSampler(void){
+
+    // Disable auto-triggering and the interrupt, the current conversion finishes on its own
+    ADCSRA &= ~((1 << ADATE) | (1 << ADIE));
+    samplerRunning = false;
+
+    // Wait for it, so the next conversion reads the selected channel
+    while(ADCSRA & (1 << ADSC));
+}
+
+uint16_t adc_readNoiseReduced(uint8_t adc_channel){
+    bool restartSampler = samplerRunning;
+    uint16_t result;
+
+    if(adc_samplerIndex(adc_channel) == ADC_SAMPLER_NO_INDEX){
+        return ADC_INVALID_CHANNEL;
+    }
+
+    adc_stopSampler();
+    adc_selectChannel(adc_channel);
+
+    // a flag left by the sampler would wake the CPU right away
+    ADCSRA |= (1 << ADIF);
+    ADCSRA |= (1 << ADIE);
+    conversionDone = false;
+
+    set_sleep_mode(SLEEP_MODE_ADC);
+    timer0_beginHalt();
+
+    /* Entering the sleep mode starts the conversion. Other interrupts may
+    wake the CPU earlier; sleeping again does not restart the conversion.
+    The flag is checked with interrupts disabled and sei only takes effect
+    after sleep_cpu, so the wake up interrupt cannot slip in between. */
+    do{
+        cli();
+        if(!conversionDone){
+            sleep_enable();
+            sei();
+            sleep_cpu();
+            sleep_disable();
+        }
+        sei();
+    } while(!conversionDone);
+
+    // timer 0 stood still while the CPU slept
+    timer0_endHalt(ADC_CONVERSION_CPU_CYC);
+
+    ADCSRA &= ~(1 << ADIE);
+    result = ADC;
+
+    if(restartSampler){
+        adc_startSampler();
+    }
+    return result;
+}
+
+uint16_t adc_getLatest(uint8_t adc_channel){
+    uint8_t index = adc_samplerIndex(adc_channel);
+    uint16_t sample;
+
+    if(index == ADC_SAMPLER_NO_INDEX){
+        return ADC_INVALID_CHANNEL;
+    }
+
+    // 16 bit value written by the interrupt
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        sample = channelBuffers[index].latest;
+    }
+    return sample;
+}
+
+uint8_t adc_takeSamples(uint8_t adc_channel, uint16_t * samples, uint8_t max){
+    uint8_t index = adc_samplerIndex(adc_channel);
+    uint8_t count = 0;
+
+    if(index == ADC_SAMPLER_NO_INDEX || samples == NULL){
+        return 0;
+    }
 
-}
\ No newline at end of file
+    adc_channelBuffer_t * buffer = &channelBuffers[index];
+
+    // the interrupt moves tail when it overwrites the oldest sample
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        while(count < max && buffer->tail != buffer->head){
+            samples[count++] = buffer->samples[buffer->tail & (ADC_SAMPLER_BUFFER_SIZE - 1)];
+            buffer->tail++;
+        }
+    }
+    return count;
+}
+
+bool adc_setFilter(uint8_t adc_channel, const adc_filterConfig_t * config){
+    uint8_t index = adc_samplerIndex(adc_channel);
+
+    if(index == ADC_SAMPLER_NO_INDEX){
+        return false;
+    }
+
+    adc_channelBuffer_t * buffer = &channelBuffers[index];
+
+    // the interrupt must not run the pipeline while it is reconfigured
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        buffer->filterEnabled = false;
+        if(config != NULL){
+            adc_filterInit(&buffer->filter, config);
+            buffer->filtered = ADC_INVALID_CHANNEL;
+            buffer->filterEnabled = true;
+        }
+    }
+    return true;
+}
+
+uint16_t adc_getFiltered(uint8_t adc_channel){
+    uint8_t index = adc_samplerIndex(adc_channel);
+    uint16_t value;
+
+    if(index == ADC_SAMPLER_NO_INDEX || !channelBuffers[index].filterEnabled){
+        return ADC_INVALID_CHANNEL;
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        value = channelBuffers[index].filtered;
+    }
+    return value;
+}
+
+ISR(ADC_vect){
+    // a noise reduced conversion only needs to wake the CPU
+    if(!samplerRunning){
+        conversionDone = true;
+        return;
+    }
+
+    adc_channelBuffer_t * buffer = &channelBuffers[convertingIndex];
+    uint16_t sample = ADC;
+
+    buffer->latest = sample;
+    buffer->samples[buffer->head & (ADC_SAMPLER_BUFFER_SIZE - 1)] = sample;
+    buffer->head++;
+
+    // buffer full: drop the oldest sample
+    if((uint8_t)(buffer->head - buffer->tail) > ADC_SAMPLER_BUFFER_SIZE){
+        buffer->tail++;
+    }
+
+    // filter pipeline runs incrementally, one sample at a time
+    if(buffer->filterEnabled){
+        uint16_t output;
+        if(adc_filterPush(&buffer->filter, sample, &output)){
+            buffer->filtered = output;
+        }
+    }
+
+    // the conversion of nextIndex is already running, select the channel after it
+    convertingIndex = nextIndex;
+    nextIndex = (nextIndex + 1 < ADC_SAMPLER_CHANNELS) ? nextIndex + 1 : 0;
+    adc_selectChannel(samplerChannels[nextIndex]);
+}
+
+static adc_lut_t * adc_lookupTable(uint8_t adc_channel){
+    for(uint8_t i = 0; i < ADC_LUT_CHANNELS; i++){
+        if(lookupTables[i].channel == adc_channel){
+            return &lookupTables[i];
+        }
+    }
+    return NULL;
+}
+
+static void adc_lutPoint(const adc_lut_t * lut, uint8_t index, adc_lutPoint_t * point){
+    if(lut->userTable != NULL){
+        *point = lut->userTable[index];
+    }
+    else{
+        memcpy_P(point, &lut->flashTable[index], sizeof(*point));
+    }
+}
+
+/* piecewise linear interpolation between two breakpoints. The segments are
+narrow where the curve is steep; the width of each one is a power of two,
+so no division is needed. */
+static int16_t adc_linearize(const adc_lut_t * lut, uint16_t raw){
+    uint8_t low = 0;
+    uint8_t high = (lut->userTable != NULL) ? lut->userSize - 1 : lut->flashSize - 1;
+    adc_lutPoint_t point, next;
+
+    // binary search of the segment, the first breakpoint is at 0, the last at 1024
+    while(high - low > 1){
+        uint8_t middle = (low + high) >> 1;
+
+        adc_lutPoint(lut, middle, &point);
+        if(raw < point.raw){
+            high = middle;
+        }
+        else{
+            low = middle;
+        }
+    }
+    adc_lutPoint(lut, low, &point);
+    adc_lutPoint(lut, high, &next);
+
+    // the difference of two values and the offset need a 32 bit product
+    return point.value + (int16_t)(((int32_t)(next.value - point.value) * (raw - point.raw)) >> point.shift);
+}
+
+static int16_t adc_readLinearized(uint8_t adc_channel){
+    uint16_t raw = adc_read(adc_channel);
+
+    // keep the segment inside the table
+    if(raw > ADC_RAW_MAX){
+        raw = ADC_RAW_MAX;
+    }
+    return adc_linearize(adc_lookupTable(adc_channel), raw);
+}
+
+bool adc_setCalibration(uint8_t adc_channel, const adc_lutPoint_t * table, uint8_t size){
+    adc_lut_t * lut = adc_lookupTable(adc_channel);
+
+    if(lut == NULL){
+        return false;
+    }
+
+    // the search relies on breakpoints at both ends of the raw range
+    if(table != NULL && (size < 2 || table[0].raw != ADC_LUT_START || table[size - 1].raw != ADC_LUT_END)){
+        return false;
+    }
+
+    lut->userTable = table;
+    lut->userSize = size;
+    return true;
+}
+
+int16_t adc_getTemperature(void){
+    return adc_readLinearized(ADC_TEMP_CH);
+}
+
+int16_t adc_getLight(void){
+    return adc_readLinearized(ADC_LIGHT_CH);
+}
@@ -5,6 +5,8 @@
 
 #include <inttypes.h>
 #include <avr/io.h>
+#include "ses_adc_filter.h"
+#include "ses_adc_lut.h"
 
 
 /* DEFINES & MACROS **********************************************************/
@@ -12,6 +14,9 @@
 /* to signal that the given channel was invalid */
 #define ADC_INVALID_CHANNEL    0xFFFF
 
+/* samples buffered per channel by the sampler (power of two) */
+#define ADC_SAMPLER_BUFFER_SIZE    8
+
 
 enum ADCChannels {
   ADC_LIGHT_CH = 0,        /* ADC0 */
@@ -29,16 +34,95 @@ void adc_init(void);
 
 
 /**
- * Read the raw ADC value of the given channel
+ * Read the raw ADC value of the given channel. Converts and waits for the
+ * result, unless the sampler is running; then the latest sample is returned
+ * without waiting.
  * @adc_channel The channel as element of the ADCChannels enum
  * @return The raw ADC value
  */
 uint16_t adc_read(uint8_t adc_channel);
 
+/**
+ * Read the raw ADC value of the given channel with the CPU in ADC noise
+ * reduction sleep during the conversion. A running sampler is paused for
+ * the conversion. Timer 0 halts while the CPU sleeps, the missed time is
+ * added to it afterwards, so the scheduler keeps its 1 ms tick.
+ * Must be called with interrupts enabled, i.e. from a task, not an interrupt.
+ * @adc_channel The channel as element of the ADCChannels enum
+ * @return The raw ADC value
+ */
+uint16_t adc_readNoiseReduced(uint8_t adc_channel);
+
+/**
+ * Starts the sampler: the ADC converts continuously in free running mode and
+ * the conversion complete interrupt stores the results round-robin for the
+ * light, potentiometer and temperature channel.
+ */
+void adc_startSampler(void);
+
+/**
+ * Stops the sampler and waits for the current conversion.
+ */
+void adc_stopSampler(void);
+
+/**
+ * Get the latest sample of a channel from the sampler without waiting
+ * @adc_channel The channel as element of the ADCChannels enum
+ * @return The raw ADC value, ADC_INVALID_CHANNEL if the channel is not sampled
+ */
+uint16_t adc_getLatest(uint8_t adc_channel);
+
+/**
+ * Take the buffered samples of a channel from the sampler, oldest first.
+ * Samples which were not taken are overwritten by newer ones.
+ * @adc_channel The channel as element of the ADCChannels enum
+ * @samples Buffer for the samples
+ * @max Size of the buffer
+ * @return Number of samples copied to the buffer
+ */
+uint8_t adc_takeSamples(uint8_t adc_channel, uint16_t * samples, uint8_t max);
+
+/**
+ * Configure the filter pipeline the sampler runs on every new sample of a
+ * channel. The pipeline restarts empty.
+ * @adc_channel The channel as element of the ADCChannels enum
+ * @config The filter stages, NULL switches filtering off
+ * @return false, if the channel is not sampled
+ */
+bool adc_setFilter(uint8_t adc_channel, const adc_filterConfig_t * config);
+
+/**
+ * Get the latest output of the filter pipeline of a channel without waiting
+ * @adc_channel The channel as element of the ADCChannels enum
+ * @return The filtered value with 10 + oversampleBits bits, ADC_INVALID_CHANNEL
+ *         if the channel is not sampled or not filtered or before the first output
+ */
+uint16_t adc_getFiltered(uint8_t adc_channel);
+
+/**
+ * Replace the lookup table of a sensor by a calibration table in RAM, e.g.
+ * one printed by tools/gen_adc_lut.py --print. The table is not copied and
+ * must stay valid while it is used.
+ * @adc_channel ADC_TEMP_CH or ADC_LIGHT_CH
+ * @table Breakpoints from raw ADC_LUT_START to ADC_LUT_END, the segment after
+ *        a breakpoint is 2^shift raw counts wide; NULL restores the table
+ *        generated from ses_adc_calibration.csv
+ * @size Number of breakpoints
+ * @return false, if the channel has no lookup table or the table does not
+ *         cover the raw range
+ */
+bool adc_setCalibration(uint8_t adc_channel, const adc_lutPoint_t * table, uint8_t size);
+
 /**
  * Read the current temperature
  * @return Temperature in tenths of degree celsius
  */
 int16_t adc_getTemperature(void);
 
+/**
+ * Read the current illuminance
+ * @return Illuminance in lux
+ */
+int16_t adc_getLight(void);
+
 #endif /* SES_ADC_H */
@@ -0,0 +1,124 @@
+#include "ses_adc_filter.h"
+#include <stdlib.h>
+
+/* number of fractional bits of the IIR state */
+#define ADC_FILTER_IIR_FRACTION     8
+
+
+static uint8_t adc_filterLimit(uint8_t value, uint8_t max){
+    return (value > max) ? max : value;
+}
+
+/* writes the median of the last samples to output, returns false until the
+window is filled: a spike among the first samples would otherwise pass the
+median stage and prime the average and the IIR */
+static bool adc_filterMedian(adc_filter_t * filter, uint16_t sample, uint16_t * output){
+    uint8_t size = filter->config.medianSize;
+    uint16_t sorted[ADC_FILTER_MAX_MEDIAN];
+
+    filter->median[filter->medianPos] = sample;
+    filter->medianPos = (filter->medianPos + 1 < size) ? filter->medianPos + 1 : 0;
+
+    if(filter->medianFill < size){
+        filter->medianFill++;
+        if(filter->medianFill < size){
+            return false;
+        }
+    }
+
+    // insertion sort of at most 5 values
+    for(uint8_t i = 0; i < size; i++){
+        uint16_t value = filter->median[i];
+        uint8_t j = i;
+
+        while(j > 0 && sorted[j - 1] > value){
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = value;
+    }
+
+    *output = sorted[size >> 1];
+    return true;
+}
+
+void adc_filterInit(adc_filter_t * filter, const adc_filterConfig_t * config){
+
+    if(filter == NULL || config == NULL){
+        return;
+    }
+
+    filter->config.medianSize     = (config->medianSize >= ADC_FILTER_MAX_MEDIAN) ? ADC_FILTER_MAX_MEDIAN :
+                                    (config->medianSize >= 3) ? 3 : 0;
+    filter->config.oversampleBits = adc_filterLimit(config->oversampleBits, ADC_FILTER_MAX_OVERSAMPLE_BITS);
+    filter->config.averageShift   = adc_filterLimit(config->averageShift, ADC_FILTER_MAX_AVERAGE_SHIFT);
+    filter->config.iirShift       = adc_filterLimit(config->iirShift, ADC_FILTER_MAX_IIR_SHIFT);
+
+    filter->medianPos       = 0;
+    filter->medianFill      = 0;
+    filter->oversampleSum   = 0;
+    filter->oversampleCount = 0;
+    filter->averageSum      = 0;
+    filter->averagePos      = 0;
+    filter->iir             = 0;
+    filter->primed          = false;
+}
+
+bool adc_filterPush(adc_filter_t * filter, uint16_t sample, uint16_t * output){
+    const adc_filterConfig_t * config = &filter->config;
+    uint16_t value = sample;
+
+    // stage 1: median spike rejection
+    if(config->medianSize != 0 && !adc_filterMedian(filter, value, &value)){
+        return false;
+    }
+
+    // stage 2: oversampling, 4^n samples give n additional bits
+    if(config->oversampleBits != 0){
+        filter->oversampleSum += value;
+
+        if(++filter->oversampleCount < (1 << (2 * config->oversampleBits))){
+            return false;
+        }
+        value = filter->oversampleSum >> config->oversampleBits;
+        filter->oversampleSum   = 0;
+        filter->oversampleCount = 0;
+    }
+
+    // stage 3: moving average over 2^n values, the running sum avoids a loop
+    if(config->averageShift != 0){
+        uint8_t window = 1 << config->averageShift;
+
+        if(!filter->primed){
+            for(uint8_t i = 0; i < window; i++){
+                filter->average[i] = value;
+            }
+            filter->averageSum = value << config->averageShift;
+        }
+        else{
+            filter->averageSum -= filter->average[filter->averagePos];
+            filter->averageSum += value;
+            filter->average[filter->averagePos] = value;
+            filter->averagePos = (filter->averagePos + 1) & (window - 1);
+        }
+        value = filter->averageSum >> config->averageShift;
+    }
+
+    // stage 4: single-pole IIR low pass in fixed point
+    if(config->iirShift != 0){
+        int32_t target = (int32_t)value << ADC_FILTER_IIR_FRACTION;
+
+        if(!filter->primed){
+            filter->iir = target;
+        }
+        else{
+            filter->iir += (target - filter->iir) >> config->iirShift;
+        }
+        value = (filter->iir + (1 << (ADC_FILTER_IIR_FRACTION - 1))) >> ADC_FILTER_IIR_FRACTION;
+    }
+
+    filter->primed = true;
+    *output = value;
+
+    return true;
+}
@@ -0,0 +1,71 @@
+#ifndef SES_ADC_FILTER_H
+#define SES_ADC_FILTER_H
+
+/*INCLUDES *******************************************************************/
+
+#include <stdbool.h>
+#include <inttypes.h>
+
+
+/* DEFINES & MACROS **********************************************************/
+
+/* limits of the filter stages */
+#define ADC_FILTER_MAX_MEDIAN           5   /* median of 3 or 5 samples */
+#define ADC_FILTER_MAX_OVERSAMPLE_BITS  3   /* 4^3 = 64 samples per output */
+#define ADC_FILTER_MAX_AVERAGE_SHIFT    3   /* moving average over 2^3 = 8 outputs */
+#define ADC_FILTER_MAX_IIR_SHIFT        7   /* IIR coefficient 2^-7 */
+
+
+/* TYPES *********************************************************************/
+
+/**
+ * Configuration of a filter pipeline. The stages run in the order of the
+ * members, a value of 0 bypasses a stage. Only additions, compares and
+ * shifts are used, no floating point and no division.
+ */
+typedef struct {
+    uint8_t medianSize;         /* spike rejection: median of the last 3 or 5 samples */
+    uint8_t oversampleBits;     /* decimation: sum of 4^n samples shifted by n, gains n bits */
+    uint8_t averageShift;       /* moving average over 2^n values */
+    uint8_t iirShift;           /* single-pole IIR low pass: y += (x - y) / 2^n */
+} adc_filterConfig_t;
+
+/**
+ * State of a filter pipeline
+ */
+typedef struct {
+    adc_filterConfig_t config;
+    uint16_t median[ADC_FILTER_MAX_MEDIAN];     /* last raw samples */
+    uint8_t medianPos;
+    uint8_t medianFill;
+    uint16_t oversampleSum;                     /* at most 64 * 1023 */
+    uint8_t oversampleCount;
+    uint16_t average[1 << ADC_FILTER_MAX_AVERAGE_SHIFT];
+    uint16_t averageSum;                        /* at most 8 * 8191 */
+    uint8_t averagePos;
+    int32_t iir;                                /* output with 8 fractional bits */
+    bool primed;                                /* average and IIR hold a value */
+} adc_filter_t;
+
+
+/* FUNCTION PROTOTYPES *******************************************************/
+
+/**
+ * Initializes a filter pipeline, out of range values of the configuration
+ * are limited.
+ * @filter The filter state
+ * @config The stages to run
+ */
+void adc_filterInit(adc_filter_t * filter, const adc_filterConfig_t * config);
+
+/**
+ * Feeds one raw 10 bit sample into the pipeline.
+ * @filter The filter state
+ * @sample Raw ADC value
+ * @output Filtered value with 10 + oversampleBits bits, written when a new value is ready
+ * @return true, if a new value was written to output; with oversampling only every 4^n-th sample,
+ *         with the median not before the window is filled
+ */
+bool adc_filterPush(adc_filter_t * filter, uint16_t sample, uint16_t * output);
+
+#endif /* SES_ADC_FILTER_H */
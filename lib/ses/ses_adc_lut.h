@@ -0,0 +1,51 @@
+/* generated by tools/gen_adc_lut.py from lib/ses/ses_adc_calibration.csv, do not edit */
+#ifndef SES_ADC_LUT_H
+#define SES_ADC_LUT_H
+
+#include <inttypes.h>
+#include <avr/pgmspace.h>
+
+/* breakpoint of a lookup table, the segment up to the next breakpoint
+is 2^shift raw counts wide */
+typedef struct {
+    uint16_t raw;
+    int16_t value;
+    uint8_t shift;
+} adc_lutPoint_t;
+
+/* raw value of the first and the last breakpoint of every table */
+#define ADC_LUT_START                0
+#define ADC_LUT_END                  1024
+
+/* breakpoints per table */
+#define ADC_LUT_TEMPERATURE_SIZE     26
+#define ADC_LUT_LIGHT_SIZE           34
+
+/* the tables are defined only in the file which defines ADC_LUT_TABLES */
+#ifdef ADC_LUT_TABLES
+
+static const adc_lutPoint_t adc_lut_temperature[ADC_LUT_TEMPERATURE_SIZE] PROGMEM = {
+    {    0,   -200,  6 }, {   64,   -200,  4 }, {   80,   -198,  4 }, {   96,   -180,  5 },
+    {  128,   -145,  5 }, {  160,   -118,  4 }, {  176,   -104,  4 }, {  192,    -93,  6 },
+    {  256,    -51,  6 }, {  320,    -16,  6 }, {  384,     17,  7 }, {  512,     80,  7 },
+    {  640,    145,  7 }, {  768,    225,  6 }, {  832,    277,  6 }, {  896,    346,  5 },
+    {  928,    395,  5 }, {  960,    465,  4 }, {  976,    515,  4 }, {  992,    589,  3 },
+    { 1000,    638,  3 }, { 1008,    712,  2 }, { 1012,    767,  1 }, { 1014,    800,  1 },
+    { 1016,    800,  3 }, { 1024,    800,  0 },
+};
+
+static const adc_lutPoint_t adc_lut_light[ADC_LUT_LIGHT_SIZE] PROGMEM = {
+    {    0,  10000,  3 }, {    8,  10000,  2 }, {   12,  10000,  2 }, {   16,   7143,  1 },
+    {   18,   5714,  0 }, {   19,   5000,  0 }, {   20,   4824,  2 }, {   24,   4118,  3 },
+    {   32,   2706,  2 }, {   36,   2000,  2 }, {   40,   1818,  3 }, {   48,   1455,  3 },
+    {   56,   1091,  1 }, {   58,   1000,  1 }, {   60,    970,  2 }, {   64,    909,  4 },
+    {   80,    667,  3 }, {   88,    545,  2 }, {   92,    496,  2 }, {   96,    478,  5 },
+    {  128,    337,  5 }, {  160,    199,  5 }, {  192,    157,  5 }, {  224,    116,  4 },
+    {  240,     98,  4 }, {  256,     90,  6 }, {  320,     58,  4 }, {  336,     50,  4 },
+    {  352,     47,  5 }, {  384,     41,  7 }, {  512,     18,  7 }, {  640,      9,  7 },
+    {  768,      4,  8 }, { 1024,      1,  0 },
+};
+
+#endif /* ADC_LUT_TABLES */
+
+#endif /* SES_ADC_LUT_H */
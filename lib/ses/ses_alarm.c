@@ -0,0 +1,338 @@
+/* INCLUDES ******************************************************************/
+#include <stdlib.h>
+
+#include "ses_alarm.h"
+#include "ses_scheduler.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+// alarm flags
+#define ALARM_IN_USE            0x01
+#define ALARM_ENABLED           0x02
+#define ALARM_SNOOZED           0x04    // next is the snooze time, not one of the days
+
+#define ALARM_MS_PER_MIN        ((uint32_t)SEC_PER_MIN * 1000)
+#define ALARM_DAYS_PER_WEEK     7
+
+/* TYPES *********************************************************************/
+
+/**
+ * One alarm slot
+ */
+typedef struct {
+    uint32_t next;          ///< absolute minute of the next firing, key of the heap
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t days;           ///< weekday mask, ALARM_ONCE
+    uint8_t flags;          ///< ALARM_IN_USE, ALARM_ENABLED, ALARM_SNOOZED
+    alarm_id_t position;    ///< index in the heap, ALARM_NONE if not queued
+} alarm_entry_t;
+
+/* PRIVATE VARIABLES *********************************************************/
+
+static alarm_entry_t alarms[ALARM_MAX];
+
+// min-heap of the enabled alarms ordered by their next firing
+static alarm_id_t heap[ALARM_MAX];
+static alarm_id_t heapSize = 0;
+
+// weekday of day 0 of the scheduler day counter
+static uint8_t weekdayOffset = 0;
+
+static pAlarmCallback alarmCB = NULL;
+
+// released by the scheduler deadline when the first alarm of the heap is due
+static task_descriptor_t alarmTask;
+
+/*FUNCTION DEFINITION ********************************************************/
+
+static uint32_t alarm_now(time_t * clock) {
+    time_t now;
+    uint16_t day = scheduler_getDay(&now);
+
+    if(clock != NULL){
+        *clock = now;
+    }
+    return (uint32_t)day * ALARM_MIN_PER_DAY + now.hour * MIN_PER_HOUR + now.minute;
+}
+
+// first minute after now at which the alarm fires
+static uint32_t alarm_nextOccurrence(const alarm_entry_t * alarm, uint32_t now) {
+    uint32_t day = now / ALARM_MIN_PER_DAY;
+    uint16_t minute = alarm->hour * MIN_PER_HOUR + alarm->minute;
+
+    if(minute <= now - day * ALARM_MIN_PER_DAY){
+        day++;
+    }
+
+    if(alarm->days == ALARM_ONCE){
+        return day * ALARM_MIN_PER_DAY + minute;
+    }
+
+    // at most one week ahead
+    uint8_t weekday = (day + weekdayOffset) % ALARM_DAYS_PER_WEEK;
+    for(uint8_t i = 0; i < ALARM_DAYS_PER_WEEK && !(alarm->days & (1 << weekday)); i++){
+        day++;
+        weekday = (weekday + 1 < ALARM_DAYS_PER_WEEK) ? weekday + 1 : 0;
+    }
+    return day * ALARM_MIN_PER_DAY + minute;
+}
+
+static void alarm_heapPlace(alarm_id_t position, alarm_id_t id) {
+    heap[position] = id;
+    alarms[id].position = position;
+}
+
+static void alarm_siftUp(alarm_id_t position) {
+    alarm_id_t id = heap[position];
+
+    while(position > 0){
+        alarm_id_t parent = (position - 1) / 2;
+        if(alarms[heap[parent]].next <= alarms[id].next){
+            break;
+        }
+        alarm_heapPlace(position, heap[parent]);
+        position = parent;
+    }
+    alarm_heapPlace(position, id);
+}
+
+static void alarm_siftDown(alarm_id_t position) {
+    alarm_id_t id = heap[position];
+
+    for(;;){
+        alarm_id_t child = 2 * position + 1;
+        if(child >= heapSize){
+            break;
+        }
+        if(child + 1 < heapSize && alarms[heap[child + 1]].next < alarms[heap[child]].next){
+            child++;
+        }
+        if(alarms[id].next <= alarms[heap[child]].next){
+            break;
+        }
+        alarm_heapPlace(position, heap[child]);
+        position = child;
+    }
+    alarm_heapPlace(position, id);
+}
+
+static void alarm_enqueue(alarm_id_t id) {
+    alarm_heapPlace(heapSize++, id);
+    alarm_siftUp(alarms[id].position);
+}
+
+static void alarm_dequeue(alarm_id_t id) {
+    alarm_id_t position = alarms[id].position;
+
+    if(position == ALARM_NONE){
+        return;
+    }
+    alarms[id].position = ALARM_NONE;
+
+    // the last element fills the gap and moves up or down
+    if(position != --heapSize){
+        alarm_id_t moved = heap[heapSize];
+        alarm_heapPlace(position, moved);
+        alarm_siftUp(position);
+        alarm_siftDown(alarms[moved].position);
+    }
+}
+
+// a changed key of a queued alarm
+static void alarm_requeue(alarm_id_t id) {
+    if(alarms[id].position == ALARM_NONE){
+        alarm_enqueue(id);
+    }
+    else{
+        alarm_siftUp(alarms[id].position);
+        alarm_siftDown(alarms[id].position);
+    }
+}
+
+// sets the scheduler deadline to the first alarm of the heap
+static void alarm_arm(void) {
+    if(heapSize == 0){
+        scheduler_setDeadline(NULL, 0);
+        return;
+    }
+
+    time_t clock;
+    uint32_t now  = alarm_now(&clock);
+    uint32_t next = alarms[heap[0]].next;
+    uint32_t delay = 0;
+
+    if(next > now){
+        delay = (next - now) * ALARM_MS_PER_MIN - (clock.second * (uint16_t)1000 + clock.milli);
+    }
+    scheduler_setDeadline(&alarmTask, delay);
+}
+
+static void alarm_task(void * param) {
+    uint32_t now = alarm_now(NULL);
+
+    while(heapSize > 0 && alarms[heap[0]].next <= now){
+        alarm_id_t id = heap[0];
+        alarm_entry_t * alarm = &alarms[id];
+
+        alarm->flags &= ~ALARM_SNOOZED;
+        if(alarm->days == ALARM_ONCE){
+            // a one-shot alarm keeps its slot disabled, it may still be snoozed
+            alarm->flags &= ~ALARM_ENABLED;
+            alarm_dequeue(id);
+        }
+        else{
+            alarm->next = alarm_nextOccurrence(alarm, now);
+            alarm_siftDown(0);
+        }
+
+        if(alarmCB != NULL){
+            alarmCB(id);
+        }
+    }
+
+    alarm_arm();
+}
+
+static bool alarm_isUsed(alarm_id_t id) {
+    return id < ALARM_MAX && (alarms[id].flags & ALARM_IN_USE);
+}
+
+void alarm_init(pAlarmCallback cb) {
+    for(alarm_id_t id = 0; id < ALARM_MAX; id++){
+        alarms[id].flags    = 0;
+        alarms[id].position = ALARM_NONE;
+    }
+    heapSize = 0;
+    alarmCB  = cb;
+
+    alarmTask.task  = alarm_task;
+    alarmTask.param = NULL;
+    scheduler_setDeadline(NULL, 0);
+}
+
+alarm_id_t alarm_add(uint8_t hour, uint8_t minute, uint8_t days) {
+    for(alarm_id_t id = 0; id < ALARM_MAX; id++){
+        if(!(alarms[id].flags & ALARM_IN_USE)){
+            alarms[id].flags = ALARM_IN_USE;
+            alarm_set(id, hour, minute, days);
+            alarm_enable(id, true);
+            return id;
+        }
+    }
+    return ALARM_NONE;
+}
+
+bool alarm_set(alarm_id_t id, uint8_t hour, uint8_t minute, uint8_t days) {
+    if(!alarm_isUsed(id)){
+        return false;
+    }
+
+    alarm_entry_t * alarm = &alarms[id];
+    alarm->hour   = hour % HOUR_PER_DAY;
+    alarm->minute = minute % MIN_PER_HOUR;
+    alarm->days   = days & ALARM_DAILY;
+    alarm->flags &= ~ALARM_SNOOZED;
+
+    if(alarm->flags & ALARM_ENABLED){
+        alarm->next = alarm_nextOccurrence(alarm, alarm_now(NULL));
+        alarm_requeue(id);
+        alarm_arm();
+    }
+    return true;
+}
+
+bool alarm_remove(alarm_id_t id) {
+    if(!alarm_isUsed(id)){
+        return false;
+    }
+
+    alarm_dequeue(id);
+    alarms[id].flags = 0;
+    alarm_arm();
+    return true;
+}
+
+bool alarm_enable(alarm_id_t id, bool enable) {
+    if(!alarm_isUsed(id)){
+        return false;
+    }
+
+    alarm_entry_t * alarm = &alarms[id];
+
+    if(enable && !(alarm->flags & ALARM_ENABLED)){
+        alarm->flags |= ALARM_ENABLED;
+        alarm->next = alarm_nextOccurrence(alarm, alarm_now(NULL));
+        alarm_enqueue(id);
+    }
+    else if(!enable && (alarm->flags & ALARM_ENABLED)){
+        alarm->flags &= ~(ALARM_ENABLED | ALARM_SNOOZED);
+        alarm_dequeue(id);
+    }
+    alarm_arm();
+    return true;
+}
+
+bool alarm_isEnabled(alarm_id_t id) {
+    return alarm_isUsed(id) && (alarms[id].flags & ALARM_ENABLED);
+}
+
+bool alarm_snooze(alarm_id_t id, uint8_t minutes) {
+    if(!alarm_isUsed(id)){
+        return false;
+    }
+
+    alarm_entry_t * alarm = &alarms[id];
+    alarm->flags |= ALARM_ENABLED | ALARM_SNOOZED;
+    alarm->next   = alarm_now(NULL) + minutes;
+    alarm_requeue(id);
+    alarm_arm();
+    return true;
+}
+
+bool alarm_getTime(alarm_id_t id, time_t * time) {
+    if(!alarm_isUsed(id) || time == NULL){
+        return false;
+    }
+
+    time->hour   = alarms[id].hour;
+    time->minute = alarms[id].minute;
+    time->second = 0;
+    time->milli  = 0;
+    return true;
+}
+
+alarm_id_t alarm_getNext(uint32_t * at) {
+    if(heapSize == 0){
+        return ALARM_NONE;
+    }
+    if(at != NULL){
+        *at = alarms[heap[0]].next;
+    }
+    return heap[0];
+}
+
+void alarm_setWeekday(uint8_t weekday) {
+    uint16_t day = scheduler_getDay(NULL);
+
+    weekdayOffset = (weekday % ALARM_DAYS_PER_WEEK + ALARM_DAYS_PER_WEEK - day % ALARM_DAYS_PER_WEEK) % ALARM_DAYS_PER_WEEK;
+    alarm_reschedule();
+}
+
+void alarm_reschedule(void) {
+    uint32_t now = alarm_now(NULL);
+
+    // new keys for all queued alarms, a pending snooze is dropped
+    for(alarm_id_t position = 0; position < heapSize; position++){
+        alarm_entry_t * alarm = &alarms[heap[position]];
+        alarm->flags &= ~ALARM_SNOOZED;
+        alarm->next = alarm_nextOccurrence(alarm, now);
+    }
+
+    // rebuild the heap bottom-up
+    for(alarm_id_t position = heapSize / 2; position > 0; position--){
+        alarm_siftDown(position - 1);
+    }
+
+    alarm_arm();
+}
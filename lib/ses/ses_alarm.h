@@ -0,0 +1,144 @@
+#ifndef SES_ALARM_H_
+#define SES_ALARM_H_
+
+/* INCLUDES ******************************************************************/
+
+#include <stdbool.h>
+#include <inttypes.h>
+#include "ses_scheduler.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+/* number of alarm slots */
+#ifndef ALARM_MAX
+#define ALARM_MAX               16
+#endif
+
+/* weekday masks, bit 0 is Monday */
+#define ALARM_MONDAY            0x01
+#define ALARM_TUESDAY           0x02
+#define ALARM_WEDNESDAY         0x04
+#define ALARM_THURSDAY          0x08
+#define ALARM_FRIDAY            0x10
+#define ALARM_SATURDAY          0x20
+#define ALARM_SUNDAY            0x40
+#define ALARM_WEEKDAYS          0x1F
+#define ALARM_WEEKEND           0x60
+#define ALARM_DAILY             0x7F
+/* fires once at the next occurrence of its time, then it is disabled */
+#define ALARM_ONCE              0x00
+
+/* no alarm, returned if all slots are taken or no alarm is pending */
+#define ALARM_NONE              ((alarm_id_t)~0)
+
+/* minutes per day, for the absolute minutes of alarm_getNext */
+#define ALARM_MIN_PER_DAY       ((uint16_t)HOUR_PER_DAY * MIN_PER_HOUR)
+
+/* TYPES *********************************************************************/
+
+/** slot of an alarm; the heap computes the children 2 * i + 2 of the slots
+in this type, and ALARM_NONE is its largest value */
+#if ALARM_MAX < 128
+typedef uint8_t alarm_id_t;
+#elif ALARM_MAX < 32768
+typedef uint16_t alarm_id_t;
+#else
+#error "ALARM_MAX must be less than 32768"
+#endif
+
+/**
+ * Type of function pointer for fired alarms
+ *
+ * @param id  the alarm which fired
+ */
+typedef void (* pAlarmCallback)(alarm_id_t id);
+
+/* FUNCTION PROTOTYPES *******************************************************/
+
+/**
+ * Initializes the alarm engine without alarms. The engine owns the
+ * scheduler deadline.
+ *
+ * @param cb  called in task context when an alarm fires
+ */
+void alarm_init(pAlarmCallback cb);
+
+/**
+ * Adds an enabled alarm.
+ *
+ * @param hour    hour of the alarm
+ * @param minute  minute of the alarm
+ * @param days    weekday mask ALARM_MONDAY ... ALARM_SUNDAY, or ALARM_ONCE
+ *
+ * @return        slot of the alarm, ALARM_NONE if all slots are taken
+ */
+alarm_id_t alarm_add(uint8_t hour, uint8_t minute, uint8_t days);
+
+/**
+ * Changes the time and days of an alarm, which keeps its enabled state.
+ *
+ * @return        false, if the slot is not in use
+ */
+bool alarm_set(alarm_id_t id, uint8_t hour, uint8_t minute, uint8_t days);
+
+/**
+ * Removes an alarm and frees its slot.
+ *
+ * @return        false, if the slot is not in use
+ */
+bool alarm_remove(alarm_id_t id);
+
+/**
+ * Enables or disables an alarm, a disabled alarm keeps its slot.
+ *
+ * @return        false, if the slot is not in use
+ */
+bool alarm_enable(alarm_id_t id, bool enable);
+
+/**
+ * Check whether an alarm is enabled.
+ *
+ * @return        false, if the alarm is disabled or the slot is not in use
+ */
+bool alarm_isEnabled(alarm_id_t id);
+
+/**
+ * Fires an alarm again after some minutes, then it continues with its days.
+ *
+ * @return        false, if the slot is not in use
+ */
+bool alarm_snooze(alarm_id_t id, uint8_t minutes);
+
+/**
+ * Get the time of an alarm.
+ *
+ * @param time    stores hour and minute
+ *
+ * @return        false, if the slot is not in use
+ */
+bool alarm_getTime(alarm_id_t id, time_t * time);
+
+/**
+ * Get the alarm which fires next.
+ *
+ * @param at      stores the minute it fires, counted like
+ *                scheduler_getDay() * ALARM_MIN_PER_DAY + minute of the day;
+ *                may be NULL
+ *
+ * @return        the alarm, ALARM_NONE if no alarm is enabled
+ */
+alarm_id_t alarm_getNext(uint32_t * at);
+
+/**
+ * Sets the weekday of the current day.
+ *
+ * @param weekday  0 is Monday ... 6 is Sunday
+ */
+void alarm_setWeekday(uint8_t weekday);
+
+/**
+ * Recomputes all fire times, required after the system time was set.
+ */
+void alarm_reschedule(void);
+
+#endif /* SES_ALARM_H_ */
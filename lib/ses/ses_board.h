@@ -0,0 +1,96 @@
+#ifndef SES_BOARD_H_
+#define SES_BOARD_H_
+
+/* INCLUDES ******************************************************************/
+
+#include <stdbool.h>
+#include <inttypes.h>
+#include <avr/io.h>
+
+/* BOARD TABLE ***************************************************************/
+
+/*
+ * Wiring of the SES board: name, port letter, bit. Every entry expands to
+ * the constants PIN_<name>_PORT, PIN_<name>_BIT, PIN_<name>_MASK and the
+ * static inline accessors below; with constant registers and bits they
+ * compile to single sbi/cbi instructions, reads in a condition to sbis/sbic.
+ * The encoder inputs ROTARY_A and ROTARY_B on PB6/PB7 are assumed, they are
+ * not taken from the board schematic.
+ */
+#define BOARD_PINS(X)                   \
+    X(LED_RED,          F, 5)           \
+    X(LED_GREEN,        D, 2)           \
+    X(LED_YELLOW,       D, 3)           \
+    X(BUTTON_PUSH,      B, 4)           \
+    X(BUTTON_ROTARY,    B, 5)           \
+    X(ROTARY_A,         B, 6)           \
+    X(ROTARY_B,         B, 7)           \
+    X(LIGHT,            F, 0)           \
+    X(POTI,             F, 6)           \
+    X(TEMP,             F, 7)
+
+/* ports used by the board table */
+#define BOARD_PORTS(X)  X(B) X(D) X(F)
+
+/* TYPES *********************************************************************/
+
+/** ports of the board table, PIN_<name>_PORT */
+enum board_ports {
+#define BOARD_PORT_ID(port)     BOARD_PORT_##port,
+    BOARD_PORTS(BOARD_PORT_ID)
+#undef BOARD_PORT_ID
+    BOARD_PORT_COUNT
+};
+
+/* PIN ACCESSORS *************************************************************/
+
+/*
+ * Per pin:
+ *   pin_<name>_output()   data direction output
+ *   pin_<name>_input()    data direction input
+ *   pin_<name>_high()     drive high, or enable the pull-up of an input
+ *   pin_<name>_low()      drive low, or disable the pull-up of an input
+ *   pin_<name>_toggle()   invert the output by writing the PIN register
+ *   pin_<name>_read()     level of the input
+ *   pin_<name>_inputs()   PIN register of the port, e.g. for the debouncer
+ */
+#define BOARD_PIN_ACCESSORS(name, port, bit)                                        \
+    enum {                                                                          \
+        PIN_##name##_PORT = BOARD_PORT_##port,                                      \
+        PIN_##name##_BIT  = (bit),                                                  \
+        PIN_##name##_MASK = (1 << (bit))                                            \
+    };                                                                              \
+    static inline void pin_##name##_output(void) { DDR##port  |=  (1 << (bit)); }   \
+    static inline void pin_##name##_input(void)  { DDR##port  &= ~(1 << (bit)); }   \
+    static inline void pin_##name##_high(void)   { PORT##port |=  (1 << (bit)); }   \
+    static inline void pin_##name##_low(void)    { PORT##port &= ~(1 << (bit)); }   \
+    static inline void pin_##name##_toggle(void) { PIN##port   =  (1 << (bit)); }   \
+    static inline bool pin_##name##_read(void)   { return (PIN##port & (1 << (bit))) != 0; } \
+    static inline volatile uint8_t * pin_##name##_inputs(void) { return &PIN##port; }
+
+BOARD_PINS(BOARD_PIN_ACCESSORS)
+
+/* PORT GROUP ACCESSORS ******************************************************/
+
+/*
+ * Per port, for several bits at once:
+ *   port_<port>_write(mask, value)  set the bits of mask to value. The PIN
+ *                                   register toggles exactly the differing
+ *                                   bits in one write, so interrupts changing
+ *                                   other bits of the port are never undone.
+ *   port_<port>_toggle(mask)        invert the bits of mask in one write
+ *   port_<port>_read()              levels of the whole port
+ */
+#define BOARD_PORT_ACCESSORS(port)                                                  \
+    static inline void port_##port##_write(uint8_t mask, uint8_t value) {          \
+        PIN##port = (PORT##port ^ value) & mask;                                    \
+    }                                                                               \
+    static inline void port_##port##_toggle(uint8_t mask) { PIN##port = mask; }     \
+    static inline uint8_t port_##port##_read(void) { return PIN##port; }
+
+BOARD_PORTS(BOARD_PORT_ACCESSORS)
+
+#undef BOARD_PIN_ACCESSORS
+#undef BOARD_PORT_ACCESSORS
+
+#endif /* SES_BOARD_H_ */
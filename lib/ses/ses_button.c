@@ -2,64 +2,96 @@
 #include <stdlib.h>
 #include <avr/io.h>
 #include <avr/interrupt.h>
+#include <util/atomic.h>
 #include "ses_button.h"
+#include "ses_debounce.h"
+#include "ses_log.h"
+#include "ses_rotary.h"
+#include "ses_scheduler.h"
 #include "ses_timer.h"
 
 
 /* DEFINES & MACROS **********************************************************/
 
-// Push button wiring on SES board
-#define BUTTON_PUSH_PORT    PORTB
-#define BUTTON_PUSH_DDR     DDRB
-#define BUTTON_PUSH_PIN     PINB
-#define BUTTON_PUSH_BIT     4
-
-// Rotary button wiring on SES board
-#define BUTTON_ROTARY_PORT  PORTB
-#define BUTTON_ROTARY_DDR   DDRB
-#define BUTTON_ROTARY_PIN   PINB
-#define BUTTON_ROTARY_BIT   5
-
-// defines for button debouncing
-#define BUTTON_NUM_DEBOUNCE_CHECKS          10
-#define BUTTON_DEBOUNCE_POS_PUSHBUTTON      0x01
-#define BUTTON_DEBOUNCE_POS_ROTARYBUTTON    0x02
+// pin change interrupt bits of the buttons, both are on port B (PCINT0)
+#define BUTTON_PCINT_MASK   (PIN_BUTTON_PUSH_MASK | PIN_BUTTON_ROTARY_MASK)
 
 //function pointers for button callbacks
 static volatile pButtonCallback RotaryButtonCB;
 static volatile pButtonCallback PushButtonCB;
+static volatile pButtonCallback RotaryButtonReleaseCB;
+static volatile pButtonCallback PushButtonReleaseCB;
+static volatile pButtonGestureCallback GestureCB;
+
+// gesture recognition of both buttons and the edges of the current tick
+static gesture_t pushGesture;
+static gesture_t rotaryGesture;
+static debounce_mask_t tickPressed;
+static debounce_mask_t tickReleased;
+
+// debouncer lanes of the buttons, both are on port B
+static debounce_mask_t pushButtonLane;
+static debounce_mask_t rotaryButtonLane;
+
+// selected debouncing mode (BUTT_DEBOUNCING_*)
+static uint8_t debouncingMode;
+
+// debounce task of BUTT_DEBOUNCING_EVENT, only in the scheduler during a bounce window
+static task_descriptor_t eventDebounceTask;
+static uint8_t eventDebounceSamples;
+
+// port B at the last pin change, to tell button from encoder changes
+static uint8_t lastPins;
 
 // predeclaration
 void button_checkState(void);
+static void button_debounced(debounce_mask_t pressed, debounce_mask_t released);
+static void button_eventDebounceTask(void * param);
+
 
 /* FUNCTION DEFINITION *******************************************************/
 
+static void button_enablePinChange(void){
+    // Disable Pin Change Interrupt during initialization
+    PCICR &= ~(1 << PCIE0);
+
+    // Enable interrupt for push- and rotary buttons
+    PCMSK0 |= BUTTON_PCINT_MASK;
+    lastPins = port_B_read();
+
+    // Clear pending pin-change interrupt
+    PCIFR |= (1 << PCIF0);
+
+    // Enable Pin Change Interrupt
+    PCICR |= (1 << PCIE0);
+}
+
 void button_init(uint8_t debouncing){
     // Push button initialization
     // Set the corresponding pin to input 
-    BUTTON_PUSH_DDR  &= ~(1 << BUTTON_PUSH_BIT);
+    pin_BUTTON_PUSH_input();
     // Activate the internal pull-up resistor
-    BUTTON_PUSH_PORT |=  (1 << BUTTON_PUSH_BIT);
+    pin_BUTTON_PUSH_high();
 
     // Rotary button initialization
-    // Set the corresponding pin to output 
-    BUTTON_ROTARY_DDR  &= ~(1 << BUTTON_ROTARY_BIT);
+    // Set the corresponding pin to input
+    pin_BUTTON_ROTARY_input();
     // Activate the internal pull-up resistor
-    BUTTON_ROTARY_PORT |=  (1 << BUTTON_ROTARY_BIT);
+    pin_BUTTON_ROTARY_high();
 
-    // case 1: there is no button debouncing (interrupt)
-    if (debouncing == BUTT_DEBOUNCING_NONE) {
-        // Disable Pin Change Interrupt during initialization
-        PCICR &= ~(1 << PCIE0);
+    // Both buttons pull to GND if pushed
+    uint8_t lane = debounce_addPort(pin_BUTTON_PUSH_inputs(), BUTTON_PCINT_MASK, BUTTON_PCINT_MASK);
+    pushButtonLane   = DEBOUNCE_LANE(lane + PIN_BUTTON_PUSH_BIT);
+    rotaryButtonLane = DEBOUNCE_LANE(lane + PIN_BUTTON_ROTARY_BIT);
+    debounce_setCallback(button_debounced);
+    gesture_init(&pushGesture, true);
+    gesture_init(&rotaryGesture, true);
 
-        // Enable interrupt for push- and rotary buttons
-        PCMSK0 |= (1 << BUTTON_PUSH_BIT) | (1 << BUTTON_ROTARY_BIT);
+    debouncingMode = debouncing;
 
-        // Clear pending pin-change interrupt
-        PCIFR |= (1 << PCIFR);
-
-        // Enable Pin Change Interrupt
-        PCICR |= (1 << PCIE0);
+    // case 1: there is no button debouncing (interrupt)
+    if (debouncing == BUTT_DEBOUNCING_NONE) {
+        button_enablePinChange();
     }
 
     // case 2: button debouncing by hardware timer
@@ -72,25 +104,56 @@ void button_init(uint8_t debouncing){
     // case 3: button debouncing by a dedicated task
     if (debouncing == BUTT_DEBOUNCING_TASK) {/* nothing happens here*/}
 
-}
+    // case 4: a pin change arms a debounce task, which runs until the inputs settle
+    if (debouncing == BUTT_DEBOUNCING_EVENT) {
+        eventDebounceTask.task   = button_eventDebounceTask;
+        eventDebounceTask.param  = NULL;
+        eventDebounceTask.period = BUTTON_CHECK_PERIOD_MS;
+        button_enablePinChange();
+    }
 
-bool button_isPushButtonPressed(void){
-    // Read and mask the corresponding bit, then negate it because the button pulls to GND if pushed
-    return !(bool)(BUTTON_PUSH_PIN & (1 << BUTTON_PUSH_BIT));
 }
 
-bool button_isRotaryButtonPressed(void){
-    // Read and mask the corresponding bit, then negate it because the button pulls to GND if pushed
-    return !(bool)(BUTTON_ROTARY_PIN & (1 << BUTTON_ROTARY_BIT));
+/* masks the button pin changes for the bounce window and starts the debounce
+task; only the button bits are masked, the encoder shares the interrupt */
+static void button_armDebounce(void){
+    PCMSK0 &= ~BUTTON_PCINT_MASK;
+
+    eventDebounceSamples     = 0;
+    eventDebounceTask.expire = BUTTON_CHECK_PERIOD_MS;
+    scheduler_add(&eventDebounceTask);
+    LOG0(BUTTON_ARMED);
 }
 
 ISR(PCINT0_vect){
+    uint8_t pins = port_B_read();
+    uint8_t changed = (pins ^ lastPins) & BUTTON_PCINT_MASK;
+
+    lastPins = pins;
+
+    // the encoder channels are on the same port
+    rotary_update(pins);
+
+    if (changed == 0) {
+        return;
+    }
+
+    if (debouncingMode == BUTT_DEBOUNCING_EVENT) {
+        if (PCMSK0 & BUTTON_PCINT_MASK) {
+            button_armDebounce();
+        }
+        return;
+    }
+
+    if (debouncingMode != BUTT_DEBOUNCING_NONE) {
+        return;
+    }
     
-    if ( (RotaryButtonCB != NULL) & button_isRotaryButtonPressed() ) {
+    if ( (RotaryButtonCB != NULL) && (changed & PIN_BUTTON_ROTARY_MASK) && button_isRotaryButtonPressed() ) {
         RotaryButtonCB();
     }
     
-    if ( (PushButtonCB != NULL) & button_isPushButtonPressed() ) {
+    if ( (PushButtonCB != NULL) && (changed & PIN_BUTTON_PUSH_MASK) && button_isPushButtonPressed() ) {
         PushButtonCB();
     }
 }
@@ -118,52 +181,110 @@ void button_setPushButtonCallback(pButtonCallback callback){
 }
 
 
-void button_checkState(){
-    static uint8_t state[BUTTON_NUM_DEBOUNCE_CHECKS] = { 0 };
-    static uint8_t index = 0;
-    static uint8_t debouncedState = 0;
-    uint8_t lastDebouncedState = debouncedState;
+// Rotarybutton release Callback setter
+void button_setRotaryButtonReleaseCallback(pButtonCallback callback){
+    // callback validation check
+    if(callback != NULL){
+        RotaryButtonReleaseCB = callback;
+    }
+
+    return;
+}
+
 
-    // each bit in every state byte represents one button
-    state[index] = 0;
-    if (button_isPushButtonPressed()) {
-        state[index] |= BUTTON_DEBOUNCE_POS_PUSHBUTTON;
+// Pushbutton release Callback setter
+void button_setPushButtonReleaseCallback(pButtonCallback callback){
+    // callback validation check
+    if(callback != NULL){
+        PushButtonReleaseCB = callback;
     }
-    if (button_isRotaryButtonPressed()) {
-        state[index] |= BUTTON_DEBOUNCE_POS_ROTARYBUTTON;
+
+    return;
+}
+
+
+// Gesture Callback setter
+void button_setGestureCallback(pButtonGestureCallback callback){
+    // callback validation check
+    if(callback != NULL){
+        GestureCB = callback;
     }
 
-    index++;
-    if (index == BUTTON_NUM_DEBOUNCE_CHECKS) {
-        index = 0;
+    return;
+}
+
+
+// called by the debouncer once per debounced edge
+static void button_debounced(debounce_mask_t pressed, debounce_mask_t released){
+
+    LOG2(BUTTON_EDGE, pressed, released);
+    tickPressed  = pressed;
+    tickReleased = released;
+
+    if ( (pressed & rotaryButtonLane) && RotaryButtonCB != NULL ) {
+        RotaryButtonCB();
+    }
+    if ( (pressed & pushButtonLane) && PushButtonCB != NULL ) {
+        PushButtonCB();
+    }
+    if ( (released & rotaryButtonLane) && RotaryButtonReleaseCB != NULL ) {
+        RotaryButtonReleaseCB();
     }
+    if ( (released & pushButtonLane) && PushButtonReleaseCB != NULL ) {
+        PushButtonReleaseCB();
+    }
+}
+
 
-    // init compare value and compare with ALL reads, only if
-    // we read BUTTON_NUM_DEBOUNCE_CHECKS consistent ”1's” in the state
-    // array, the button at this position is considered pressed
-    uint8_t j = 0xFF;
-    for (uint8_t i = 0; i < BUTTON_NUM_DEBOUNCE_CHECKS; i++) {
-        j = j & state[i];
+static void button_gesture(gesture_t * gesture, debounce_mask_t lane, uint8_t button){
+    uint8_t event = gesture_update(gesture, tickPressed & lane, tickReleased & lane, BUTTON_CHECK_PERIOD_MS);
+
+    if ( event != GESTURE_NONE ) {
+        LOG2(BUTTON_GESTURE, button, event);
+        if ( GestureCB != NULL ) {
+            GestureCB(button, event);
+        }
     }
-    debouncedState = j;
+}
 
-    /* trigger callback only if: the corresponding debounced state bit is 1 AND the last debounced bit is 0
-    -> these conditions ensure that callback will be invoked only once */
-    if ( (debouncedState & BUTTON_DEBOUNCE_POS_ROTARYBUTTON) && 
-        !(lastDebouncedState & BUTTON_DEBOUNCE_POS_ROTARYBUTTON) && 
-        RotaryButtonCB != NULL ) {
 
-        RotaryButtonCB();
+// one debouncer tick: debounced edges first, then the gestures built from them
+static void button_tick(void){
+    tickPressed  = 0;
+    tickReleased = 0;
+    debounce_update();
+
+    button_gesture(&pushGesture, pushButtonLane, BUTTON_PUSH);
+    button_gesture(&rotaryGesture, rotaryButtonLane, BUTTON_ROTARY);
+}
+
 
+static void button_eventDebounceTask(void * param){
+
+    button_tick();
+    eventDebounceSamples++;
+
+    // held buttons and open double click windows keep the task running
+    if (!debounce_isSettled() || gesture_isBusy(&pushGesture) || gesture_isBusy(&rotaryGesture)) {
+        return;
     }
-    /* trigger callback only if: the corresponding debounced state bit is 1 AND the last debounced bit is 0
-    -> these conditions ensure that callback will be invoked only once */
-    if ( (debouncedState & BUTTON_DEBOUNCE_POS_PUSHBUTTON) && 
-        !(lastDebouncedState & BUTTON_DEBOUNCE_POS_PUSHBUTTON) && 
-        PushButtonCB != NULL ) {
 
-        PushButtonCB();
+    LOG1(BUTTON_DISARMED, eventDebounceSamples);
 
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        scheduler_remove(&eventDebounceTask);
+        PCMSK0 |= BUTTON_PCINT_MASK;
+        lastPins = port_B_read();
+
+        // a change between the last sample and unmasking raised no interrupt
+        if (debounce_getPending() != 0) {
+            button_armDebounce();
+        }
     }
-    
+}
+
+
+void button_checkState(){
+    // all registered inputs at once, the callbacks run from button_debounced
+    button_tick();
 }
\ No newline at end of file
@@ -4,28 +4,49 @@
 /* INCLUDES ******************************************************************/
 
 #include <stdbool.h>
+#include <inttypes.h>
+#include "ses_board.h"
+#include "ses_gesture.h"
 
 /* DEFINES *******************************************************************/
 #define BUTT_DEBOUNCING_NONE		0
 #define BUTT_DEBOUNCING_TIMER		1
 #define BUTT_DEBOUNCING_TASK        2
+#define BUTT_DEBOUNCING_EVENT       3   /* pin change interrupt arms a debounce task */
+
+/* period in ms in which button_checkState must be called */
+#define BUTTON_CHECK_PERIOD_MS      5
+
+/* buttons passed to the gesture callback */
+enum buttons {
+    BUTTON_PUSH,
+    BUTTON_ROTARY
+};
 
 /* FUNCTION PROTOTYPES *******************************************************/
 
 /**
  * Initializes rotary encoder button and pushbutton
+ * BUTT_DEBOUNCING_TASK requires a periodic task calling button_checkState,
+ * BUTT_DEBOUNCING_EVENT adds its own task to the scheduler while a button bounces.
  */
 void button_init(uint8_t);
 
 /** 
- * Get the state of the pushbutton.
+ * Get the state of the pushbutton, a single sbis/sbic in a condition.
  */
-bool button_isPushButtonPressed(void);
+static inline bool button_isPushButtonPressed(void) {
+    // negated because the button pulls to GND if pushed
+    return !pin_BUTTON_PUSH_read();
+}
 
 /** 
- * Get the state of the rotary button.
+ * Get the state of the rotary button, a single sbis/sbic in a condition.
  */
-bool button_isRotaryButtonPressed(void);
+static inline bool button_isRotaryButtonPressed(void) {
+    // negated because the button pulls to GND if pushed
+    return !pin_BUTTON_ROTARY_read();
+}
 
 /** 
  * 
@@ -43,7 +64,33 @@ void button_setRotaryButtonCallback(pButtonCallback callback);
 void button_setPushButtonCallback(pButtonCallback callback);
 
 /** 
- * Button debouncing function
+ * Rotarybutton release Callback, only called with debouncing
+ */
+void button_setRotaryButtonReleaseCallback(pButtonCallback callback);
+
+/** 
+ * Pushbutton release Callback, only called with debouncing
+ */
+void button_setPushButtonReleaseCallback(pButtonCallback callback);
+
+/**
+ * type of the gesture callback
+ *
+ * @param button   BUTTON_PUSH or BUTTON_ROTARY
+ * @param gesture  the recognized gesture (GESTURE_*)
+ */
+typedef void (*pButtonGestureCallback)(uint8_t button, uint8_t gesture);
+
+/** 
+ * Gesture Callback for short and long presses, double clicks and repeats
+ * while held; only called with debouncing, from the same context as the
+ * press callbacks
+ */
+void button_setGestureCallback(pButtonGestureCallback callback);
+
+/** 
+ * Button debouncing function, detects debounced presses and releases
+ * and advances the gesture recognition
  */
 void button_checkState(void);
 
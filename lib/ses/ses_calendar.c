@@ -0,0 +1,167 @@
+/* INCLUDES ******************************************************************/
+#include <stdlib.h>
+#include <avr/pgmspace.h>
+
+#include "ses_calendar.h"
+#include "ses_scheduler.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+#define CALENDAR_DAYS_PER_WEEK  7
+#define CALENDAR_FEBRUARY       2
+
+// 1st of January of CALENDAR_YEAR_MIN
+#define CALENDAR_WEEKDAY_MIN    CALENDAR_TUESDAY
+
+/* PRIVATE VARIABLES *********************************************************/
+
+static const uint8_t daysOfMonth[12] PROGMEM = {
+    31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
+};
+
+// days before the month in a common year, modulo 7
+static const uint8_t weekdayOfMonth[12] PROGMEM = {
+    0, 3, 3, 6, 1, 4, 6, 2, 5, 0, 3, 5
+};
+
+static date_t calendarDate = {
+    .year = CALENDAR_YEAR_MIN, .month = 1, .day = 1, .weekday = CALENDAR_WEEKDAY_MIN
+};
+
+// day of the scheduler clock calendarDate belongs to
+static uint16_t calendarDay = 0;
+
+/*FUNCTION DEFINITION ********************************************************/
+
+// the day after the date
+static void calendar_nextDay(date_t * date) {
+    date->weekday = (date->weekday + 1 < CALENDAR_DAYS_PER_WEEK) ? date->weekday + 1 : 0;
+
+    if(++date->day <= calendar_daysOfMonth(date->year, date->month)){
+        return;
+    }
+    date->day = 1;
+
+    if(++date->month <= 12){
+        return;
+    }
+    date->month = 1;
+    date->year++;
+}
+
+// catches up with the midnights the scheduler clock passed, usually none
+static void calendar_update(uint16_t day) {
+    while(calendarDay != day){
+        calendar_nextDay(&calendarDate);
+        calendarDay++;
+    }
+}
+
+static bool calendar_isValid(uint16_t year, uint8_t month, uint8_t day) {
+    return year >= CALENDAR_YEAR_MIN && year <= CALENDAR_YEAR_MAX &&
+           month >= 1 && month <= 12 &&
+           day >= 1 && day <= calendar_daysOfMonth(year, month);
+}
+
+uint8_t calendar_daysOfMonth(uint16_t year, uint8_t month) {
+    if(month == CALENDAR_FEBRUARY && calendar_isLeapYear(year)){
+        return 29;
+    }
+    return pgm_read_byte(&daysOfMonth[month - 1]);
+}
+
+uint8_t calendar_weekday(uint16_t year, uint8_t month, uint8_t day) {
+    uint8_t weekday = CALENDAR_WEEKDAY_MIN;
+
+    // a common year moves the weekday on by one, a leap year by two
+    for(uint16_t y = CALENDAR_YEAR_MIN; y < year; y++){
+        weekday += calendar_isLeapYear(y) ? 2 : 1;
+        if(weekday >= CALENDAR_DAYS_PER_WEEK){
+            weekday -= CALENDAR_DAYS_PER_WEEK;
+        }
+    }
+
+    weekday += pgm_read_byte(&weekdayOfMonth[month - 1]) + (day - 1);
+    if(month > CALENDAR_FEBRUARY && calendar_isLeapYear(year)){
+        weekday++;
+    }
+    while(weekday >= CALENDAR_DAYS_PER_WEEK){
+        weekday -= CALENDAR_DAYS_PER_WEEK;
+    }
+    return weekday;
+}
+
+bool calendar_setDate(uint16_t year, uint8_t month, uint8_t day) {
+    if(!calendar_isValid(year, month, day)){
+        return false;
+    }
+
+    calendarDay          = scheduler_getDay(NULL);
+    calendarDate.year    = year;
+    calendarDate.month   = month;
+    calendarDate.day     = day;
+    calendarDate.weekday = calendar_weekday(year, month, day);
+    return true;
+}
+
+uint16_t calendar_getDate(date_t * date) {
+    calendar_update(scheduler_getDay(NULL));
+    *date = calendarDate;
+    return calendarDay;
+}
+
+bool calendar_restore(const date_t * date, uint16_t day) {
+    if(!calendar_isValid(date->year, date->month, date->day) || date->weekday >= CALENDAR_DAYS_PER_WEEK){
+        return false;
+    }
+
+    calendarDate = *date;
+    calendarDay  = day;
+    return true;
+}
+
+calendar_timestamp_t calendar_getTimestamp(void) {
+    time_t clock;
+
+    // date and time of the same tick
+    calendar_update(scheduler_getDay(&clock));
+    return calendar_pack(&calendarDate, &clock);
+}
+
+calendar_timestamp_t calendar_pack(const date_t * date, const time_t * time) {
+    return ((calendar_timestamp_t)(date->year - CALENDAR_YEAR_MIN) << CALENDAR_TS_YEAR) |
+           ((calendar_timestamp_t)date->month << CALENDAR_TS_MONTH) |
+           ((calendar_timestamp_t)date->day << CALENDAR_TS_DAY) |
+           ((uint16_t)time->hour << CALENDAR_TS_HOUR) |
+           ((uint16_t)time->minute << CALENDAR_TS_MINUTE) |
+           (time->second >> 1);
+}
+
+bool calendar_unpack(calendar_timestamp_t timestamp, date_t * date, time_t * time) {
+    uint16_t year  = CALENDAR_YEAR_MIN + (uint8_t)(timestamp >> CALENDAR_TS_YEAR);
+    uint8_t month  = (timestamp >> CALENDAR_TS_MONTH) & 0x0F;
+    uint8_t day    = (timestamp >> CALENDAR_TS_DAY) & 0x1F;
+    uint16_t clock = (uint16_t)timestamp;
+    uint8_t hour   = clock >> CALENDAR_TS_HOUR;
+    uint8_t minute = (clock >> CALENDAR_TS_MINUTE) & 0x3F;
+    uint8_t second = (clock & 0x1F) << 1;
+
+    if(!calendar_isValid(year, month, day) || hour >= HOUR_PER_DAY ||
+       minute >= MIN_PER_HOUR || second >= SEC_PER_MIN){
+        return false;
+    }
+
+    if(date != NULL){
+        date->year    = year;
+        date->month   = month;
+        date->day     = day;
+        date->weekday = calendar_weekday(year, month, day);
+    }
+    if(time != NULL){
+        time->hour   = hour;
+        time->minute = minute;
+        time->second = second;
+        time->milli  = 0;
+    }
+    return true;
+}
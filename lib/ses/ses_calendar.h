@@ -0,0 +1,136 @@
+#ifndef SES_CALENDAR_H_
+#define SES_CALENDAR_H_
+
+/* INCLUDES ******************************************************************/
+
+#include <stdbool.h>
+#include <inttypes.h>
+#include "ses_scheduler.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+/* range of the dates, the range of the timestamps; within it every fourth
+year except 2100 is a leap year */
+#define CALENDAR_YEAR_MIN       1980
+#define CALENDAR_YEAR_MAX       2107
+
+/* weekdays, 0 is Monday like the days of ses_alarm */
+#define CALENDAR_MONDAY         0
+#define CALENDAR_TUESDAY        1
+#define CALENDAR_WEDNESDAY      2
+#define CALENDAR_THURSDAY       3
+#define CALENDAR_FRIDAY         4
+#define CALENDAR_SATURDAY       5
+#define CALENDAR_SUNDAY         6
+
+/*
+ * Fields of a timestamp, the layout of FAT file times:
+ *   bits 31 ... 25   year - CALENDAR_YEAR_MIN
+ *   bits 24 ... 21   month 1 ... 12
+ *   bits 20 ... 16   day 1 ... 31
+ *   bits 15 ... 11   hour
+ *   bits 10 ... 5    minute
+ *   bits  4 ... 0    second / 2
+ * Timestamps compare like the instants they stand for.
+ */
+#define CALENDAR_TS_YEAR        25
+#define CALENDAR_TS_MONTH       21
+#define CALENDAR_TS_DAY         16
+#define CALENDAR_TS_HOUR        11
+#define CALENDAR_TS_MINUTE      5
+
+/* TYPES *********************************************************************/
+
+/**
+ * A date of the Gregorian calendar
+ */
+typedef struct {
+    uint16_t year;      ///< CALENDAR_YEAR_MIN ... CALENDAR_YEAR_MAX
+    uint8_t month;      ///< 1 ... 12
+    uint8_t day;        ///< 1 ... days of the month
+    uint8_t weekday;    ///< CALENDAR_MONDAY ... CALENDAR_SUNDAY
+} date_t;
+
+/** date and time packed into 32 bits, see CALENDAR_TS_* */
+typedef uint32_t calendar_timestamp_t;
+
+/* FUNCTION PROTOTYPES *******************************************************/
+
+/**
+ * Sets the date of the current day of the scheduler clock. Until it is set,
+ * the calendar starts on the 1st of January of CALENDAR_YEAR_MIN.
+ *
+ * @return        false, if the date does not exist or is out of range
+ */
+bool calendar_setDate(uint16_t year, uint8_t month, uint8_t day);
+
+/**
+ * Gets the current date. The date only moves on by the days the scheduler
+ * clock passed midnight since the last call, one increment per day.
+ *
+ * @param date    stores the date
+ *
+ * @return        the day of the scheduler clock the date belongs to
+ */
+uint16_t calendar_getDate(date_t * date);
+
+/**
+ * Restores a date read by calendar_getDate, e.g. after a warm reset which
+ * kept the scheduler clock.
+ *
+ * @param date    the date
+ * @param day     the day of the scheduler clock the date belongs to
+ *
+ * @return        false, if the date does not exist or is out of range
+ */
+bool calendar_restore(const date_t * date, uint16_t day);
+
+/**
+ * Gets the timestamp of the current date and time.
+ *
+ * @return        the timestamp
+ */
+calendar_timestamp_t calendar_getTimestamp(void);
+
+/**
+ * Packs a date and time into a timestamp, the seconds are rounded down to
+ * even seconds.
+ *
+ * @return        the timestamp
+ */
+calendar_timestamp_t calendar_pack(const date_t * date, const time_t * time);
+
+/**
+ * Unpacks a timestamp, the weekday is computed.
+ *
+ * @param date    stores the date, may be NULL
+ * @param time    stores the time, may be NULL
+ *
+ * @return        false, if the timestamp holds no valid date and time
+ */
+bool calendar_unpack(calendar_timestamp_t timestamp, date_t * date, time_t * time);
+
+/**
+ * Check whether a year is a leap year.
+ *
+ * @param year    CALENDAR_YEAR_MIN ... CALENDAR_YEAR_MAX
+ */
+static inline bool calendar_isLeapYear(uint16_t year) {
+    return (year & 3) == 0 && year != 2100;
+}
+
+/**
+ * Gets the number of days of a month.
+ *
+ * @param month   1 ... 12
+ */
+uint8_t calendar_daysOfMonth(uint16_t year, uint8_t month);
+
+/**
+ * Gets the weekday of a date.
+ *
+ * @return        CALENDAR_MONDAY ... CALENDAR_SUNDAY
+ */
+uint8_t calendar_weekday(uint16_t year, uint8_t month, uint8_t day);
+
+#endif /* SES_CALENDAR_H_ */
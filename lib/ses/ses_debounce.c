@@ -0,0 +1,105 @@
+/* INCLUDES ******************************************************************/
+#include <stdlib.h>
+#include <util/atomic.h>
+
+#include "ses_debounce.h"
+
+/* TYPES *********************************************************************/
+
+/**
+ * A registered port, sampled with one read
+ */
+typedef struct {
+    volatile uint8_t * pin;     ///< PINx register
+    uint8_t mask;               ///< debounced bits
+    uint8_t activeLow;          ///< bits which are inverted
+} debounce_port_t;
+
+/* PRIVATE VARIABLES *********************************************************/
+
+static debounce_port_t ports[DEBOUNCE_PORTS];
+static uint8_t portCount = 0;
+
+// debounced state, one bit per lane
+static volatile debounce_mask_t state = 0;
+
+// vertical counters: counters[i] holds bit i of the counters of all lanes
+static debounce_mask_t counters[DEBOUNCE_COUNTER_BITS];
+
+static pDebounceCallback callback = NULL;
+
+/*FUNCTION DEFINITION ********************************************************/
+
+static debounce_mask_t debounce_sample(void) {
+    debounce_mask_t sample = 0;
+
+    for(uint8_t i = 0; i < portCount; i++){
+        uint8_t bits = (*ports[i].pin ^ ports[i].activeLow) & ports[i].mask;
+        sample |= (debounce_mask_t)bits << (8 * i);
+    }
+    return sample;
+}
+
+uint8_t debounce_addPort(volatile uint8_t * pin, uint8_t mask, uint8_t activeLow) {
+    if(pin == NULL || portCount == DEBOUNCE_PORTS){
+        return DEBOUNCE_NO_LANE;
+    }
+
+    ports[portCount].pin       = pin;
+    ports[portCount].mask      = mask;
+    ports[portCount].activeLow = activeLow & mask;
+
+    return 8 * portCount++;
+}
+
+void debounce_setCallback(pDebounceCallback cb) {
+    callback = cb;
+}
+
+void debounce_update(void) {
+    // lanes whose sample differs from the debounced state count up, all others restart
+    debounce_mask_t delta = debounce_sample() ^ state;
+    debounce_mask_t carry = delta;
+
+    // bit-sliced increment: one ripple step per counter bit, not per sample
+    for(uint8_t i = 0; i < DEBOUNCE_COUNTER_BITS; i++){
+        debounce_mask_t bit = counters[i];
+        counters[i] = (bit ^ carry) & delta;
+        carry &= bit;
+    }
+
+    // a counter overflows on the DEBOUNCE_SAMPLES-th differing sample in a row
+    if(carry == 0){
+        return;
+    }
+
+    state ^= carry;
+
+    if(callback != NULL){
+        callback(carry & state, carry & ~state);
+    }
+}
+
+bool debounce_isSettled(void) {
+    debounce_mask_t counting = 0;
+
+    // a counter is only nonzero while its input differs from its state
+    for(uint8_t i = 0; i < DEBOUNCE_COUNTER_BITS; i++){
+        counting |= counters[i];
+    }
+    return counting == 0;
+}
+
+debounce_mask_t debounce_getPending(void) {
+    return debounce_sample() ^ state;
+}
+
+debounce_mask_t debounce_getState(void) {
+    debounce_mask_t current;
+
+    // debounce_update may run in a timer interrupt
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        current = state;
+    }
+    return current;
+}
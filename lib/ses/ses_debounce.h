@@ -0,0 +1,108 @@
+#ifndef SES_DEBOUNCE_H_
+#define SES_DEBOUNCE_H_
+
+/* INCLUDES ******************************************************************/
+
+#include <stdbool.h>
+#include <inttypes.h>
+
+/* DEFINES & MACROS **********************************************************/
+
+/*
+ * Debounces up to DEBOUNCE_LANES digital inputs in parallel. Every input has
+ * a counter of DEBOUNCE_COUNTER_BITS bits, stored "vertically": bit i of all
+ * counters is one word, so one call updates all counters with a few bitwise
+ * operations. An input changes its debounced state after it differed from
+ * it for DEBOUNCE_SAMPLES consecutive calls.
+ *
+ * Lanes are assigned per port: the n-th registered port occupies lanes
+ * 8 * n ... 8 * n + 7, lane 8 * n + b is bit b of the port.
+ */
+
+/* number of inputs, 8 or 16 (two ports) */
+#ifndef DEBOUNCE_LANES
+#define DEBOUNCE_LANES              8
+#endif
+
+/* bits per counter; 3 bits need 8 stable samples, 40ms at a 5ms period */
+#ifndef DEBOUNCE_COUNTER_BITS
+#define DEBOUNCE_COUNTER_BITS       3
+#endif
+
+#define DEBOUNCE_SAMPLES            (1 << DEBOUNCE_COUNTER_BITS)
+#define DEBOUNCE_PORTS              (DEBOUNCE_LANES / 8)
+
+/* returned by debounce_addPort if all ports are taken */
+#define DEBOUNCE_NO_LANE            0xFF
+
+/* mask of lane n */
+#define DEBOUNCE_LANE(n)            ((debounce_mask_t)1 << (n))
+
+/* TYPES *********************************************************************/
+
+#if DEBOUNCE_LANES == 16
+typedef uint16_t debounce_mask_t;
+#elif DEBOUNCE_LANES == 8
+typedef uint8_t debounce_mask_t;
+#else
+#error "DEBOUNCE_LANES must be 8 or 16"
+#endif
+
+/**
+ * Called by debounce_update if at least one input changed its debounced state
+ *
+ * @param pressed   lanes which became active
+ * @param released  lanes which became inactive
+ */
+typedef void (*pDebounceCallback)(debounce_mask_t pressed, debounce_mask_t released);
+
+/* FUNCTION PROTOTYPES *******************************************************/
+
+/**
+ * Registers inputs of a port. The pins must already be configured as inputs.
+ * All inputs start inactive.
+ *
+ * @param pin        PINx register of the port
+ * @param mask       bits of the port to debounce
+ * @param activeLow  bits of the port which are active when they read 0
+ *
+ * @return           first lane of the port, DEBOUNCE_NO_LANE if all ports are taken
+ */
+uint8_t debounce_addPort(volatile uint8_t * pin, uint8_t mask, uint8_t activeLow);
+
+/**
+ * Sets the function which is called on debounced edges.
+ *
+ * @param callback  the edge callback, NULL for none
+ */
+void debounce_setCallback(pDebounceCallback callback);
+
+/**
+ * Samples all registered ports once and updates the debounced states; to be
+ * called periodically from a task or timer interrupt.
+ */
+void debounce_update(void);
+
+/**
+ * Check whether all inputs matched their debounced state at the last
+ * debounce_update, i.e. no edge is being counted.
+ *
+ * @return  true, if all counters are zero
+ */
+bool debounce_isSettled(void);
+
+/**
+ * Samples all registered ports without updating the debounced states.
+ *
+ * @return  a set bit for every lane whose input differs from its debounced state
+ */
+debounce_mask_t debounce_getPending(void);
+
+/**
+ * Get the debounced state of all lanes.
+ *
+ * @return  a set bit for every active lane
+ */
+debounce_mask_t debounce_getState(void);
+
+#endif /* SES_DEBOUNCE_H_ */
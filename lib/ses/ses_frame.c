@@ -0,0 +1,119 @@
+/* INCLUDES ******************************************************************/
+#include <stdlib.h>
+#include <util/crc16.h>
+
+#include "ses_frame.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+// start value of the CRC-16/CCITT
+#define FRAME_CRC_INIT          0xFFFF
+
+// code byte of a COBS block with 254 data bytes and no following zero
+#define FRAME_COBS_MAX_CODE     0xFF
+
+/* PRIVATE FUNCTIONS *********************************************************/
+
+static uint16_t frame_crc(const uint8_t * data, uint8_t len) {
+    uint16_t crc = FRAME_CRC_INIT;
+
+    for(uint8_t i = 0; i < len; i++){
+        crc = _crc_ccitt_update(crc, data[i]);
+    }
+
+    return crc;
+}
+
+static void frame_append(frame_decoder_t * decoder, uint8_t byte) {
+    if(decoder->length >= sizeof(decoder->data)){
+        decoder->overflow = true;
+        return;
+    }
+    decoder->data[decoder->length++] = byte;
+}
+
+/*FUNCTION DEFINITION ********************************************************/
+
+void frame_decoderReset(frame_decoder_t * decoder) {
+    decoder->length    = 0;
+    decoder->remaining = 0;
+    decoder->blockCode = 0;
+    decoder->overflow  = false;
+}
+
+uint8_t frame_decode(frame_decoder_t * decoder, uint8_t byte) {
+
+    // case 1: end of frame
+    if(byte == FRAME_DELIMITER){
+        uint8_t len = decoder->length;
+        bool complete = decoder->blockCode != 0 && decoder->remaining == 0 && !decoder->overflow;
+
+        frame_decoderReset(decoder);
+
+        // at least one payload byte and the CRC
+        if(!complete || len <= FRAME_CRC_SIZE){
+            return 0;
+        }
+
+        len -= FRAME_CRC_SIZE;
+        uint16_t crc = decoder->data[len] | ((uint16_t)decoder->data[len + 1] << 8);
+
+        return (frame_crc(decoder->data, len) == crc) ? len : 0;
+    }
+
+    // case 2: COBS code byte starting a new block
+    if(decoder->remaining == 0){
+        // every block except the first and the full ones replaced a zero byte
+        if(decoder->blockCode != 0 && decoder->blockCode != FRAME_COBS_MAX_CODE){
+            frame_append(decoder, 0);
+        }
+        decoder->blockCode = byte;
+        decoder->remaining = byte - 1;
+        return 0;
+    }
+
+    // case 3: data byte of the current block
+    frame_append(decoder, byte);
+    decoder->remaining--;
+
+    return 0;
+}
+
+uint8_t frame_encode(const uint8_t * payload, uint8_t len, uint8_t * out) {
+
+    if(payload == NULL || out == NULL || len > FRAME_MAX_ENCODE_PAYLOAD){
+        return 0;
+    }
+
+    uint16_t crc = frame_crc(payload, len);
+    uint8_t codeIndex = 0;      // position of the code byte of the current block
+    uint8_t code = 1;           // code of the current block: data bytes + 1
+    uint8_t outLen = 1;
+
+    for(uint8_t i = 0; i < len + FRAME_CRC_SIZE; i++){
+        uint8_t byte;
+
+        if(i < len){
+            byte = payload[i];
+        }
+        else{
+            byte = (i == len) ? (uint8_t)crc : (uint8_t)(crc >> 8);
+        }
+
+        // a zero closes the block, its position holds the next code byte
+        if(byte == 0){
+            out[codeIndex] = code;
+            codeIndex = outLen++;
+            code = 1;
+        }
+        else{
+            out[outLen++] = byte;
+            code++;
+        }
+    }
+
+    out[codeIndex] = code;
+    out[outLen++] = FRAME_DELIMITER;
+
+    return outLen;
+}
@@ -0,0 +1,72 @@
+#ifndef SES_FRAME_H_
+#define SES_FRAME_H_
+
+/* INCLUDES ******************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+/* DEFINES & MACROS **********************************************************/
+
+// largest payload of a received frame
+#define FRAME_MAX_PAYLOAD       16
+
+// largest payload of a sent frame, limited by the USB serial TX buffer
+#define FRAME_MAX_ENCODE_PAYLOAD    120
+
+// CRC-16/CCITT appended to the payload, little endian
+#define FRAME_CRC_SIZE          2
+
+// frame delimiter, never part of the COBS encoded data
+#define FRAME_DELIMITER         0x00
+
+// size of an encoded frame: COBS overhead byte, payload, CRC and delimiter
+#define FRAME_ENCODED_SIZE(len) ((len) + FRAME_CRC_SIZE + 2)
+
+/* TYPES *********************************************************************/
+
+/**
+ * State of the incremental frame decoder. Frames are COBS encoded, end with a
+ * FRAME_DELIMITER byte and carry a CRC-16/CCITT behind the payload. Each
+ * received byte is decoded in place, so no raw frame is ever buffered.
+ */
+typedef struct {
+    uint8_t data[FRAME_MAX_PAYLOAD + FRAME_CRC_SIZE];   ///< decoded payload and CRC
+    uint8_t length;         ///< number of decoded bytes in data
+    uint8_t remaining;      ///< data bytes left in the current COBS block
+    uint8_t blockCode;      ///< code byte of the current COBS block, 0 before the first block
+    bool overflow;          ///< frame was too long and is discarded
+} frame_decoder_t;
+
+
+/* FUNCTION PROTOTYPES *******************************************************/
+
+/**
+ * Resets the decoder to wait for the start of a frame.
+ */
+void frame_decoderReset(frame_decoder_t * decoder);
+
+/**
+ * Feeds one received byte into the decoder.
+ *
+ * @param decoder	pointer to the decoder state
+ * @param byte		received byte
+ *
+ * @return		payload length if the byte completed a frame with a valid
+ * 				CRC, the payload is then in decoder->data until the next
+ * 				call; 0 otherwise
+ */
+uint8_t frame_decode(frame_decoder_t * decoder, uint8_t byte);
+
+/**
+ * Appends the CRC to a payload, COBS encodes it and terminates it with the
+ * delimiter.
+ *
+ * @param payload	payload to encode
+ * @param len		payload length, at most FRAME_MAX_ENCODE_PAYLOAD
+ * @param out		buffer of at least FRAME_ENCODED_SIZE(len) bytes
+ *
+ * @return			number of bytes written to out, 0 if len is too large
+ */
+uint8_t frame_encode(const uint8_t * payload, uint8_t len, uint8_t * out);
+
+#endif /* SES_FRAME_H_ */
@@ -0,0 +1,180 @@
+/* INCLUDES ******************************************************************/
+#include <stdlib.h>
+#include <avr/pgmspace.h>
+
+#include "ses_fsm.h"
+#include "ses_log.h"
+
+/*FUNCTION DEFINITION ********************************************************/
+
+static uint8_t fsm_parent(const fsm_machine_t * fsm, uint8_t state) {
+    return pgm_read_byte(&fsm->definition->states[state].parent);
+}
+
+static void fsm_runStateAction(fsm_machine_t * fsm, uint8_t state, bool entry) {
+    fsm_state_t descriptor;
+
+    memcpy_P(&descriptor, &fsm->definition->states[state], sizeof(descriptor));
+
+    // actions see the state they belong to as the current state
+    fsm->state = state;
+
+    fsm_stateAction_t action = entry ? descriptor.entry : descriptor.exit;
+    if(action != NULL){
+        action(fsm->context);
+    }
+}
+
+// leaf state of a transition target: the recorded history or the initial substates
+static uint8_t fsm_resolveTarget(const fsm_machine_t * fsm, uint8_t target) {
+    const fsm_definition_t * definition = fsm->definition;
+
+    if(target & FSM_HISTORY_FLAG){
+        target &= ~FSM_HISTORY_FLAG;
+        if(target < definition->stateCount && definition->history != NULL &&
+           definition->history[target] != FSM_NO_STATE){
+            return definition->history[target];
+        }
+    }
+
+    if(target >= definition->stateCount){
+        return FSM_NO_STATE;
+    }
+
+    for(uint8_t depth = 0; depth < FSM_MAX_DEPTH; depth++){
+        uint8_t initial = pgm_read_byte(&definition->states[target].initial);
+        if(initial == FSM_NO_STATE){
+            break;
+        }
+        target = initial;
+    }
+    return target;
+}
+
+// states from the leaf up to the top level, returns the number of states
+static uint8_t fsm_ancestors(const fsm_machine_t * fsm, uint8_t leaf, uint8_t * path) {
+    uint8_t depth = 0;
+
+    for(uint8_t state = leaf; state != FSM_NO_STATE && depth < FSM_MAX_DEPTH; state = fsm_parent(fsm, state)){
+        path[depth++] = state;
+    }
+    return depth;
+}
+
+void fsm_init(fsm_machine_t * fsm, const fsm_definition_t * definition, void * context, uint8_t initial) {
+    if(fsm == NULL || definition == NULL || initial >= definition->stateCount){
+        return;
+    }
+
+    fsm->definition = definition;
+    fsm->context    = context;
+
+    if(definition->history != NULL){
+        for(uint8_t state = 0; state < definition->stateCount; state++){
+            definition->history[state] = FSM_NO_STATE;
+        }
+    }
+
+    // entry actions from the top level state down to the initial leaf
+    uint8_t path[FSM_MAX_DEPTH];
+    uint8_t depth = fsm_ancestors(fsm, fsm_resolveTarget(fsm, initial), path);
+
+    while(depth > 0){
+        fsm_runStateAction(fsm, path[--depth], true);
+    }
+}
+
+fsm_return_status_t fsm_dispatch(fsm_machine_t * fsm, const fsm_event_t * event) {
+    if(fsm == NULL || event == NULL || fsm->definition == NULL){
+        return RET_ERROR;
+    }
+
+    const fsm_definition_t * definition = fsm->definition;
+
+    if(event->signal >= definition->signalCount){
+        return RET_IGNORED;
+    }
+
+    // the innermost state with a cell for the signal handles it
+    uint8_t depth = 0;
+    for(uint8_t state = fsm->state; state != FSM_NO_STATE && depth < FSM_MAX_DEPTH; state = fsm_parent(fsm, state), depth++){
+        fsm_cell_t cell;
+        memcpy_P(&cell, &definition->table[state * definition->signalCount + event->signal], sizeof(cell));
+
+        if(cell.action == NULL && cell.flags == 0){
+            continue;
+        }
+
+        LOG2(FSM_EVENT, event->signal, state);
+
+        uint8_t next = cell.next;
+        if(cell.action != NULL){
+            uint8_t chosen = cell.action(fsm->context, event);
+            if(cell.flags & FSM_CELL_CHOICE){
+                next = chosen;
+            }
+        }
+
+        if(!(cell.flags & (FSM_CELL_TRANSITION | FSM_CELL_CHOICE)) || next == FSM_STAY){
+            return RET_HANDLED;
+        }
+
+        fsm_transition(fsm, next);
+        return RET_TRANSITION;
+    }
+
+    return RET_IGNORED;
+}
+
+void fsm_transition(fsm_machine_t * fsm, uint8_t next) {
+    uint8_t leaf = fsm_resolveTarget(fsm, next);
+    if(leaf == FSM_NO_STATE){
+        return;
+    }
+
+    uint8_t source = fsm->state;
+    uint8_t * history = fsm->definition->history;
+
+    LOG2(FSM_TRANSITION, source, leaf);
+
+    uint8_t path[FSM_MAX_DEPTH];
+    uint8_t depth = fsm_ancestors(fsm, leaf, path);
+    uint8_t common = depth;
+
+    // exit actions up to the least common ancestor; a self-transition leaves the leaf too
+    for(uint8_t state = source; state != FSM_NO_STATE; state = fsm_parent(fsm, state)){
+        if(state != leaf){
+            uint8_t level = 0;
+            while(level < depth && path[level] != state){
+                level++;
+            }
+            if(level < depth){
+                common = level;
+                break;
+            }
+        }
+
+        fsm_runStateAction(fsm, state, false);
+
+        // a composite state remembers the leaf it was left from
+        if(history != NULL && state != source){
+            history[state] = source;
+        }
+    }
+
+    // entry actions from below the least common ancestor down to the new leaf
+    while(common > 0){
+        fsm_runStateAction(fsm, path[--common], true);
+    }
+}
+
+bool fsm_isInState(const fsm_machine_t * fsm, uint8_t state) {
+    uint8_t depth = 0;
+
+    for(uint8_t current = fsm->state; current != FSM_NO_STATE && depth < FSM_MAX_DEPTH; current = fsm_parent(fsm, current), depth++){
+        if(current == state){
+            return true;
+        }
+    }
+    return false;
+}
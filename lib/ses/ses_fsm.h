@@ -0,0 +1,175 @@
+#ifndef SES_FSM_H_
+#define SES_FSM_H_
+
+/* INCLUDES ******************************************************************/
+
+#include <stdbool.h>
+#include <inttypes.h>
+#include <avr/pgmspace.h>
+
+/* DEFINES & MACROS **********************************************************/
+
+/* returned by an action: no choice, stay in the current state */
+#define FSM_STAY                0xFF
+
+/* no parent, no initial substate or no recorded history */
+#define FSM_NO_STATE            0xFF
+
+/* deepest nesting of states */
+#define FSM_MAX_DEPTH           8
+
+/* target of a transition: the leaf state last active below a composite
+state, the initial substate if there was none; states are below 0x7F */
+#define FSM_HISTORY_FLAG        0x80
+#define FSM_HISTORY(state)      ((state) | FSM_HISTORY_FLAG)
+
+/* cell flags */
+#define FSM_CELL_TRANSITION     0x01    /* change to the next state of the cell */
+#define FSM_CELL_CHOICE         0x02    /* change to the state returned by the action */
+
+/*
+ * Cells of a transition table, a missing cell is unhandled:
+ *   FSM_ON(action)             internal, runs the action and stays
+ *   FSM_GOTO(action, next)     runs the action, exit and entry actions follow;
+ *                              the action may be NULL
+ *   FSM_CHOOSE(action)         runs the action, which returns the next state
+ *                              or FSM_STAY
+ * A state without a cell for a signal passes it on to its parent state.
+ */
+#define FSM_ON(action)          { (action), 0, 0 }
+#define FSM_GOTO(action, next)  { (action), (next), FSM_CELL_TRANSITION }
+#define FSM_CHOOSE(action)      { (action), 0, FSM_CELL_CHOICE }
+
+/*
+ * States of a definition:
+ *   FSM_STATE(parent, entry, exit)                leaf state
+ *   FSM_COMPOSITE(parent, initial, entry, exit)   state containing substates,
+ *                                                 entered through initial
+ * parent is FSM_NO_STATE for top level states. A transition to a composite
+ * state ends in its initial leaf; exit and entry actions run from the
+ * current leaf up to the least common ancestor and down to the new leaf.
+ */
+#define FSM_STATE(parent, entry, exit)              { (entry), (exit), (parent), FSM_NO_STATE }
+#define FSM_COMPOSITE(parent, initial, entry, exit) { (entry), (exit), (parent), (initial) }
+
+/* TYPES *********************************************************************/
+
+/** return values of fsm_dispatch */
+enum return_values {
+    RET_HANDLED,    //< event was handled
+    RET_IGNORED,    //< the current state has no cell for the event, nothing was executed
+    RET_TRANSITION, //< event was handled and a state transition occurred
+    RET_ERROR       //< invalid machine or event
+};
+
+typedef enum return_values fsm_return_status_t; //< typedef return value
+
+/**
+ * Event of a state machine
+ */
+typedef struct {
+    uint8_t signal; //< identifies the type of event, column of the transition table
+    int16_t param;  //< signal specific value
+} fsm_event_t;
+
+/** action of a cell, returns the next state for FSM_CHOOSE and FSM_STAY otherwise */
+typedef uint8_t (*fsm_action_t)(void * context, const fsm_event_t * event);
+
+/** entry or exit action of a state */
+typedef void (*fsm_stateAction_t)(void * context);
+
+/**
+ * One cell of a transition table, state x signal, stored in flash
+ */
+typedef struct {
+    fsm_action_t action;    //< NULL for transitions without an action
+    uint8_t next;           //< next state of FSM_CELL_TRANSITION
+    uint8_t flags;          //< FSM_CELL_*
+} fsm_cell_t;
+
+/**
+ * A state, stored in flash; entry and exit action may be NULL
+ */
+typedef struct {
+    fsm_stateAction_t entry;
+    fsm_stateAction_t exit;
+    uint8_t parent;         //< enclosing state, FSM_NO_STATE at the top level
+    uint8_t initial;        //< substate entered first, FSM_NO_STATE for leaf states
+} fsm_state_t;
+
+/**
+ * Constant description of a state machine
+ */
+typedef struct {
+    const fsm_cell_t * table;       //< flash, stateCount rows of signalCount cells
+    const fsm_state_t * states;     //< flash, stateCount entries
+    uint8_t * history;              //< RAM, stateCount entries, NULL without FSM_HISTORY targets
+    uint8_t stateCount;             //< states are numbered 0 ... stateCount - 1, at most 0x7F
+    uint8_t signalCount;            //< signals are numbered 0 ... signalCount - 1
+} fsm_definition_t;
+
+/**
+ * A running state machine
+ */
+typedef struct {
+    const fsm_definition_t * definition;
+    void * context;                 //< passed to all actions
+    uint8_t state;                  //< current leaf state
+} fsm_machine_t;
+
+/* FUNCTION PROTOTYPES *******************************************************/
+
+/**
+ * Initializes a state machine and runs the entry actions from the top level
+ * state down to the initial leaf state.
+ *
+ * @param fsm         the state machine
+ * @param definition  transition table and states, must stay valid
+ * @param context     passed to all actions
+ * @param initial     initial state
+ */
+void fsm_init(fsm_machine_t * fsm, const fsm_definition_t * definition, void * context, uint8_t initial);
+
+/**
+ * Dispatches an event with one table lookup per nesting level, from the
+ * current leaf up to the first state with a cell for the signal. Signals
+ * without a cell return without any side effect.
+ *
+ * @param fsm    the state machine
+ * @param event  the event, signals outside the table are ignored
+ *
+ * @return       RET_IGNORED, RET_HANDLED or RET_TRANSITION
+ */
+fsm_return_status_t fsm_dispatch(fsm_machine_t * fsm, const fsm_event_t * event);
+
+/**
+ * Changes the state without an event: exit actions up to the least common
+ * ancestor, entry actions down to the next leaf state.
+ *
+ * @param fsm   the state machine
+ * @param next  the next state, may be composite or FSM_HISTORY(state)
+ */
+void fsm_transition(fsm_machine_t * fsm, uint8_t next);
+
+/**
+ * Check whether a state is the current leaf state or one of its ancestors.
+ *
+ * @param fsm    the state machine
+ * @param state  the state
+ *
+ * @return       true, if the machine is in the state
+ */
+bool fsm_isInState(const fsm_machine_t * fsm, uint8_t state);
+
+/**
+ * Get the current leaf state.
+ *
+ * @param fsm   the state machine
+ *
+ * @return      the current leaf state
+ */
+static inline uint8_t fsm_getState(const fsm_machine_t * fsm) {
+    return fsm->state;
+}
+
+#endif /* SES_FSM_H_ */
@@ -0,0 +1,98 @@
+/* INCLUDES ******************************************************************/
+#include <stdlib.h>
+
+#include "ses_gesture.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+// phases of the gesture state machine
+#define GESTURE_PHASE_IDLE          0   // released, nothing pending
+#define GESTURE_PHASE_PRESSED       1   // pressed, shorter than GESTURE_LONG_MS
+#define GESTURE_PHASE_RELEASED      2   // released after a short press, waiting for a second press
+#define GESTURE_PHASE_HELD          3   // long press, sending repeats until the release
+#define GESTURE_PHASE_SECOND        4   // second press of a double click, ignored until the release
+
+/*FUNCTION DEFINITION ********************************************************/
+
+void gesture_init(gesture_t * gesture, bool doubleClick) {
+    if(gesture == NULL){
+        return;
+    }
+
+    gesture->phase          = GESTURE_PHASE_IDLE;
+    gesture->doubleClick    = doubleClick;
+    gesture->elapsed        = 0;
+    gesture->repeatInterval = GESTURE_REPEAT_START_MS;
+}
+
+uint8_t gesture_update(gesture_t * gesture, bool pressed, bool released, uint8_t tick) {
+    uint8_t event = GESTURE_NONE;
+
+    gesture->elapsed += tick;
+
+    switch(gesture->phase){
+        case GESTURE_PHASE_IDLE:
+            if(pressed){
+                gesture->phase   = GESTURE_PHASE_PRESSED;
+                gesture->elapsed = 0;
+            }
+            break;
+
+        case GESTURE_PHASE_PRESSED:
+            if(released){
+                if(gesture->doubleClick){
+                    gesture->phase   = GESTURE_PHASE_RELEASED;
+                    gesture->elapsed = 0;
+                }
+                else{
+                    gesture->phase = GESTURE_PHASE_IDLE;
+                    event = GESTURE_SHORT;
+                }
+            }
+            else if(gesture->elapsed >= GESTURE_LONG_MS){
+                gesture->phase          = GESTURE_PHASE_HELD;
+                gesture->elapsed        = 0;
+                gesture->repeatInterval = GESTURE_REPEAT_START_MS;
+                event = GESTURE_LONG;
+            }
+            break;
+
+        case GESTURE_PHASE_RELEASED:
+            if(pressed){
+                gesture->phase = GESTURE_PHASE_SECOND;
+                event = GESTURE_DOUBLE;
+            }
+            else if(gesture->elapsed >= GESTURE_DOUBLE_MS){
+                gesture->phase = GESTURE_PHASE_IDLE;
+                event = GESTURE_SHORT;
+            }
+            break;
+
+        case GESTURE_PHASE_HELD:
+            if(released){
+                gesture->phase = GESTURE_PHASE_IDLE;
+            }
+            else if(gesture->elapsed >= gesture->repeatInterval){
+                gesture->elapsed = 0;
+                // accelerate by a quarter of the interval down to the minimum
+                gesture->repeatInterval -= gesture->repeatInterval >> 2;
+                if(gesture->repeatInterval < GESTURE_REPEAT_MIN_MS){
+                    gesture->repeatInterval = GESTURE_REPEAT_MIN_MS;
+                }
+                event = GESTURE_REPEAT;
+            }
+            break;
+
+        case GESTURE_PHASE_SECOND:
+            if(released){
+                gesture->phase = GESTURE_PHASE_IDLE;
+            }
+            break;
+    }
+
+    return event;
+}
+
+bool gesture_isBusy(const gesture_t * gesture) {
+    return gesture->phase != GESTURE_PHASE_IDLE;
+}
@@ -0,0 +1,73 @@
+#ifndef SES_GESTURE_H_
+#define SES_GESTURE_H_
+
+/* INCLUDES ******************************************************************/
+
+#include <stdbool.h>
+#include <inttypes.h>
+
+/* DEFINES & MACROS **********************************************************/
+
+/* hold time which makes a press long */
+#define GESTURE_LONG_MS             600
+/* time after a short press in which a second press is a double click */
+#define GESTURE_DOUBLE_MS           250
+/* first interval of the repeat events after a long press */
+#define GESTURE_REPEAT_START_MS     300
+/* shortest repeat interval, every repeat shortens the interval by a quarter */
+#define GESTURE_REPEAT_MIN_MS       40
+
+/* TYPES *********************************************************************/
+
+/** events of the gesture engine */
+enum gesture_events {
+    GESTURE_NONE,       //< nothing happened
+    GESTURE_SHORT,      //< released before GESTURE_LONG_MS, no second press followed
+    GESTURE_LONG,       //< held for GESTURE_LONG_MS
+    GESTURE_REPEAT,     //< still held, sent with an accelerating rate after GESTURE_LONG
+    GESTURE_DOUBLE      //< second press within GESTURE_DOUBLE_MS after a short press
+};
+
+/**
+ * Gesture state of one input
+ */
+typedef struct {
+    uint8_t phase;              ///< internal state
+    bool doubleClick;           ///< double clicks are detected, this delays GESTURE_SHORT
+    uint16_t elapsed;           ///< ms in the current phase
+    uint16_t repeatInterval;    ///< ms until the next GESTURE_REPEAT
+} gesture_t;
+
+/* FUNCTION PROTOTYPES *******************************************************/
+
+/**
+ * Initializes the gesture state of an input, which starts released.
+ *
+ * @param gesture      the gesture state
+ * @param doubleClick  detect double clicks; without, GESTURE_SHORT is sent right at the release
+ */
+void gesture_init(gesture_t * gesture, bool doubleClick);
+
+/**
+ * Advances the gesture state by one debouncer tick.
+ *
+ * @param gesture   the gesture state
+ * @param pressed   the debounced input was pressed in this tick
+ * @param released  the debounced input was released in this tick
+ * @param tick      ms since the previous call
+ *
+ * @return          the recognized gesture, GESTURE_NONE if there is none
+ */
+uint8_t gesture_update(gesture_t * gesture, bool pressed, bool released, uint8_t tick);
+
+/**
+ * Check whether the gesture state still needs ticks to send an event,
+ * i.e. the input is held or a double click may follow.
+ *
+ * @param gesture   the gesture state
+ *
+ * @return          false, if the input is released and no gesture is pending
+ */
+bool gesture_isBusy(const gesture_t * gesture);
+
+#endif /* SES_GESTURE_H_ */
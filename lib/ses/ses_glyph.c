@@ -0,0 +1,175 @@
+/* INCLUDES ******************************************************************/
+#include <avr/pgmspace.h>
+
+#include "ses_glyph.h"
+#include "ses_display.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+// number of pixel lines per display page
+#define GLYPH_LINES_PER_PAGE    8
+
+// number of digits on the clock face (hh:mm:ss)
+#define GLYPH_CLOCK_DIGITS      6
+
+// left column of the clock face, centered on the display
+#define GLYPH_CLOCK_X           ((GLYPH_DISPLAY_WIDTH - GLYPH_CLOCK_DIGITS * GLYPH_BIGDIGIT_WIDTH - 2 * GLYPH_COLON_WIDTH) / 2)
+
+// marks a clock face digit as not drawn yet
+#define GLYPH_DIGIT_INVALID     0xFF
+
+/* PRIVATE VARIABLES *********************************************************/
+
+/**
+ * Large 7-segment style digits 0-9, column packed, page by page
+ */
+static const uint8_t bigDigitFont[10][GLYPH_BIGDIGIT_PAGES][GLYPH_BIGDIGIT_WIDTH] PROGMEM = {
+    {   /* 0 */
+        { 0x00, 0xFC, 0xFE, 0xFE, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0xFE, 0xFE, 0xFC, 0x00 },
+        { 0x00, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0x00 },
+        { 0x00, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0x00 },
+        { 0x00, 0x3F, 0x7F, 0x7F, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x7F, 0x7F, 0x3F, 0x00 },
+    },
+    {   /* 1 */
+        { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFC, 0xFC, 0xFC, 0x00 },
+        { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0x00 },
+        { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0x00 },
+        { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x3F, 0x3F, 0x00 },
+    },
+    {   /* 2 */
+        { 0x00, 0x00, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0xFE, 0xFE, 0xFC, 0x00 },
+        { 0x00, 0x00, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xFF, 0xFF, 0xFF, 0x00 },
+        { 0x00, 0xFF, 0xFF, 0xFF, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00, 0x00 },
+        { 0x00, 0x3F, 0x7F, 0x7F, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x00, 0x00 },
+    },
+    {   /* 3 */
+        { 0x00, 0x00, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0xFE, 0xFE, 0xFC, 0x00 },
+        { 0x00, 0x00, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xFF, 0xFF, 0xFF, 0x00 },
+        { 0x00, 0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0xFF, 0xFF, 0xFF, 0x00 },
+        { 0x00, 0x00, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x7F, 0x7F, 0x3F, 0x00 },
+    },
+    {   /* 4 */
+        { 0x00, 0xFC, 0xFC, 0xFC, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFC, 0xFC, 0xFC, 0x00 },
+        { 0x00, 0xFF, 0xFF, 0xFF, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xFF, 0xFF, 0xFF, 0x00 },
+        { 0x00, 0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0xFF, 0xFF, 0xFF, 0x00 },
+        { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x3F, 0x3F, 0x00 },
+    },
+    {   /* 5 */
+        { 0x00, 0xFC, 0xFE, 0xFE, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x00, 0x00 },
+        { 0x00, 0xFF, 0xFF, 0xFF, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0x00, 0x00 },
+        { 0x00, 0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0xFF, 0xFF, 0xFF, 0x00 },
+        { 0x00, 0x00, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x7F, 0x7F, 0x3F, 0x00 },
+    },
+    {   /* 6 */
+        { 0x00, 0xFC, 0xFE, 0xFE, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x00, 0x00 },
+        { 0x00, 0xFF, 0xFF, 0xFF, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0x00, 0x00 },
+        { 0x00, 0xFF, 0xFF, 0xFF, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0xFF, 0xFF, 0xFF, 0x00 },
+        { 0x00, 0x3F, 0x7F, 0x7F, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x7F, 0x7F, 0x3F, 0x00 },
+    },
+    {   /* 7 */
+        { 0x00, 0x00, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0xFE, 0xFE, 0xFC, 0x00 },
+        { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0x00 },
+        { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0x00 },
+        { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x3F, 0x3F, 0x00 },
+    },
+    {   /* 8 */
+        { 0x00, 0xFC, 0xFE, 0xFE, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0xFE, 0xFE, 0xFC, 0x00 },
+        { 0x00, 0xFF, 0xFF, 0xFF, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xFF, 0xFF, 0xFF, 0x00 },
+        { 0x00, 0xFF, 0xFF, 0xFF, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0xFF, 0xFF, 0xFF, 0x00 },
+        { 0x00, 0x3F, 0x7F, 0x7F, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x7F, 0x7F, 0x3F, 0x00 },
+    },
+    {   /* 9 */
+        { 0x00, 0xFC, 0xFE, 0xFE, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0xFE, 0xFE, 0xFC, 0x00 },
+        { 0x00, 0xFF, 0xFF, 0xFF, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xFF, 0xFF, 0xFF, 0x00 },
+        { 0x00, 0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0xFF, 0xFF, 0xFF, 0x00 },
+        { 0x00, 0x00, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x7F, 0x7F, 0x3F, 0x00 },
+    },
+};
+
+/**
+ * Separator between hours, minutes and seconds
+ */
+static const uint8_t colonGlyph[GLYPH_BIGDIGIT_PAGES][GLYPH_COLON_WIDTH] PROGMEM = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x0E, 0x0E, 0x0E, 0x00, 0x00 },
+    { 0x00, 0x70, 0x70, 0x70, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+};
+
+// digits currently shown on the clock face
+static uint8_t clockDigits[GLYPH_CLOCK_DIGITS] = {
+    GLYPH_DIGIT_INVALID, GLYPH_DIGIT_INVALID, GLYPH_DIGIT_INVALID,
+    GLYPH_DIGIT_INVALID, GLYPH_DIGIT_INVALID, GLYPH_DIGIT_INVALID
+};
+
+/*FUNCTION DEFINITION ********************************************************/
+
+void glyph_blit(uint8_t x, uint8_t page, const uint8_t * glyph, uint8_t width, uint8_t pages) {
+
+    for(uint8_t pg = 0; pg < pages; pg++){
+
+        // clip pages below the display
+        if(page + pg >= GLYPH_DISPLAY_PAGES){
+            return;
+        }
+
+        uint8_t line = (page + pg) * GLYPH_LINES_PER_PAGE;
+        const uint8_t * column = glyph + pg * width;
+
+        for(uint8_t col = 0; col < width && x + col < GLYPH_DISPLAY_WIDTH; col++){
+
+            // one flash read per page byte, then the 8 pixel lines of the column
+            uint8_t bits = pgm_read_byte(column + col);
+
+            for(uint8_t bit = 0; bit < GLYPH_LINES_PER_PAGE; bit++){
+                display_setPixel(line + bit, x + col, bits & 0x01);
+                bits >>= 1;
+            }
+        }
+    }
+}
+
+void glyph_drawBigDigit(uint8_t x, uint8_t page, uint8_t digit) {
+
+    if(digit > 9){
+        return;
+    }
+
+    glyph_blit(x, page, &bigDigitFont[digit][0][0], GLYPH_BIGDIGIT_WIDTH, GLYPH_BIGDIGIT_PAGES);
+}
+
+bool glyph_drawClock(time_t time, bool redrawAll) {
+
+    bool changed = redrawAll;
+    uint8_t digits[GLYPH_CLOCK_DIGITS];
+
+    digits[0] = time.hour / 10;
+    digits[1] = time.hour % 10;
+    digits[2] = time.minute / 10;
+    digits[3] = time.minute % 10;
+    digits[4] = time.second / 10;
+    digits[5] = time.second % 10;
+
+    uint8_t x = GLYPH_CLOCK_X;
+
+    for(uint8_t i = 0; i < GLYPH_CLOCK_DIGITS; i++){
+
+        // redraw only the digits which changed since the last call
+        if(redrawAll || digits[i] != clockDigits[i]){
+            glyph_drawBigDigit(x, GLYPH_CLOCK_PAGE, digits[i]);
+            clockDigits[i] = digits[i];
+            changed = true;
+        }
+        x += GLYPH_BIGDIGIT_WIDTH;
+
+        // separator after the hour and minute digits
+        if(i == 1 || i == 3){
+            if(redrawAll){
+                glyph_blit(x, GLYPH_CLOCK_PAGE, &colonGlyph[0][0], GLYPH_COLON_WIDTH, GLYPH_BIGDIGIT_PAGES);
+            }
+            x += GLYPH_COLON_WIDTH;
+        }
+    }
+
+    return changed;
+}
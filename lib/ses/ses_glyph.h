@@ -0,0 +1,64 @@
+#ifndef SES_GLYPH_H_
+#define SES_GLYPH_H_
+
+/*INCLUDES-------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "ses_scheduler.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+// display geometry: 128 columns, 8 pages of 8 pixel lines each
+#define GLYPH_DISPLAY_WIDTH     128
+#define GLYPH_DISPLAY_PAGES     8
+
+// large 7-segment style digit: 16 columns x 4 pages (32 pixel lines)
+#define GLYPH_BIGDIGIT_WIDTH    16
+#define GLYPH_BIGDIGIT_PAGES    4
+
+// separator between the large digits
+#define GLYPH_COLON_WIDTH       6
+
+// first page of the large clock face (pages 3-6)
+#define GLYPH_CLOCK_PAGE        3
+
+
+/*PROTOTYPES-----------------------------------------------------------------*/
+
+/**
+ * Copies a column packed bitmap from flash into the display buffer.
+ * Every byte holds one column of one page, bit 0 is the top pixel line of the
+ * page. The bytes are stored page by page, each page left to right.
+ * Columns and pages outside of the display are clipped.
+ *
+ * @param x		horizontal position of the left glyph column
+ * @param page	page (row of 8 pixel lines) of the top glyph byte
+ * @param glyph	pointer to the bitmap in flash (PROGMEM)
+ * @param width	number of columns of the bitmap
+ * @param pages	number of pages of the bitmap
+ */
+void glyph_blit(uint8_t x, uint8_t page, const uint8_t * glyph, uint8_t width, uint8_t pages);
+
+/**
+ * Draws one large 7-segment style digit.
+ *
+ * @param x		horizontal position of the left digit column
+ * @param page	page of the top digit byte
+ * @param digit	digit to draw (0-9), other values are ignored
+ */
+void glyph_drawBigDigit(uint8_t x, uint8_t page, uint8_t digit);
+
+/**
+ * Draws the time as hh:mm:ss with large digits on the clock face. Only the
+ * digits which differ from the previous call are copied into the display
+ * buffer, so a call once per second usually touches a single digit.
+ *
+ * @param time		time to show
+ * @param redrawAll	true to draw all digits and separators (e.g. after
+ * 					display_clear), false to draw only the changed digits
+ *
+ * @return			true if anything was drawn and the display needs an update
+ */
+bool glyph_drawClock(time_t time, bool redrawAll);
+
+#endif /* SES_GLYPH_H_ */
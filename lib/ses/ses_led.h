@@ -1,66 +1,149 @@
 #ifndef SES_LED_H_
 #define SES_LED_H_
 
-/* FUNCTION PROTOTYPES *******************************************************/
+/* INCLUDES ******************************************************************/
+
+#include <inttypes.h>
+#include "ses_board.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+/* LEDs of the SES board, names of the board table in ses_board.h; all
+LEDs are on when their output is low */
+#define LED_PINS(X)     X(LED_RED) X(LED_GREEN) X(LED_YELLOW)
+
+/** LEDs of the SES board, as used by led_write */
+enum led_ids {
+#define LED_ID(led)     led,
+    LED_PINS(LED_ID)
+#undef LED_ID
+    LED_COUNT
+};
+
+/* mask of an LED for led_write */
+#define LED_MASK(led)   (1 << (led))
+
+/* FUNCTION DEFINITION *******************************************************/
+
+/*
+ * The LED functions are inline and resolve to single sbi/cbi instructions,
+ * led_redInit() to two.
+ */
 
 /**
  * initializes red led
  */
-void led_redInit(void);
+static inline void led_redInit(void) {
+    pin_LED_RED_high();
+    pin_LED_RED_output();
+}
 
 /**
  * toggles red led
  */
-void led_redToggle(void);
+static inline void led_redToggle(void) {
+    pin_LED_RED_toggle();
+}
 
 /**
  * enables red led
  */
-void led_redOn(void);
+static inline void led_redOn(void) {
+    pin_LED_RED_low();
+}
 
 /**
  * disables red led
  */
-void led_redOff(void);
+static inline void led_redOff(void) {
+    pin_LED_RED_high();
+}
 
 /**
  * initializes green led
  */
-void led_greenInit(void);
+static inline void led_greenInit(void) {
+    pin_LED_GREEN_high();
+    pin_LED_GREEN_output();
+}
 
 /**
  * toggles green led
  */
-void led_greenToggle(void);
+static inline void led_greenToggle(void) {
+    pin_LED_GREEN_toggle();
+}
 
 /**
  * enables green led
  */
-void led_greenOn(void);
+static inline void led_greenOn(void) {
+    pin_LED_GREEN_low();
+}
 
 /**
  * disables green led
  */
-void led_greenOff(void);
+static inline void led_greenOff(void) {
+    pin_LED_GREEN_high();
+}
 
 /**
  * initializes yellow led
  */
-void led_yellowInit(void);
+static inline void led_yellowInit(void) {
+    pin_LED_YELLOW_high();
+    pin_LED_YELLOW_output();
+}
 
 /**
  * toggles yellow led
  */
-void led_yellowToggle(void);
+static inline void led_yellowToggle(void) {
+    pin_LED_YELLOW_toggle();
+}
 
 /**
  * enables yellow led
  */
-void led_yellowOn(void);
+static inline void led_yellowOn(void) {
+    pin_LED_YELLOW_low();
+}
 
 /**
  * disables yellow led
  */
-void led_yellowOff(void);
+static inline void led_yellowOff(void) {
+    pin_LED_YELLOW_high();
+}
+
+/**
+ * Switches several LEDs with one write per port. The port bits of the
+ * LEDs are folded at compile time, LEDs on the same port change together.
+ *
+ * @param leds  LEDs to change, LED_MASK of each
+ * @param on    LEDs to switch on, all other LEDs of leds are switched off
+ */
+static inline void led_write(uint8_t leds, uint8_t on) {
+#define LED_PORT_BITS(led)                                                  \
+    if(PIN_##led##_PORT == port && (leds & LED_MASK(led))){                 \
+        mask |= PIN_##led##_MASK;                                           \
+        if(on & LED_MASK(led)){                                             \
+            low |= PIN_##led##_MASK;                                        \
+        }                                                                   \
+    }
+#define LED_PORT_WRITE(portName)                                            \
+    {                                                                       \
+        const uint8_t port = BOARD_PORT_##portName;                         \
+        uint8_t mask = 0, low = 0;                                          \
+        LED_PINS(LED_PORT_BITS)                                             \
+        if(mask != 0){                                                      \
+            port_##portName##_write(mask, (uint8_t)~low);                   \
+        }                                                                   \
+    }
+    BOARD_PORTS(LED_PORT_WRITE)
+#undef LED_PORT_WRITE
+#undef LED_PORT_BITS
+}
 
 #endif /* SES_LED_H_ */
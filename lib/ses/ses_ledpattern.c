@@ -0,0 +1,189 @@
+/* INCLUDES ******************************************************************/
+#include <stdlib.h>
+#include <avr/pgmspace.h>
+
+#include "ses_ledpattern.h"
+#include "ses_scheduler.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+// fractional bits of the brightness while ramping
+#define LEDPATTERN_FRACTION     8
+
+/* TYPES *********************************************************************/
+
+/**
+ * Playback state of one LED
+ */
+typedef struct {
+    const ledpattern_step_t * pattern;  ///< pattern in flash, NULL when it ended or stopped
+    uint8_t index;                      ///< current step
+    uint8_t target;                     ///< level at the end of the current step
+    uint16_t remaining;                 ///< ms until the next step
+    uint16_t level;                     ///< brightness with LEDPATTERN_FRACTION fractional bits
+    int16_t slope;                      ///< brightness change per tick of a ramp
+    bool driven;                        ///< the LED is written by the pattern task
+    uint8_t syncSeconds;                ///< restart on the seconds divisible by it, 0 runs freely
+} ledpattern_player_t;
+
+/* PATTERNS ******************************************************************/
+
+const ledpattern_step_t ledpattern_blinkFast[] PROGMEM = {
+    LED_STEP(LEDPATTERN_LEVEL_MAX, 125), LED_STEP(0, 125), LED_LOOP
+};
+
+const ledpattern_step_t ledpattern_blinkSeconds[] PROGMEM = {
+    LED_STEP(LEDPATTERN_LEVEL_MAX, 1000), LED_STEP(0, 1000), LED_LOOP
+};
+
+const ledpattern_step_t ledpattern_breathe[] PROGMEM = {
+    LED_RAMP(LEDPATTERN_LEVEL_MAX, 1000), LED_RAMP(0, 1000), LED_LOOP
+};
+
+/* PRIVATE VARIABLES *********************************************************/
+
+static ledpattern_player_t players[LED_COUNT];
+
+// software PWM position, shared by all LEDs
+static uint8_t pwmPhase = 0;
+
+static task_descriptor_t patternTask;
+static bool taskRunning = false;
+
+// second of the system clock at the previous tick
+static uint8_t lastSecond;
+
+/*FUNCTION DEFINITION ********************************************************/
+
+// starts the step at player->index, follows LED_LOOP and stops at LED_END
+static void ledpattern_loadStep(ledpattern_player_t * player) {
+    ledpattern_step_t step;
+
+    memcpy_P(&step, &player->pattern[player->index], sizeof(step));
+
+    if(step.flags & LEDPATTERN_LOOP){
+        // a pattern consisting of LED_LOOP only would never advance
+        if(player->index == 0){
+            player->pattern = NULL;
+            return;
+        }
+        player->index = 0;
+        memcpy_P(&step, &player->pattern[0], sizeof(step));
+    }
+
+    if(step.flags & LEDPATTERN_END){
+        player->pattern = NULL;
+        return;
+    }
+
+    player->target    = (step.level > LEDPATTERN_LEVEL_MAX) ? LEDPATTERN_LEVEL_MAX : step.level;
+    player->remaining = (step.duration != 0) ? step.duration : 1;
+
+    if(step.flags & LEDPATTERN_RAMP){
+        // the only division of a step, the ticks only add the slope
+        int16_t delta = ((int16_t)player->target << LEDPATTERN_FRACTION) - (int16_t)player->level;
+        player->slope = delta / (int16_t)player->remaining;
+    }
+    else{
+        player->level = (uint16_t)player->target << LEDPATTERN_FRACTION;
+        player->slope = 0;
+    }
+}
+
+static void ledpattern_task(void * param) {
+    uint8_t leds = 0, on = 0;
+    bool driving = false;
+    uint8_t second = scheduler_getClock().second;
+    bool secondChanged = (second != lastSecond);
+
+    lastSecond = second;
+    pwmPhase = (pwmPhase + 1 < LEDPATTERN_LEVEL_MAX) ? pwmPhase + 1 : 0;
+
+    for(uint8_t led = 0; led < LED_COUNT; led++){
+        ledpattern_player_t * player = &players[led];
+
+        if(!player->driven){
+            continue;
+        }
+
+        // a synchronized pattern restarts on the second boundary, also after the clock was set
+        if(player->pattern != NULL && player->syncSeconds != 0 && secondChanged && second % player->syncSeconds == 0){
+            player->index = 0;
+            ledpattern_loadStep(player);
+        }
+        else if(player->pattern != NULL){
+            player->level += player->slope;
+
+            if(--player->remaining == 0){
+                player->level = (uint16_t)player->target << LEDPATTERN_FRACTION;
+                player->index++;
+                ledpattern_loadStep(player);
+            }
+        }
+
+        uint8_t brightness = (player->level + (1 << (LEDPATTERN_FRACTION - 1))) >> LEDPATTERN_FRACTION;
+
+        leds |= LED_MASK(led);
+        if(pwmPhase < brightness){
+            on |= LED_MASK(led);
+        }
+
+        // an ended pattern only needs the task for a dimmed level
+        if(player->pattern == NULL && (brightness == 0 || brightness >= LEDPATTERN_LEVEL_MAX)){
+            player->driven = false;
+        }
+        else{
+            driving = true;
+        }
+    }
+
+    // all changes of this tick at once, one write per port
+    led_write(leds, on);
+
+    if(!driving){
+        scheduler_remove(&patternTask);
+        taskRunning = false;
+    }
+}
+
+void ledpattern_play(uint8_t led, const ledpattern_step_t * pattern) {
+    ledpattern_playSynced(led, pattern, 0);
+}
+
+void ledpattern_playSynced(uint8_t led, const ledpattern_step_t * pattern, uint8_t seconds) {
+    if(led >= LED_COUNT || pattern == NULL){
+        return;
+    }
+
+    ledpattern_player_t * player = &players[led];
+
+    // a ramp at the start fades from the current level
+    player->pattern     = pattern;
+    player->index       = 0;
+    player->driven      = true;
+    player->syncSeconds = seconds;
+    ledpattern_loadStep(player);
+
+    if(!taskRunning){
+        patternTask.task   = ledpattern_task;
+        patternTask.param  = NULL;
+        patternTask.expire = LEDPATTERN_TICK_MS;
+        patternTask.period = LEDPATTERN_TICK_MS;
+        taskRunning = scheduler_add(&patternTask);
+    }
+}
+
+void ledpattern_stop(uint8_t led) {
+    if(led >= LED_COUNT){
+        return;
+    }
+
+    players[led].pattern = NULL;
+    players[led].driven  = false;
+    players[led].level   = 0;
+    led_write(LED_MASK(led), 0);
+}
+
+bool ledpattern_isPlaying(uint8_t led) {
+    return led < LED_COUNT && players[led].pattern != NULL;
+}
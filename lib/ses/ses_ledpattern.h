@@ -0,0 +1,99 @@
+#ifndef SES_LEDPATTERN_H_
+#define SES_LEDPATTERN_H_
+
+/* INCLUDES ******************************************************************/
+
+#include <stdbool.h>
+#include <inttypes.h>
+#include <avr/pgmspace.h>
+#include "ses_led.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+/* period of the pattern task; one software PWM step per tick */
+#define LEDPATTERN_TICK_MS          1
+
+/* brightness levels, LEDPATTERN_LEVEL_MAX is fully on; PWM period is
+LEDPATTERN_LEVEL_MAX ticks, 125Hz */
+#define LEDPATTERN_LEVEL_MAX        8
+
+/* step flags */
+#define LEDPATTERN_RAMP             0x01    /* change linearly from the previous level */
+#define LEDPATTERN_LOOP             0x02    /* end of pattern, restart at the first step */
+#define LEDPATTERN_END              0x04    /* end of pattern, the LED keeps the last level */
+
+/*
+ * A pattern is an array of steps in flash, terminated by LED_LOOP or
+ * LED_END, e.g. a blinker:
+ *   static const ledpattern_step_t blink[] PROGMEM = {
+ *       LED_STEP(LEDPATTERN_LEVEL_MAX, 125), LED_STEP(0, 125), LED_LOOP
+ *   };
+ */
+#define LED_STEP(level, ms)         { (ms), (level), 0 }
+#define LED_RAMP(level, ms)         { (ms), (level), LEDPATTERN_RAMP }
+#define LED_LOOP                    { 0, 0, LEDPATTERN_LOOP }
+#define LED_END                     { 0, 0, LEDPATTERN_END }
+
+/* TYPES *********************************************************************/
+
+/**
+ * One step of a pattern
+ */
+typedef struct {
+    uint16_t duration;  ///< ms the step lasts
+    uint8_t level;      ///< brightness 0 ... LEDPATTERN_LEVEL_MAX, reached at the end of a ramp
+    uint8_t flags;      ///< LEDPATTERN_*
+} ledpattern_step_t;
+
+/* PATTERNS ******************************************************************/
+
+/** 4Hz blinking */
+extern const ledpattern_step_t ledpattern_blinkFast[] PROGMEM;
+
+/** 0.5Hz blinking, one second on, one second off */
+extern const ledpattern_step_t ledpattern_blinkSeconds[] PROGMEM;
+
+/** fading in and out within 2s */
+extern const ledpattern_step_t ledpattern_breathe[] PROGMEM;
+
+/* FUNCTION PROTOTYPES *******************************************************/
+
+/**
+ * Plays a pattern on an LED, replacing the pattern the LED played before.
+ * The shared pattern task is added to the scheduler while any pattern plays.
+ *
+ * @param led      element of led_ids
+ * @param pattern  steps in flash, terminated by LED_LOOP or LED_END
+ */
+void ledpattern_play(uint8_t led, const ledpattern_step_t * pattern);
+
+/**
+ * Plays a pattern like ledpattern_play, in step with the system clock: the
+ * pattern restarts at its first step whenever the second of the clock
+ * becomes divisible by seconds, e.g. ledpattern_blinkSeconds with 2 is on in
+ * the even seconds. Drift of the step durations and setting the clock are
+ * corrected at the next such second.
+ *
+ * @param led      element of led_ids
+ * @param pattern  steps in flash, terminated by LED_LOOP
+ * @param seconds  period of the pattern in seconds, 0 plays it freely
+ */
+void ledpattern_playSynced(uint8_t led, const ledpattern_step_t * pattern, uint8_t seconds);
+
+/**
+ * Stops the pattern of an LED and switches the LED off.
+ *
+ * @param led  element of led_ids
+ */
+void ledpattern_stop(uint8_t led);
+
+/**
+ * Check whether an LED plays a pattern.
+ *
+ * @param led  element of led_ids
+ *
+ * @return     false, if the LED has no pattern or its pattern ended
+ */
+bool ledpattern_isPlaying(uint8_t led);
+
+#endif /* SES_LEDPATTERN_H_ */
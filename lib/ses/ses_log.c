@@ -0,0 +1,122 @@
+/* INCLUDES ******************************************************************/
+#include <stdlib.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+
+#include "ses_log.h"
+#include "ses_frame.h"
+#include "ses_ringbuffer.h"
+#include "ses_scheduler.h"
+#include "ses_usbserial.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+// record layout: ID, timestamp (2 bytes), arguments (2 bytes each)
+#define LOG_HEADER_SIZE         3
+#define LOG_MAX_RECORD_SIZE     (LOG_HEADER_SIZE + 2 * 2)
+
+/* PRIVATE VARIABLES *********************************************************/
+
+/**
+ * Number of arguments per message ID, generated from ses_log_ids.def
+ */
+static const uint8_t logArgCount[LOG_ID_COUNT] PROGMEM = {
+#define LOG_MSG(name, args, format) args,
+#include "ses_log_ids.def"
+#undef LOG_MSG
+};
+
+static uint8_t logStorage[LOG_BUFFER_SIZE];
+
+// statically initialized, so messages can be recorded before any init call
+static ringbuffer_t logBuffer = { logStorage, LOG_BUFFER_SIZE - 1, 0, 0 };
+
+// records dropped because the buffer was full
+static uint16_t dropped = 0;
+
+/*FUNCTION DEFINITION ********************************************************/
+
+static void log_store(uint8_t * record, uint8_t len) {
+
+    // tasks and interrupts may log concurrently
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        uint16_t now = (uint16_t)scheduler_getTime();
+
+        record[1] = (uint8_t)now;
+        record[2] = (uint8_t)(now >> 8);
+
+        if(!ringbuffer_write(&logBuffer, record, len)){
+            dropped++;
+        }
+    }
+}
+
+static void log_flushTask(void * param) {
+    log_flush();
+}
+
+void log_record0(uint8_t id) {
+    uint8_t record[LOG_HEADER_SIZE] = { id };
+
+    log_store(record, sizeof(record));
+}
+
+void log_record1(uint8_t id, uint16_t arg0) {
+    uint8_t record[LOG_HEADER_SIZE + 2] = { id, 0, 0, (uint8_t)arg0, (uint8_t)(arg0 >> 8) };
+
+    log_store(record, sizeof(record));
+}
+
+void log_record2(uint8_t id, uint16_t arg0, uint16_t arg1) {
+    uint8_t record[LOG_HEADER_SIZE + 4] = { id, 0, 0, (uint8_t)arg0, (uint8_t)(arg0 >> 8), (uint8_t)arg1, (uint8_t)(arg1 >> 8) };
+
+    log_store(record, sizeof(record));
+}
+
+void log_flush(void) {
+    uint8_t payload[FRAME_MAX_PAYLOAD];
+    uint8_t frame[FRAME_ENCODED_SIZE(FRAME_MAX_PAYLOAD)];
+
+    // report dropped records once there is room for the report
+    if(dropped != 0 && ringbuffer_free(&logBuffer) >= LOG_MAX_RECORD_SIZE){
+        uint16_t count;
+
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+            count = dropped;
+            dropped = 0;
+        }
+        log_record1(LOG_ID_RECORDS_DROPPED, count);
+    }
+
+    // records stay in the buffer while the USB TX buffer is full
+    while(ringbuffer_count(&logBuffer) > 0 && usbserial_txFree() >= sizeof(frame)){
+        uint8_t len = 0;
+
+        payload[len++] = LOG_FRAME_TYPE;
+
+        // only whole records per frame; a record is always written completely
+        while(len + LOG_MAX_RECORD_SIZE <= FRAME_MAX_PAYLOAD && ringbuffer_get(&logBuffer, &payload[len])){
+            uint8_t id = payload[len++];
+            uint8_t recordLen = LOG_HEADER_SIZE - 1 + 2 * pgm_read_byte(&logArgCount[id]);
+
+            for(uint8_t i = 0; i < recordLen; i++){
+                ringbuffer_get(&logBuffer, &payload[len++]);
+            }
+        }
+
+        len = frame_encode(payload, len, frame);
+        usbserial_write(frame, len);
+    }
+}
+
+void log_startTask(uint16_t period) {
+    static task_descriptor_t flushTask;
+
+    scheduler_remove(&flushTask);
+    flushTask.task   = log_flushTask;
+    flushTask.param  = NULL;
+    flushTask.expire = period;
+    flushTask.period = period;
+    flushTask.autoPhase = true;
+    scheduler_add(&flushTask);
+}
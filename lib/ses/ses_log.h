@@ -0,0 +1,77 @@
+#ifndef SES_LOG_H_
+#define SES_LOG_H_
+
+/* INCLUDES ******************************************************************/
+#include <stdint.h>
+
+/* DEFINES & MACROS **********************************************************/
+
+// set to 0 to remove all log calls from the build
+#ifndef LOG_ENABLE
+#define LOG_ENABLE              1
+#endif
+
+// size of the record buffer (power of two, at most 128)
+#define LOG_BUFFER_SIZE         128
+
+// first payload byte of a frame carrying log records
+#define LOG_FRAME_TYPE          0xC0
+
+/* TYPES *********************************************************************/
+
+/**
+ * IDs of the log messages, generated from ses_log_ids.def
+ */
+enum log_ids {
+#define LOG_MSG(name, args, format) LOG_ID_##name,
+#include "ses_log_ids.def"
+#undef LOG_MSG
+    LOG_ID_COUNT
+};
+
+
+/* FUNCTION PROTOTYPES *******************************************************/
+
+/**
+ * Records a message without arguments. Only the ID and a 16 bit timestamp in
+ * ms are stored, formatting happens on the host. May be called from
+ * interrupts; the record is dropped if the buffer is full.
+ *
+ * @param id	message ID
+ */
+void log_record0(uint8_t id);
+
+/**
+ * Records a message with one 16 bit argument, see log_record0.
+ */
+void log_record1(uint8_t id, uint16_t arg0);
+
+/**
+ * Records a message with two 16 bit arguments, see log_record0.
+ */
+void log_record2(uint8_t id, uint16_t arg0, uint16_t arg1);
+
+/**
+ * Moves the buffered records in frames of ses_frame into the TX buffer of
+ * the USB serial connection, as far as it has space. Call from task context.
+ */
+void log_flush(void);
+
+/**
+ * Runs log_flush as a periodic scheduler task.
+ *
+ * @param period	flush period in ms
+ */
+void log_startTask(uint16_t period);
+
+#if LOG_ENABLE
+#define LOG0(name)              log_record0(LOG_ID_##name)
+#define LOG1(name, a)           log_record1(LOG_ID_##name, (uint16_t)(a))
+#define LOG2(name, a, b)        log_record2(LOG_ID_##name, (uint16_t)(a), (uint16_t)(b))
+#else
+#define LOG0(name)              ((void)0)
+#define LOG1(name, a)           ((void)0)
+#define LOG2(name, a, b)        ((void)0)
+#endif
+
+#endif /* SES_LOG_H_ */
@@ -0,0 +1,82 @@
+/* INCLUDES ******************************************************************/
+#include <stdlib.h>
+
+#include "ses_ringbuffer.h"
+
+/*FUNCTION DEFINITION ********************************************************/
+
+void ringbuffer_init(ringbuffer_t * rb, uint8_t * buffer, uint8_t size) {
+    rb->buffer = buffer;
+    rb->mask   = size - 1;
+    rb->head   = 0;
+    rb->tail   = 0;
+}
+
+uint8_t ringbuffer_count(const ringbuffer_t * rb) {
+    // free running indices: the difference is the fill level, also across the 8 bit overflow
+    return (uint8_t)(rb->head - rb->tail);
+}
+
+uint8_t ringbuffer_free(const ringbuffer_t * rb) {
+    return (uint8_t)(rb->mask + 1 - ringbuffer_count(rb));
+}
+
+bool ringbuffer_put(ringbuffer_t * rb, uint8_t data) {
+    uint8_t head = rb->head;
+
+    if((uint8_t)(head - rb->tail) > rb->mask){
+        return false;
+    }
+
+    rb->buffer[head & rb->mask] = data;
+    // publish the byte only after it was stored
+    rb->head = head + 1;
+
+    return true;
+}
+
+bool ringbuffer_write(ringbuffer_t * rb, const uint8_t * data, uint8_t len) {
+    uint8_t head = rb->head;
+
+    if(len > ringbuffer_free(rb)){
+        return false;
+    }
+
+    for(uint8_t i = 0; i < len; i++){
+        rb->buffer[(uint8_t)(head + i) & rb->mask] = data[i];
+    }
+    // publish the whole block at once
+    rb->head = head + len;
+
+    return true;
+}
+
+bool ringbuffer_get(ringbuffer_t * rb, uint8_t * data) {
+    uint8_t tail = rb->tail;
+
+    if(tail == rb->head){
+        return false;
+    }
+
+    *data = rb->buffer[tail & rb->mask];
+    rb->tail = tail + 1;
+
+    return true;
+}
+
+uint8_t ringbuffer_peekContiguous(const ringbuffer_t * rb, const uint8_t ** data) {
+    uint8_t start = rb->tail & rb->mask;
+    uint8_t count = ringbuffer_count(rb);
+    // bytes up to the end of the storage, the rest wrapped to its beginning
+    uint8_t toEnd = rb->mask + 1 - start;
+
+    *data = &rb->buffer[start];
+
+    return (count < toEnd) ? count : toEnd;
+}
+
+void ringbuffer_skip(ringbuffer_t * rb, uint8_t len) {
+    uint8_t count = ringbuffer_count(rb);
+
+    rb->tail += (len < count) ? len : count;
+}
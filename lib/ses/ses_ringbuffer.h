@@ -0,0 +1,86 @@
+#ifndef SES_RINGBUFFER_H_
+#define SES_RINGBUFFER_H_
+
+/* INCLUDES ******************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+/* TYPES *********************************************************************/
+
+/**
+ * Byte ring buffer for one producer and one consumer, e.g. an ISR and a task.
+ * head and tail are free running 8 bit indices which are masked on access,
+ * so the size must be a power of two and at most 128 bytes. Since 8 bit
+ * accesses are atomic on the AVR, no locking is needed as long as only the
+ * producer moves head and only the consumer moves tail.
+ */
+typedef struct {
+    uint8_t * buffer;       ///< storage of the buffer
+    uint8_t mask;           ///< size - 1
+    volatile uint8_t head;  ///< write index, only changed by the producer
+    volatile uint8_t tail;  ///< read index, only changed by the consumer
+} ringbuffer_t;
+
+
+/* FUNCTION PROTOTYPES *******************************************************/
+
+/**
+ * Initializes an empty ring buffer.
+ *
+ * @param rb		pointer to the ring buffer
+ * @param buffer	storage for the buffer
+ * @param size		size of the storage; power of two, at most 128
+ */
+void ringbuffer_init(ringbuffer_t * rb, uint8_t * buffer, uint8_t size);
+
+/**
+ * Gets the number of bytes stored in the buffer.
+ */
+uint8_t ringbuffer_count(const ringbuffer_t * rb);
+
+/**
+ * Gets the number of bytes which can be written to the buffer.
+ */
+uint8_t ringbuffer_free(const ringbuffer_t * rb);
+
+/**
+ * Appends one byte to the buffer.
+ *
+ * @return	false, if the buffer is full and the byte was dropped
+ */
+bool ringbuffer_put(ringbuffer_t * rb, uint8_t data);
+
+/**
+ * Appends a block of bytes to the buffer. The block is written completely or
+ * not at all, so a reader never sees a truncated record.
+ *
+ * @return	false, if there is not enough space and nothing was written
+ */
+bool ringbuffer_write(ringbuffer_t * rb, const uint8_t * data, uint8_t len);
+
+/**
+ * Removes the oldest byte from the buffer.
+ *
+ * @param data	pointer to store the byte at
+ *
+ * @return		false, if the buffer is empty
+ */
+bool ringbuffer_get(ringbuffer_t * rb, uint8_t * data);
+
+/**
+ * Gets the oldest stored bytes which are contiguous in memory, so they can be
+ * handed to a block transfer without copying. The bytes stay in the buffer
+ * until they are released by ringbuffer_skip.
+ *
+ * @param data	pointer to store the address of the first byte at
+ *
+ * @return		number of contiguous bytes starting at *data
+ */
+uint8_t ringbuffer_peekContiguous(const ringbuffer_t * rb, const uint8_t ** data);
+
+/**
+ * Releases the oldest len bytes of the buffer.
+ */
+void ringbuffer_skip(ringbuffer_t * rb, uint8_t len);
+
+#endif /* SES_RINGBUFFER_H_ */
@@ -0,0 +1,132 @@
+/* INCLUDES ******************************************************************/
+#include <stdlib.h>
+#include <avr/io.h>
+#include <util/atomic.h>
+
+#include "ses_board.h"
+#include "ses_rotary.h"
+#include "ses_scheduler.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+/*
+ * States of the decoder. Input of a transition is (B << 1) | A, both
+ * inputs are high in a detent. Clockwise B falls first:
+ * 11 -> 01 -> 00 -> 10 -> 11, counter-clockwise A falls first.
+ */
+#define ROTARY_START        0x0
+#define ROTARY_CW_FINAL     0x1
+#define ROTARY_CW_BEGIN     0x2
+#define ROTARY_CW_NEXT      0x3
+#define ROTARY_CCW_BEGIN    0x4
+#define ROTARY_CCW_FINAL    0x5
+#define ROTARY_CCW_NEXT     0x6
+
+// flags of a completed detent in the next state
+#define ROTARY_STATE_MASK   0x0F
+#define ROTARY_DIR_CW       0x10
+#define ROTARY_DIR_CCW      0x20
+
+/* PRIVATE VARIABLES *********************************************************/
+
+/* next state for every state and input; bouncing between two neighbouring
+inputs moves back and forth without completing the sequence */
+static const uint8_t transitions[7][4] = {
+    [ROTARY_START]     = { ROTARY_START,     ROTARY_CW_BEGIN,  ROTARY_CCW_BEGIN, ROTARY_START },
+    [ROTARY_CW_FINAL]  = { ROTARY_CW_NEXT,   ROTARY_START,     ROTARY_CW_FINAL,  ROTARY_START | ROTARY_DIR_CW },
+    [ROTARY_CW_BEGIN]  = { ROTARY_CW_NEXT,   ROTARY_CW_BEGIN,  ROTARY_START,     ROTARY_START },
+    [ROTARY_CW_NEXT]   = { ROTARY_CW_NEXT,   ROTARY_CW_BEGIN,  ROTARY_CW_FINAL,  ROTARY_START },
+    [ROTARY_CCW_BEGIN] = { ROTARY_CCW_NEXT,  ROTARY_START,     ROTARY_CCW_BEGIN, ROTARY_START },
+    [ROTARY_CCW_FINAL] = { ROTARY_CCW_NEXT,  ROTARY_CCW_FINAL, ROTARY_START,     ROTARY_START | ROTARY_DIR_CCW },
+    [ROTARY_CCW_NEXT]  = { ROTARY_CCW_NEXT,  ROTARY_CCW_FINAL, ROTARY_CCW_BEGIN, ROTARY_START },
+};
+
+static uint8_t state = ROTARY_START;
+
+// written by the interrupt, 16 bit reads must be atomic
+static volatile int16_t position = 0;
+static volatile int16_t steps = 0;
+
+// low 16 bits of the system time at the last detent
+static uint16_t lastDetent;
+
+static volatile pRotaryCallback rotaryCallback = NULL;
+
+/*FUNCTION DEFINITION ********************************************************/
+
+static int8_t rotary_accelerate(uint16_t interval) {
+    if(interval < ROTARY_ACCEL_FAST_MS){
+        return ROTARY_ACCEL_FAST_STEPS;
+    }
+    if(interval < ROTARY_ACCEL_MEDIUM_MS){
+        return ROTARY_ACCEL_MEDIUM_STEPS;
+    }
+    if(interval < ROTARY_ACCEL_SLOW_MS){
+        return ROTARY_ACCEL_SLOW_STEPS;
+    }
+    return 1;
+}
+
+void rotary_init(void) {
+    // inputs with internal pull-up resistors
+    // both channels pull to GND, the board table places them on port B (PCINT0)
+    pin_ROTARY_A_input();
+    pin_ROTARY_A_high();
+    pin_ROTARY_B_input();
+    pin_ROTARY_B_high();
+
+    // pin change interrupt of both channels
+    PCMSK0 |= PIN_ROTARY_A_MASK | PIN_ROTARY_B_MASK;
+    PCICR  |= (1 << PCIE0);
+}
+
+void rotary_update(uint8_t pins) {
+    uint8_t input = (((pins >> PIN_ROTARY_B_BIT) & 1) << 1) | ((pins >> PIN_ROTARY_A_BIT) & 1);
+
+    state = transitions[state & ROTARY_STATE_MASK][input];
+
+    if((state & (ROTARY_DIR_CW | ROTARY_DIR_CCW)) == 0){
+        return;
+    }
+
+    // the interrupt reads the time without a race
+    uint16_t now = (uint16_t)scheduler_getTime();
+    int8_t increment = rotary_accelerate(now - lastDetent);
+    lastDetent = now;
+
+    if(state & ROTARY_DIR_CW){
+        position++;
+    }
+    else{
+        position--;
+        increment = -increment;
+    }
+    steps += increment;
+
+    if(rotaryCallback != NULL){
+        rotaryCallback(increment);
+    }
+}
+
+void rotary_setCallback(pRotaryCallback callback) {
+    rotaryCallback = callback;
+}
+
+int16_t rotary_getPosition(void) {
+    int16_t current;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        current = position;
+    }
+    return current;
+}
+
+int16_t rotary_takeSteps(void) {
+    int16_t taken;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        taken = steps;
+        steps = 0;
+    }
+    return taken;
+}
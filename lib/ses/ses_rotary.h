@@ -0,0 +1,72 @@
+#ifndef SES_ROTARY_H_
+#define SES_ROTARY_H_
+
+/* INCLUDES ******************************************************************/
+
+#include <stdbool.h>
+#include <inttypes.h>
+
+/* DEFINES & MACROS **********************************************************/
+
+/*
+ * Acceleration: the time between two detents selects the number of steps a
+ * detent is worth. Detents closer than ROTARY_ACCEL_FAST_MS count
+ * ROTARY_ACCEL_FAST_STEPS and so on, slower ones count one step.
+ */
+#define ROTARY_ACCEL_FAST_MS        15
+#define ROTARY_ACCEL_FAST_STEPS     10
+#define ROTARY_ACCEL_MEDIUM_MS      40
+#define ROTARY_ACCEL_MEDIUM_STEPS   5
+#define ROTARY_ACCEL_SLOW_MS        100
+#define ROTARY_ACCEL_SLOW_STEPS     2
+
+/* TYPES *********************************************************************/
+
+/**
+ * Type of function pointer for detents, called from the pin change interrupt
+ *
+ * @param steps  accelerated steps of the detent, clockwise positive
+ */
+typedef void (*pRotaryCallback)(int8_t steps);
+
+/* FUNCTION PROTOTYPES *******************************************************/
+
+/**
+ * Initializes the A and B inputs of the rotary encoder and enables their
+ * pin change interrupt. The interrupt of port B is shared with the buttons,
+ * its handler in ses_button.c forwards every pin change to rotary_update.
+ */
+void rotary_init(void);
+
+/**
+ * Decodes the encoder inputs, to be called on every pin change of port B.
+ * A table-driven state machine only counts a detent after the full
+ * quadrature sequence, so contact bounce cannot produce steps.
+ *
+ * @param pins  value of the PINB register
+ */
+void rotary_update(uint8_t pins);
+
+/**
+ * Sets the function called for every detent, the steps are counted for
+ * rotary_takeSteps as well.
+ *
+ * @param callback  the callback, NULL to disable it
+ */
+void rotary_setCallback(pRotaryCallback callback);
+
+/**
+ * Get the position of the encoder: one count per detent, clockwise positive.
+ *
+ * @return  the position, wraps around
+ */
+int16_t rotary_getPosition(void);
+
+/**
+ * Get the accelerated steps since the last call and reset them.
+ *
+ * @return  steps, clockwise positive
+ */
+int16_t rotary_takeSteps(void);
+
+#endif /* SES_ROTARY_H_ */
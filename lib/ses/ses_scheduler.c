@@ -1,10 +1,14 @@
 /*INCLUDES *******************************************************************/
 #include <stdlib.h>
+#include <avr/io.h>
+#include <avr/wdt.h>
+#include <avr/pgmspace.h>
 
 #include "ses_timer.h"
 #include "ses_scheduler.h"
 #include "util/atomic.h"
 #include "ses_led.h"
+#include "ses_log.h"
 
 /* MACROS *********************************************************/
 
@@ -14,6 +18,12 @@
 
 #define MILLISEC_PER_DAY    (uint32_t)(HOUR_PER_DAY * HOUR_2_MILLISEC)
 
+#define MILLISEC_2_MICROSEC         (uint16_t)1000  // 1ms = 1000us
+#define MICROSEC_PER_TIMER_COUNT    4               // timer0 runs with 16MHz / 64 = 250kHz
+
+// periodic tasks of the list considered when a release offset is chosen
+#define SCHEDULER_PHASE_TASKS       16
+
 /* PRIVATE VARIABLES *********************************************************/
 
 /**
@@ -22,12 +32,233 @@
  */
 static task_descriptor_t * taskList = NULL;
 
-static volatile system_time_t curr_sys_time = 0;
+/* the time survives a warm reset in RAM which the startup code does not
+clear, scheduler_restoreTime() keeps or zeroes it */
+#define SCHEDULER_NOINIT    __attribute__((section(".noinit")))
+
+static volatile system_time_t curr_sys_time SCHEDULER_NOINIT;
+
+// broken-down system time, only accessed in the tick and in atomic sections
+static time_t curr_clock SCHEDULER_NOINIT;
+static uint16_t curr_day SCHEDULER_NOINIT;
+static uint8_t clockChanges = 0;
+static pClockCallback clockCallback = NULL;
+
+static uint32_t executions = 0;
+static volatile uint16_t overruns = 0;
+static uint8_t peakReleases = 0;
+
+// ticks since start, unlike the system time it is never set
+static uint16_t ticks = 0;
+
+// the single deadline, counted down in the tick
+static task_descriptor_t * deadlineTask = NULL;
+static uint32_t deadlineRemaining = 0;
+
+#if SCHEDULER_MODE == SCHEDULER_CYCLIC
+// the frame table; the tick counts the started frames, scheduler_run the ones it ran
+static const scheduler_table_t * frameTable = NULL;
+static uint8_t frameTicks = 0;
+static volatile uint8_t framesStarted = 0;
+// ticks at the last pass of the list
+static uint16_t listTicks = 0;
+#endif
 
 /*FUNCTION DEFINITION *************************************************/
 
+// one ms of the system time and of the broken-down time
+static void scheduler_countTime(void) {
+
+    // system time update, 0 ... MILLISEC_PER_DAY - 1
+    curr_sys_time = (curr_sys_time + 1 >= MILLISEC_PER_DAY) ? 0 : curr_sys_time + 1;
+
+    // the broken-down time counts along, a carry only every 1000 ticks
+    if(++curr_clock.milli < SEC_2_MILLISEC){
+        return;
+    }
+    curr_clock.milli = 0;
+    clockChanges |= SCHEDULER_CLOCK_SECOND;
+
+    if(++curr_clock.second < SEC_PER_MIN){
+        return;
+    }
+    curr_clock.second = 0;
+    clockChanges |= SCHEDULER_CLOCK_MINUTE;
+
+    if(++curr_clock.minute < MIN_PER_HOUR){
+        return;
+    }
+    curr_clock.minute = 0;
+    clockChanges |= SCHEDULER_CLOCK_HOUR;
+
+    if(++curr_clock.hour >= HOUR_PER_DAY){
+        curr_clock.hour = 0;
+        curr_day++;
+        clockChanges |= SCHEDULER_CLOCK_DAY;
+    }
+}
+
+// calls the clock callback with the changes since the last call
+static void scheduler_notifyClock(void) {
+    uint8_t changed;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        changed = clockChanges;
+        clockChanges = 0;
+    }
+
+    if(changed != 0 && clockCallback != NULL){
+        clockCallback(changed);
+    }
+}
+
+static uint16_t scheduler_gcd(uint16_t a, uint16_t b) {
+    while(b != 0){
+        uint16_t r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+/* chooses the release offset 1 ... period of a new periodic task which shares
+release ticks with the fewest periodic tasks of the list, the earliest of equal
+ones; releases at offset + k * period and expire + m * p meet exactly if
+offset - expire is a multiple of gcd(period, p). The list is copied in an atomic
+section, the search runs with interrupts enabled and is relative to *start */
+static uint16_t scheduler_choosePhase(uint16_t period, uint16_t * start) {
+    uint16_t gcd[SCHEDULER_PHASE_TASKS];
+    uint16_t residue[SCHEDULER_PHASE_TASKS];
+    uint8_t count = 0;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        *start = ticks;
+        for(task_descriptor_t * taskListIterator = taskList;
+            taskListIterator != NULL && count < SCHEDULER_PHASE_TASKS;
+            taskListIterator = taskListIterator->next){
+            // one-shot tasks release only once
+            if(taskListIterator->period != 0){
+                gcd[count]     = taskListIterator->period;
+                residue[count] = taskListIterator->expire;
+                count++;
+            }
+        }
+    }
+
+    // residue[i] counts up to gcd[i] with the offset, the tasks meet at 0
+    for(uint8_t i = 0; i < count; i++){
+        gcd[i]     = scheduler_gcd(period, gcd[i]);
+        residue[i] = (gcd[i] - residue[i] % gcd[i] + 1) % gcd[i];
+    }
+
+    uint16_t best = period;
+    uint8_t bestCollisions = UINT8_MAX;
+
+    for(uint16_t offset = 1; offset <= period && bestCollisions != 0; offset++){
+        uint8_t collisions = 0;
+
+        for(uint8_t i = 0; i < count; i++){
+            if(residue[i] == 0){
+                collisions++;
+            }
+            if(++residue[i] == gcd[i]){
+                residue[i] = 0;
+            }
+        }
+
+        if(collisions < bestCollisions){
+            best = offset;
+            bestCollisions = collisions;
+        }
+    }
+
+    return best;
+}
+
+#if SCHEDULER_MODE == SCHEDULER_CYCLIC
+
+/* releases the tasks of the list after elapsed ms; in cyclic mode the pass of
+the list does it instead of the tick, releases it skipped count as overruns */
+static void scheduler_release(uint16_t elapsed) {
+    uint8_t released = 0;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+
+        // a due deadline task joins the list and is released in this pass
+        if(deadlineRemaining != 0){
+            if(deadlineRemaining <= elapsed){
+                deadlineRemaining = 0;
+                deadlineTask->expire = 0;
+                deadlineTask->period = 0;
+                scheduler_add(deadlineTask);
+            }
+            else{
+                deadlineRemaining -= elapsed;
+            }
+        }
+
+        for(task_descriptor_t * taskListIterator = taskList; taskListIterator != NULL; taskListIterator = taskListIterator->next){
+
+            if(taskListIterator->expire > elapsed){
+                taskListIterator->expire -= elapsed;
+                continue;
+            }
+
+            // a released one-shot task waits for its execution
+            if(taskListIterator->period == 0 && taskListIterator->execute){
+                continue;
+            }
+
+            // ms since the release, whole periods in it are skipped releases
+            uint16_t late = elapsed - taskListIterator->expire;
+            uint16_t missed = (taskListIterator->period != 0) ? late / taskListIterator->period : 0;
+
+            if(taskListIterator->execute){
+                missed++;
+            }
+            if(missed != 0){
+                overruns += missed;
+                LOG1(SCHED_OVERRUN, (uintptr_t)taskListIterator->task);
+            }
+            taskListIterator->execute = true;
+            if(taskListIterator->period != 0){
+                taskListIterator->expire = taskListIterator->period - late % taskListIterator->period;
+            }
+            released++;
+        }
+
+        if(released > peakReleases){
+            peakReleases = released;
+        }
+    }
+}
+
+// the tick only counts the time and starts the minor frames
 static void scheduler_update(void) {
 
+    ticks++;
+
+    // the next minor frame starts
+    if(frameTable != NULL && ++frameTicks == frameTable->frameMs){
+        frameTicks = 0;
+        framesStarted++;
+    }
+
+    scheduler_countTime();
+}
+
+#else
+
+static void scheduler_update(void) {
+    uint8_t released = 0;
+
+    // a due deadline task joins the list and is released in this tick
+    if(deadlineRemaining != 0 && --deadlineRemaining == 0){
+        deadlineTask->expire = 1;
+        deadlineTask->period = 0;
+        scheduler_add(deadlineTask);
+    }
+
     // Iterator pointer which points to the currently considered task
     task_descriptor_t * taskListIterator = taskList;
     
@@ -39,96 +270,211 @@ static void scheduler_update(void) {
         /* if expire reaches 0, the task must be executed 
         and the expire value must be reset */
         if(taskListIterator->expire == 0){
+            // the previous release was not executed yet
+            if(taskListIterator->execute){
+                overruns++;
+                LOG1(SCHED_OVERRUN, (uintptr_t)taskListIterator->task);
+            }
             taskListIterator->execute = true;
             taskListIterator->expire  = taskListIterator->period;
+            released++;
         }
         
         // Next iteration
         taskListIterator = taskListIterator->next;
     }
 
-    // system time update
-    curr_sys_time = (curr_sys_time >= MILLISEC_PER_DAY ) ? 0 : curr_sys_time + 1;
+    if(released > peakReleases){
+        peakReleases = released;
+    }
+    ticks++;
 
+    scheduler_countTime();
 }
 
+#endif
+
 void scheduler_init() {
 
     timer0_start();
     timer0_setCallback(scheduler_update);
 }
 
-void scheduler_run() {
+void scheduler_runList(void * param) {
+
+#if SCHEDULER_MODE == SCHEDULER_CYCLIC
+    uint16_t now;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        now = ticks;
+    }
+    if(now != listTicks){
+        scheduler_release(now - listTicks);
+        listTicks = now;
+    }
+#endif
 
     // Iterator pointer which points to the currently considered task
     task_descriptor_t * taskListIterator = taskList;
 
-    // Superloop
-    while(1){
-
-        // taskList iteration loop
-        while(taskListIterator != NULL){
+    // taskList iteration loop
+    while(taskListIterator != NULL){
+        
+        if(taskListIterator->execute){
+            /* If the considered task is candidate for execution
+            then the corresponding task function will be called*/
+            taskListIterator->task(taskListIterator->param);
             
-            if(taskListIterator->execute){
-                /* If the considered task is candidate for execution
-                then the corresponding task function will be called*/
-                taskListIterator->task(taskListIterator->param);
-                
-                taskListIterator->execute = false;
-
-                /* If the considered task must be performed only once (non-periodic task)
-                then it can be removed here from the taskList*/
+            taskListIterator->execute = false;
+            executions++;
+
+            /* If the considered task must be performed only once (non-periodic task)
+            then it can be removed here from the taskList; an interrupt may give it
+            a period again, so the check and the removal are one atomic step */
+            ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
                 if(taskListIterator->period == 0){
+                    LOG1(SCHED_ONESHOT_DONE, (uintptr_t)taskListIterator->task);
                     scheduler_remove(taskListIterator);
                 }
-
             }
 
-            // Next iteration
-            taskListIterator = taskListIterator->next;
         }
 
-        // taskListIterator "reset" to the first task element
-        taskListIterator = taskList;
-        
+        // Next iteration
+        taskListIterator = taskListIterator->next;
     }
 
+    // second, minute and hour notifications run like a task
+    scheduler_notifyClock();
 }
 
+#if SCHEDULER_MODE == SCHEDULER_CYCLIC
+
+void scheduler_setTable(const scheduler_table_t * table) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        frameTable    = table;
+        frameTicks    = 0;
+        framesStarted = 0;
+        listTicks     = ticks;
+    }
+}
+
+void scheduler_run() {
+    uint8_t framesRun = 0;
+    uint8_t frame = 0;
+
+    // Superloop
+    while(1){
+
+        // the tick starts the frames, nothing else runs in between
+        uint8_t started;
+        while((started = framesStarted) == framesRun){
+        }
+
+        // a frame which took too long delayed the next ones, they are skipped
+        uint8_t late = started - framesRun - 1;
+        if(late != 0){
+            overruns += late;
+            LOG2(SCHED_FRAME_LATE, frame, late);
+            frame = (frame + late) % frameTable->frames;
+        }
+        framesRun = started;
+
+        // the slots of the frame in the order of the table
+        uint8_t last = pgm_read_byte(&frameTable->first[frame + 1]);
+        for(uint8_t slot = pgm_read_byte(&frameTable->first[frame]); slot < last; slot++){
+            task_t task = (task_t)pgm_read_ptr(&frameTable->slots[slot].task);
+            uint16_t start = scheduler_getMicros();
+
+            task(pgm_read_ptr(&frameTable->slots[slot].param));
+            executions++;
+
+            // the table only holds if the slots keep their WCETs
+            uint16_t elapsed = scheduler_getMicros() - start;
+            if(elapsed > pgm_read_word(&frameTable->slots[slot].wcetUs)){
+                LOG2(SCHED_SLOT_OVERRUN, slot, elapsed);
+            }
+        }
+
+        frame = (frame + 1 < frameTable->frames) ? frame + 1 : 0;
+
+        // a frame which does not end within the watchdog timeout resets the MCU
+        wdt_reset();
+    }
+
+}
+
+#else
+
+void scheduler_run() {
+
+    // Superloop
+    while(1){
+
+        scheduler_runList(NULL);
+
+        // a loop which does not return within the watchdog timeout resets the MCU
+        wdt_reset();
+    }
+
+}
+
+#endif
+
 bool scheduler_add(task_descriptor_t * toAdd) {
     // Check the parameter validity
     if(toAdd == NULL){
         return 0;
     }
 
-    // This new task will be at the end of the taskList -> there is no "next" task in the list
-    toAdd->next = NULL;
-    // The new tast is not executed at this moment
-    toAdd->execute = false;
-
-    // Special case: there is no task in the taskList yet
-    if(taskList == NULL){
-        taskList = toAdd;
+    uint16_t phase = 0;
+    uint16_t start = 0;
+    bool phased = toAdd->autoPhase && toAdd->period > 1;
+    if(phased){
+        phase = scheduler_choosePhase(toAdd->period, &start);
     }
-    else{
-        /* If there are some task in the list, then the end of the list must be found 
-        using an iterator pointer which points to the currently considered task */
-        task_descriptor_t * taskListIterator = taskList;
 
-        while(taskListIterator->next != NULL){
+    // tasks may be added from interrupts, e.g. by the event triggered button debouncer
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
 
-            // Check is the new task already in the taskList or not
-            if(toAdd == taskListIterator->next){
+        // Check is the new task already in the taskList or not
+        for(task_descriptor_t * taskListIterator = taskList; taskListIterator != NULL; taskListIterator = taskListIterator->next){
+            if(toAdd == taskListIterator){
                 return 0;
             }
-            // Next iteration
-            taskListIterator = taskListIterator->next;
         }
-        
-        /* Now the "taskListIterator" points to the last task
-        The new task can be concatenated here */
-        taskListIterator->next = toAdd;
 
+        // the other tasks moved on by the ticks since the phase was chosen
+        if(phased){
+            uint16_t elapsed = (uint16_t)(ticks - start) % toAdd->period;
+            toAdd->expire = (phase > elapsed) ? phase - elapsed : phase - elapsed + toAdd->period;
+            LOG2(SCHED_PHASE, (uintptr_t)toAdd->task, toAdd->expire);
+        }
+
+        // This new task will be at the end of the taskList -> there is no "next" task in the list
+        toAdd->next = NULL;
+        // The new tast is not executed at this moment
+        toAdd->execute = false;
+
+        // Special case: there is no task in the taskList yet
+        if(taskList == NULL){
+            taskList = toAdd;
+        }
+        else{
+            /* If there are some task in the list, then the end of the list must be found 
+            using an iterator pointer which points to the currently considered task */
+            task_descriptor_t * taskListIterator = taskList;
+
+            while(taskListIterator->next != NULL){
+                // Next iteration
+                taskListIterator = taskListIterator->next;
+            }
+            
+            /* Now the "taskListIterator" points to the last task
+            The new task can be concatenated here */
+            taskListIterator->next = toAdd;
+
+        }
     }
 
     return 1;
@@ -137,55 +483,178 @@ bool scheduler_add(task_descriptor_t * toAdd) {
 
 void scheduler_remove(const task_descriptor_t * toRemove) {
     
-    // Check the parameter validity and that taskList is not empty 
-    if(toRemove == NULL || taskList == NULL){
+    // Check the parameter validity
+    if(toRemove == NULL){
         return;
     }
 
-    // Special case: the first list element is the one to be removed
-    if(taskList == toRemove){
-        // Delete the first task item from the list by "bypassing" 
-        taskList = taskList->next;
+    // the tick interrupt walks the list, tasks may be removed from interrupts
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
 
-    }
-    else{
-        // Search the task to be removed iterating through the taskList
-        // Iterator pointer which points to the currently considered task
-        task_descriptor_t * taskListIterator = taskList;
+        // Special case: the first list element is the one to be removed
+        if(taskList == toRemove){
+            // Delete the first task item from the list by "bypassing" 
+            taskList = taskList->next;
 
-        while(taskListIterator->next != NULL){
+        }
+        else if(taskList != NULL){
+            // Search the task to be removed iterating through the taskList
+            // Iterator pointer which points to the currently considered task
+            task_descriptor_t * taskListIterator = taskList;
 
-            if(taskListIterator->next == toRemove){
-                // Task to be removed is founded
+            while(taskListIterator->next != NULL){
 
-                // Delete the founded task from the list by "bypassing"
-                taskListIterator->next = taskListIterator->next->next;
-                // Exit from the cycle
-                break;
-            }
+                if(taskListIterator->next == toRemove){
+                    // Task to be removed is founded
 
-            // Next iteration
-            taskListIterator = taskListIterator->next;
+                    // Delete the founded task from the list by "bypassing"
+                    taskListIterator->next = taskListIterator->next->next;
+                    // Exit from the cycle
+                    break;
+                }
 
-        }
+                // Next iteration
+                taskListIterator = taskListIterator->next;
 
+            }
+
+        }
     }
 
     return;
 }
 
+void scheduler_getStats(scheduler_stats_t * stats){
+    // Check the parameter validity
+    if(stats == NULL){
+        return;
+    }
+
+    stats->tasks = 0;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        for(task_descriptor_t * taskListIterator = taskList; taskListIterator != NULL; taskListIterator = taskListIterator->next){
+            stats->tasks++;
+        }
+        stats->executions = executions;
+        stats->overruns   = overruns;
+        stats->peakReleases = peakReleases;
+    }
+}
+
 system_time_t scheduler_getTime(void){
-    return curr_sys_time;
+    system_time_t now;
+
+    // 32 bit read, the tick must not change it in between
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        now = curr_sys_time;
+    }
+    return now;
+}
+
+time_t scheduler_getClock(void){
+    time_t now;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        now = curr_clock;
+    }
+    return now;
+}
+
+uint16_t scheduler_getDay(time_t * clock){
+    uint16_t day;
+
+    // day and clock of the same tick
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        day = curr_day;
+        if(clock != NULL){
+            *clock = curr_clock;
+        }
+    }
+    return day;
+}
+
+void scheduler_setDeadline(task_descriptor_t * td, uint32_t delay){
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        deadlineTask = td;
+        if(td == NULL){
+            deadlineRemaining = 0;
+        }
+        else{
+            deadlineRemaining = (delay == 0) ? 1 : delay;
+        }
+    }
 }
 
+uint32_t scheduler_getDeadline(void){
+    uint32_t remaining;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        remaining = deadlineRemaining;
+    }
+    return remaining;
+}
+
+void scheduler_setClockCallback(pClockCallback cb){
+    clockCallback = cb;
+}
+
+uint16_t scheduler_getMicros(void){
+    uint16_t millis;
+    uint8_t counts;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        // the ticks run on at midnight and when the time is set
+        millis = ticks;
+        counts = TCNT0;
+
+        // the counter already restarted but the tick is still pending
+        if((TIFR0 & (1 << OCF0A)) && counts < OCR0A){
+            millis++;
+        }
+    }
+
+    return millis * MILLISEC_2_MICROSEC + counts * MICROSEC_PER_TIMER_COUNT;
+}
+
+
+bool scheduler_restoreTime(bool resume){
+    // a torn tick or random RAM contents fail the ranges or the sum
+    bool valid = resume &&
+                 curr_clock.hour < HOUR_PER_DAY && curr_clock.minute < MIN_PER_HOUR &&
+                 curr_clock.second < SEC_PER_MIN && curr_clock.milli < SEC_2_MILLISEC &&
+                 curr_sys_time == time_wrapper_2_system_time(curr_clock);
+
+    if(!valid){
+        curr_sys_time = 0;
+        curr_clock    = (time_t){0};
+        curr_day      = 0;
+    }
+    return valid;
+}
+
+void scheduler_advanceTime(uint16_t elapsed){
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        while(elapsed-- > 0){
+            scheduler_countTime();
+        }
+    }
+}
 
 void scheduler_setTime(system_time_t time){
     /* check the received time parameter 
         greater than MILLISEC_PER_DAY -> system_time will be initialized to 0
         otherwise system_time will be equal with the received time parameter 
     */
-    curr_sys_time = (time >= MILLISEC_PER_DAY ) ? 0 : time;
+    time = (time >= MILLISEC_PER_DAY ) ? 0 : time;
+
+    // the divisions are needed only here, the tick continues with carries
+    time_t brokenDown = system_time_wrapper_2_time(time);
 
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        curr_sys_time = time;
+        curr_clock    = brokenDown;
+        clockChanges |= SCHEDULER_CLOCK_SECOND | SCHEDULER_CLOCK_MINUTE | SCHEDULER_CLOCK_HOUR | SCHEDULER_CLOCK_SET;
+    }
 }
 
 
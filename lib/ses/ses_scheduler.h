@@ -10,6 +10,25 @@
 #define MIN_PER_HOUR        60
 #define SEC_PER_MIN         60
 
+/* units of the broken-down clock which changed, passed to the clock callback */
+#define SCHEDULER_CLOCK_SECOND  0x01
+#define SCHEDULER_CLOCK_MINUTE  0x02
+#define SCHEDULER_CLOCK_HOUR    0x04
+#define SCHEDULER_CLOCK_DAY     0x08    /* midnight passed, the day counter changed */
+#define SCHEDULER_CLOCK_SET     0x10    /* the time was set by scheduler_setTime */
+
+/* scheduling modes, selected at build time with -D SCHEDULER_MODE=...;
+   SCHEDULER_DYNAMIC runs the tasks of the list when they are released,
+   SCHEDULER_CYCLIC runs the frames of a table generated by tools/gen_cyclic.py
+   and serves the list in the slots of scheduler_runList, the tick only counts
+   the frames */
+#define SCHEDULER_DYNAMIC       0
+#define SCHEDULER_CYCLIC        1
+
+#ifndef SCHEDULER_MODE
+#define SCHEDULER_MODE          SCHEDULER_DYNAMIC
+#endif
+
 /* TYPES ********************************************************************/
 
 /**
@@ -26,10 +45,18 @@ typedef struct task_descriptor_s {
    uint16_t expire;      ///< time offset in ms, after which to call the task
    uint16_t period;      ///< period of the timer after firing; 0 means exec once
    uint8_t execute:1;    ///< for internal use
-   uint8_t reserved:7;   ///< reserved
+   uint8_t autoPhase:1;  ///< scheduler_add chooses expire of a periodic task
+   uint8_t reserved:6;   ///< reserved
    struct task_descriptor_s * next; ///< pointer to next task, internal use
 } task_descriptor_t;
 
+/**
+ * Type of function pointer for the clock notifications
+ *
+ * @param changed  SCHEDULER_CLOCK_* flags of the units which changed
+ */
+typedef void (* pClockCallback)(uint8_t changed);
+
 /**
  * type for tracking the system time in ms
  */
@@ -46,6 +73,38 @@ typedef struct {
 } time_t;
 
 
+/**
+ * Runtime statistics of the scheduler
+ */
+typedef struct {
+   uint8_t tasks;          ///< number of tasks in the task list
+   uint32_t executions;    ///< number of task executions since start
+   uint16_t overruns;      ///< releases of tasks whose previous release was not executed yet,
+                           ///< in cyclic mode also the frames started late
+   uint8_t peakReleases;   ///< most tasks released in one tick since start,
+                           ///< in cyclic mode in one pass of the list
+} scheduler_stats_t;
+
+/**
+ * A task of the frame table
+ */
+typedef struct {
+   task_t task;
+   void * param;
+   uint16_t wcetUs;        ///< WCET of the table, a longer run is logged
+} scheduler_slot_t;
+
+/**
+ * Frame table of the cyclic executive, the arrays are in flash
+ */
+typedef struct {
+   uint8_t frameMs;                    ///< length of a minor frame in ms
+   uint8_t frames;                     ///< minor frames of the major frame
+   const uint8_t * first;              ///< first slot of every frame, frames + 1 entries
+   const scheduler_slot_t * slots;     ///< slots of all frames in the order they run
+} scheduler_table_t;
+
+
 /* FUNCTION PROTOTYPES *******************************************************/
 
 /**
@@ -58,6 +117,30 @@ void scheduler_init(void);
  */
 void scheduler_run(void);
 
+/**
+ * Executes the released tasks of the list once and calls the clock callback.
+ * The dynamic scheduler loops over it; in cyclic mode it is a task of the
+ * frame table and first releases the tasks for the ms since its last pass.
+ * A list task whose period is shorter than the time between two passes then
+ * runs once per pass and its skipped releases count as overruns.
+ *
+ * @param param  unused
+ */
+void scheduler_runList(void * param);
+
+#if SCHEDULER_MODE == SCHEDULER_CYCLIC
+/**
+ * Sets the frame table of the cyclic executive before scheduler_init. The
+ * tick starts a minor frame every table->frameMs ms and scheduler_run runs
+ * the slots of the frame in their order; a frame which is not finished when
+ * the next one starts is counted as overrun and the late frames are skipped.
+ * Every slot is timed, SCHED_SLOT_OVERRUN reports runs longer than its WCET.
+ *
+ * @param table  the table, it must stay valid
+ */
+void scheduler_setTable(const scheduler_table_t * table);
+#endif
+
 /**
  * Adds a new task to the scheduler.
  *
@@ -67,6 +150,13 @@ void scheduler_run(void);
  *             executed. td->expire and td->execute are written to by
  *             the task scheduler
  *
+ *             If td->autoPhase is set and td->period is greater than 1,
+ *             td->expire is chosen in 1 ... td->period such that the task
+ *             shares release ticks with the fewest periodic tasks already
+ *             added, which flattens the load of the ticks. The search takes
+ *             some ms for long periods, phased tasks are added at start-up
+ *             and never from interrupts.
+ *
  * @return     false, if task is already present or invalid (NULL)
  *             true, if task was successfully added to scheduler and will be
  *             scheduled after td->expire ms
@@ -80,6 +170,13 @@ bool scheduler_add(task_descriptor_t * td);
  * */
 void scheduler_remove(const task_descriptor_t * td);
 
+/**
+ * Gets the runtime statistics of the scheduler
+ *
+ * @param stats pointer to store the statistics at
+ * */
+void scheduler_getStats(scheduler_stats_t * stats);
+
 /**
  * Gets the current system time with 1ms resolution
  *
@@ -87,6 +184,82 @@ void scheduler_remove(const task_descriptor_t * td);
  * */
 system_time_t scheduler_getTime(void);
 
+/**
+ * Gets the current system time as hours, minutes, seconds and ms. The
+ * scheduler tick counts these along with the system time, so this needs
+ * no division.
+ *
+ * @return  current system time in human readable format
+ * */
+time_t scheduler_getClock(void);
+
+/**
+ * Gets the number of days the system time passed midnight since the start,
+ * and the broken-down time of the same instant.
+ *
+ * @param clock  stores the current time, may be NULL
+ *
+ * @return  days since the start
+ * */
+uint16_t scheduler_getDay(time_t * clock);
+
+/**
+ * Sets the deadline task, a one-shot task released after a delay of up to
+ * 49 days, which costs one decrement per tick until then; in cyclic mode the
+ * pass of the list counts it down. There is only one deadline, setting it
+ * again replaces the previous one.
+ *
+ * @param td     the task, NULL to clear the deadline
+ * @param delay  ms until the task is released, 0 releases it in the next tick
+ * */
+void scheduler_setDeadline(task_descriptor_t * td, uint32_t delay);
+
+/**
+ * Gets the time until the deadline task is released.
+ *
+ * @return  remaining ms, 0 if no deadline is pending
+ * */
+uint32_t scheduler_getDeadline(void);
+
+/**
+ * Keeps the system time of before a warm reset or starts it at 0. The time
+ * is held in RAM which the startup code does not clear, so this must be
+ * called before any other function reads the time.
+ *
+ * @param resume  true after a warm reset, the kept time continues if it is
+ *                consistent
+ *
+ * @return  true, if the kept time continues
+ * */
+bool scheduler_restoreTime(bool resume);
+
+/**
+ * Advances the system time by the ms in which the timer did not run, like a
+ * reset or the initialization before scheduler_init.
+ *
+ * @param elapsed  ms to add
+ * */
+void scheduler_advanceTime(uint16_t elapsed);
+
+/**
+ * Sets the function called when the second, minute, hour or day of the
+ * system time changes or the time is set. It is called from the scheduler
+ * loop, not from the timer interrupt, like a task.
+ *
+ * @param cb  the callback, NULL to disable the notifications
+ * */
+void scheduler_setClockCallback(pClockCallback cb);
+
+/**
+ * Gets a free running timestamp in us with 4us resolution, derived from the
+ * ticks since start and the counter of the scheduler timer, so midnight and
+ * scheduler_setTime do not disturb it. Wraps every 65.536ms, so it is only
+ * meant for measuring short execution times.
+ *
+ * @return  timestamp in us
+ * */
+uint16_t scheduler_getMicros(void);
+
 /**
  * Redefines the current system time 
  *
@@ -104,7 +277,8 @@ void scheduler_setTime(system_time_t time);
 system_time_t time_wrapper_2_system_time(time_t time);
 
 /**
- * Changes the system time format to human readable time format
+ * Changes the system time format to human readable time format; uses
+ * divisions, scheduler_getClock gives the current time without
  *
  * @param time system time format
  * 
@@ -0,0 +1,98 @@
+/* INCLUDES ******************************************************************/
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <avr/io.h>
+#include <avr/wdt.h>
+#include <util/crc16.h>
+
+#include "ses_snapshot.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+// variables in RAM which the startup code does not clear
+#define SNAPSHOT_NOINIT         __attribute__((section(".noinit")))
+
+#define SNAPSHOT_MAGIC          0x5A3C
+
+// start value of the CRC-16/CCITT
+#define SNAPSHOT_CRC_INIT       0xFFFF
+
+// timer 3 counts with 16MHz / 1024 = 64us
+#define SNAPSHOT_US_PER_COUNT   64
+
+/* TYPES *********************************************************************/
+
+typedef struct {
+    uint16_t magic;
+    uint8_t length;
+    uint8_t data[SNAPSHOT_MAX_SIZE];
+    uint16_t crc;                       ///< CRC-16/CCITT of magic, length and data
+} snapshot_t;
+
+/* PRIVATE VARIABLES *********************************************************/
+
+static snapshot_t snapshot SNAPSHOT_NOINIT;
+static uint8_t resetCause SNAPSHOT_NOINIT;
+
+/*FUNCTION DEFINITION ********************************************************/
+
+/* runs in the startup code before the RAM is initialized; after a watchdog
+reset the watchdog stays on with its shortest timeout until WDRF is cleared */
+void snapshot_saveResetCause(void) __attribute__((naked, used, section(".init3")));
+void snapshot_saveResetCause(void) {
+    resetCause = MCUSR;
+    MCUSR = 0;
+    wdt_disable();
+}
+
+static uint16_t snapshot_crc(void) {
+    uint16_t crc = SNAPSHOT_CRC_INIT;
+    const uint8_t * header = (const uint8_t *)&snapshot;
+
+    for(uint8_t i = 0; i < offsetof(snapshot_t, data) + snapshot.length; i++){
+        crc = _crc_ccitt_update(crc, header[i]);
+    }
+    return crc;
+}
+
+void snapshot_init(void) {
+    TCCR3A = 0;
+    TCNT3  = 0;
+    TCCR3B = (1 << CS32) | (1 << CS30);
+}
+
+uint8_t snapshot_getResetCause(void) {
+    return resetCause;
+}
+
+bool snapshot_isWarm(void) {
+    return !(resetCause & (1 << PORF));
+}
+
+void snapshot_save(const void * data, uint8_t length) {
+    if(length > SNAPSHOT_MAX_SIZE){
+        return;
+    }
+
+    // a reset while saving leaves a wrong checksum, the snapshot is then cold
+    snapshot.magic  = SNAPSHOT_MAGIC;
+    snapshot.length = length;
+    memcpy(snapshot.data, data, length);
+    snapshot.crc    = snapshot_crc();
+}
+
+bool snapshot_restore(void * data, uint8_t length) {
+    if(!snapshot_isWarm() || snapshot.magic != SNAPSHOT_MAGIC || snapshot.length != length ||
+       length > SNAPSHOT_MAX_SIZE || snapshot.crc != snapshot_crc()){
+        return false;
+    }
+
+    memcpy(data, snapshot.data, length);
+    return true;
+}
+
+uint16_t snapshot_bootTime(void) {
+    TCCR3B = 0;
+    return (uint32_t)TCNT3 * SNAPSHOT_US_PER_COUNT / 1000;
+}
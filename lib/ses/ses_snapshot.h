@@ -0,0 +1,73 @@
+#ifndef SES_SNAPSHOT_H_
+#define SES_SNAPSHOT_H_
+
+/* INCLUDES ******************************************************************/
+
+#include <stdbool.h>
+#include <inttypes.h>
+
+/* DEFINES & MACROS **********************************************************/
+
+/* maximum size of the snapshot data */
+#ifndef SNAPSHOT_MAX_SIZE
+#define SNAPSHOT_MAX_SIZE       32
+#endif
+
+/* estimated ms from the last tick before a warm reset to the start of main:
+the reset delay of the fuses (65ms) and the bootloader passing through */
+#ifndef SNAPSHOT_RESET_MS
+#define SNAPSHOT_RESET_MS       70
+#endif
+
+/* FUNCTION PROTOTYPES *******************************************************/
+
+/**
+ * Starts the boot timer, to be called first in main. The reset cause was
+ * already saved and the watchdog disabled by the startup code.
+ */
+void snapshot_init(void);
+
+/**
+ * Get the cause of the last reset.
+ *
+ * @return  the MCUSR flags at startup; 0 if a bootloader cleared them
+ */
+uint8_t snapshot_getResetCause(void);
+
+/**
+ * Check whether the RAM survived the last reset, which is any reset except a
+ * power-on reset. A bootloader may hide the cause, the checksum of the
+ * snapshot still rejects the random contents after power-on.
+ *
+ * @return  true, if the reset was warm
+ */
+bool snapshot_isWarm(void);
+
+/**
+ * Copies data into the snapshot in RAM which the startup code does not
+ * clear, together with a checksum.
+ *
+ * @param data    the data
+ * @param length  bytes of data, at most SNAPSHOT_MAX_SIZE
+ */
+void snapshot_save(const void * data, uint8_t length);
+
+/**
+ * Restores the data of the snapshot after a warm reset.
+ *
+ * @param data    stores the data
+ * @param length  bytes of data, must match the saved length
+ *
+ * @return        false after a cold reset or if the snapshot is invalid
+ */
+bool snapshot_restore(void * data, uint8_t length);
+
+/**
+ * Get the time since snapshot_init and stop the boot timer, which uses
+ * timer 3 until then.
+ *
+ * @return  ms since snapshot_init, at most 4194
+ */
+uint16_t snapshot_bootTime(void);
+
+#endif /* SES_SNAPSHOT_H_ */
@@ -0,0 +1,269 @@
+/* INCLUDES ******************************************************************/
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/eeprom.h>
+#include <util/crc16.h>
+
+#include "ses_store.h"
+#include "ses_scheduler.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+// start value of the CRC-16/CCITT
+#define STORE_CRC_INIT          0xFFFF
+
+#define STORE_RECORD_SIZE       sizeof(store_record_t)
+#define STORE_SLOTS             ((uint8_t)(STORE_EEPROM_SIZE / STORE_RECORD_SIZE))
+#define STORE_NO_SLOT           0xFF
+
+// cache flags
+#define STORE_DIRTY             0x01
+
+// states of the background write
+#define STORE_WRITE_IDLE        0
+#define STORE_WRITE_BUSY        1   // the EEPROM ready interrupt programs the record
+#define STORE_WRITE_DONE        2   // the record is complete, the task commits it
+
+/* TYPES *********************************************************************/
+
+/**
+ * One slot of the ring. A value is written to the next slot which does not
+ * hold the newest record of a key, so the old record stays valid until the
+ * new one is complete and the writes spread over all slots.
+ */
+typedef struct {
+    uint32_t sequence;                  ///< increments with every record, the newest wins
+    uint8_t key;
+    uint8_t length;
+    uint8_t value[STORE_VALUE_SIZE];
+    uint16_t crc;                       ///< CRC-16/CCITT of the fields above
+} store_record_t;
+
+/**
+ * Cached value of a key
+ */
+typedef struct {
+    uint8_t value[STORE_VALUE_SIZE];
+    uint8_t length;                     ///< 0 if the key has no value
+    uint8_t flags;                      ///< STORE_DIRTY
+    uint8_t slot;                       ///< slot of the newest record, STORE_NO_SLOT if none
+    uint32_t sequence;                  ///< sequence of the newest record
+} store_entry_t;
+
+/* PRIVATE VARIABLES *********************************************************/
+
+static store_entry_t cache[STORE_MAX_KEYS];
+
+// next sequence number and the slot to try first
+static uint32_t nextSequence = 0;
+static uint8_t head = 0;
+
+// the record being written by the EEPROM ready interrupt
+static store_record_t writeRecord;
+static uint16_t writeAddress;
+static uint8_t writeKey;
+static uint8_t writeSlot;
+static volatile uint8_t writeIndex;
+static volatile uint8_t writeState = STORE_WRITE_IDLE;
+static volatile uint8_t programmed;
+
+static store_stats_t storeStats;
+
+/*FUNCTION DEFINITION ********************************************************/
+
+static uint16_t store_crc(const store_record_t * record) {
+    const uint8_t * data = (const uint8_t *)record;
+    uint16_t crc = STORE_CRC_INIT;
+
+    for(uint8_t i = 0; i < offsetof(store_record_t, crc); i++){
+        crc = _crc_ccitt_update(crc, data[i]);
+    }
+    return crc;
+}
+
+static uint8_t store_nextSlot(uint8_t slot) {
+    return (slot + 1 < STORE_SLOTS) ? slot + 1 : 0;
+}
+
+// the slot holds the newest record of a key
+static bool store_isLive(uint8_t slot) {
+    for(uint8_t key = 0; key < STORE_MAX_KEYS; key++){
+        if(cache[key].slot == slot){
+            return true;
+        }
+    }
+    return false;
+}
+
+// writes the first dirty value to the next free slot, the interrupt programs it
+static void store_writeNext(void) {
+    uint8_t key = 0;
+
+    while(key < STORE_MAX_KEYS && !(cache[key].flags & STORE_DIRTY)){
+        key++;
+    }
+    if(key == STORE_MAX_KEYS){
+        return;
+    }
+
+    // there are more slots than keys, a free one is always found
+    uint8_t slot = head;
+    while(store_isLive(slot)){
+        slot = store_nextSlot(slot);
+    }
+    head = store_nextSlot(slot);
+
+    store_entry_t * entry = &cache[key];
+    entry->flags &= ~STORE_DIRTY;
+    entry->sequence = nextSequence++;
+
+    writeRecord.sequence = entry->sequence;
+    writeRecord.key      = key;
+    writeRecord.length   = entry->length;
+    memcpy(writeRecord.value, entry->value, STORE_VALUE_SIZE);
+    writeRecord.crc      = store_crc(&writeRecord);
+
+    writeKey     = key;
+    writeSlot    = slot;
+    writeAddress = STORE_EEPROM_START + (uint16_t)slot * STORE_RECORD_SIZE;
+    writeIndex   = 0;
+    programmed   = 0;
+    writeState   = STORE_WRITE_BUSY;
+
+    // the interrupt fires as soon as the EEPROM is ready
+    EECR |= (1 << EERIE);
+}
+
+static void store_task(void * param) {
+    if(writeState == STORE_WRITE_BUSY){
+        return;
+    }
+
+    // the new record is complete, the slot of the old one is free now
+    if(writeState == STORE_WRITE_DONE){
+        cache[writeKey].slot = writeSlot;
+        storeStats.records++;
+        storeStats.bytes += programmed;
+        writeState = STORE_WRITE_IDLE;
+    }
+
+    store_writeNext();
+}
+
+void store_init(void) {
+    store_record_t record;
+
+    for(uint8_t key = 0; key < STORE_MAX_KEYS; key++){
+        cache[key].length = 0;
+        cache[key].flags  = 0;
+        cache[key].slot   = STORE_NO_SLOT;
+    }
+    nextSequence        = 0;
+    head                = 0;
+    storeStats.restored = 0;
+
+    for(uint8_t slot = 0; slot < STORE_SLOTS; slot++){
+        eeprom_read_block(&record, (const void *)(STORE_EEPROM_START + (uint16_t)slot * STORE_RECORD_SIZE), STORE_RECORD_SIZE);
+
+        // erased and torn records fail the check
+        if(record.key >= STORE_MAX_KEYS || record.length > STORE_VALUE_SIZE || record.crc != store_crc(&record)){
+            continue;
+        }
+
+        if(record.sequence >= nextSequence){
+            nextSequence = record.sequence + 1;
+            head = store_nextSlot(slot);
+        }
+
+        store_entry_t * entry = &cache[record.key];
+        if(entry->slot == STORE_NO_SLOT || record.sequence > entry->sequence){
+            if(entry->slot == STORE_NO_SLOT){
+                storeStats.restored++;
+            }
+            memcpy(entry->value, record.value, STORE_VALUE_SIZE);
+            entry->length   = record.length;
+            entry->slot     = slot;
+            entry->sequence = record.sequence;
+        }
+    }
+}
+
+void store_startTask(uint16_t period) {
+    static task_descriptor_t storeTask;
+
+    scheduler_remove(&storeTask);
+    storeTask.task   = store_task;
+    storeTask.param  = NULL;
+    storeTask.expire = period;
+    storeTask.period = period;
+    storeTask.autoPhase = true;
+    scheduler_add(&storeTask);
+}
+
+bool store_get(uint8_t key, void * value, uint8_t length) {
+    if(key >= STORE_MAX_KEYS || cache[key].length == 0 || cache[key].length != length){
+        return false;
+    }
+
+    memcpy(value, cache[key].value, length);
+    return true;
+}
+
+bool store_set(uint8_t key, const void * value, uint8_t length) {
+    if(key >= STORE_MAX_KEYS || length == 0 || length > STORE_VALUE_SIZE){
+        return false;
+    }
+
+    store_entry_t * entry = &cache[key];
+
+    // an unchanged value costs no write
+    if(entry->length == length && memcmp(entry->value, value, length) == 0){
+        return true;
+    }
+
+    memset(entry->value, 0, STORE_VALUE_SIZE);
+    memcpy(entry->value, value, length);
+    entry->length = length;
+    entry->flags |= STORE_DIRTY;
+    return true;
+}
+
+bool store_isPending(void) {
+    if(writeState != STORE_WRITE_IDLE){
+        return true;
+    }
+    for(uint8_t key = 0; key < STORE_MAX_KEYS; key++){
+        if(cache[key].flags & STORE_DIRTY){
+            return true;
+        }
+    }
+    return false;
+}
+
+void store_getStats(store_stats_t * stats) {
+    *stats = storeStats;
+}
+
+/* programs the record byte by byte, unchanged bytes are skipped; a byte
+takes 3.4ms, the interrupt returns while it is programmed */
+ISR(EE_READY_vect){
+    while(writeIndex < STORE_RECORD_SIZE){
+        uint8_t byte = ((const uint8_t *)&writeRecord)[writeIndex];
+
+        EEAR = writeAddress + writeIndex++;
+        EECR |= (1 << EERE);
+        if(EEDR != byte){
+            EEDR = byte;
+            EECR |= (1 << EEMPE);
+            EECR |= (1 << EEPE);
+            programmed++;
+            return;
+        }
+    }
+
+    EECR &= ~(1 << EERIE);
+    writeState = STORE_WRITE_DONE;
+}
@@ -0,0 +1,93 @@
+#ifndef SES_STORE_H_
+#define SES_STORE_H_
+
+/* INCLUDES ******************************************************************/
+
+#include <stdbool.h>
+#include <inttypes.h>
+#include <avr/io.h>
+
+/* DEFINES & MACROS **********************************************************/
+
+/* number of keys, keys are 0 ... STORE_MAX_KEYS - 1 */
+#ifndef STORE_MAX_KEYS
+#define STORE_MAX_KEYS          8
+#endif
+
+/* maximum length of a value */
+#define STORE_VALUE_SIZE        8
+
+/* EEPROM area of the record ring, a multiple of the record size */
+#ifndef STORE_EEPROM_START
+#define STORE_EEPROM_START      0
+#endif
+#ifndef STORE_EEPROM_SIZE
+#define STORE_EEPROM_SIZE       (E2END + 1 - STORE_EEPROM_START)
+#endif
+
+/* TYPES *********************************************************************/
+
+/**
+ * Counters of the store since the start
+ */
+typedef struct {
+    uint32_t records;       ///< records written
+    uint32_t bytes;         ///< EEPROM bytes programmed, unchanged bytes are skipped
+    uint8_t restored;       ///< keys restored by store_init
+} store_stats_t;
+
+/* FUNCTION PROTOTYPES *******************************************************/
+
+/**
+ * Restores the newest valid record of each key from the EEPROM ring into the
+ * RAM cache, records with a wrong CRC are ignored.
+ */
+void store_init(void);
+
+/**
+ * Starts the background task which writes the changed values, one record
+ * per call, byte by byte from the EEPROM ready interrupt.
+ *
+ * @param period  ms between two calls of the task
+ */
+void store_startTask(uint16_t period);
+
+/**
+ * Reads a value from the RAM cache.
+ *
+ * @param key     the key
+ * @param value   stores the value
+ * @param length  bytes of the value
+ *
+ * @return        false, if the key has no value of this length
+ */
+bool store_get(uint8_t key, void * value, uint8_t length);
+
+/**
+ * Changes a value in the RAM cache. Only a value which differs from the
+ * cached one is written, and several changes before the write coalesce
+ * into one record.
+ *
+ * @param key     the key
+ * @param value   the value
+ * @param length  bytes of the value, at most STORE_VALUE_SIZE
+ *
+ * @return        false, if the key or length are invalid
+ */
+bool store_set(uint8_t key, const void * value, uint8_t length);
+
+/**
+ * Check whether changed values are waiting to be written.
+ *
+ * @return        true, if a record is dirty or being written
+ */
+bool store_isPending(void);
+
+/**
+ * Get the counters of the store.
+ *
+ * @param stats   stores the counters
+ */
+void store_getStats(store_stats_t * stats);
+
+#endif /* SES_STORE_H_ */
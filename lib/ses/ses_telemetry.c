@@ -0,0 +1,151 @@
+/* INCLUDES ******************************************************************/
+#include <stdlib.h>
+
+#include "ses_telemetry.h"
+#include "ses_adc.h"
+#include "ses_frame.h"
+#include "ses_scheduler.h"
+#include "ses_usbserial.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+// number of sampled channels: light, potentiometer, temperature
+#define TELEMETRY_CHANNELS          3
+
+// period of the sampling task, the shortest possible sample period
+#define TELEMETRY_TASK_EXEC_MS      1
+
+/* TYPES *********************************************************************/
+
+/**
+ * Sampling state of one channel. While one frame is filled, the other one
+ * may still wait for space in the USB serial TX buffer.
+ */
+typedef struct {
+    uint8_t adcChannel;     ///< sampled ADC channel
+    uint16_t period;        ///< sample period in ms, 0 if stopped
+    uint16_t countdown;     ///< ms until the next sample
+    uint16_t sequence;      ///< sequence number of the frame being filled
+    uint8_t fill;           ///< samples in the frame being filled
+    uint8_t active;         ///< index of the frame being filled
+    bool pending;           ///< the other frame is complete and not sent yet
+    uint8_t frames[2][TELEMETRY_FRAME_SIZE];
+} telemetry_channel_t;
+
+/* PRIVATE VARIABLES *********************************************************/
+
+static telemetry_channel_t channels[TELEMETRY_CHANNELS] = {
+    { .adcChannel = ADC_LIGHT_CH },
+    { .adcChannel = ADC_POTI_CH },
+    { .adcChannel = ADC_TEMP_CH },
+};
+
+static telemetry_stats_t stats;
+
+/*FUNCTION DEFINITION ********************************************************/
+
+static void telemetry_sendPending(telemetry_channel_t * channel) {
+    uint8_t encoded[FRAME_ENCODED_SIZE(TELEMETRY_FRAME_SIZE)];
+
+    // a frame is only encoded once it fits into the TX buffer as a whole
+    if(!channel->pending || usbserial_txFree() < sizeof(encoded)){
+        return;
+    }
+
+    uint8_t len = frame_encode(channel->frames[channel->active ^ 1], TELEMETRY_FRAME_SIZE, encoded);
+    usbserial_write(encoded, len);
+
+    channel->pending = false;
+    stats.framesSent++;
+}
+
+static void telemetry_sample(telemetry_channel_t * channel) {
+    uint8_t * frame = channel->frames[channel->active];
+
+    // header at the first sample of a frame
+    if(channel->fill == 0){
+        system_time_t now = scheduler_getTime();
+
+        frame[0] = TELEMETRY_FRAME_TYPE;
+        frame[1] = channel->adcChannel;
+        frame[2] = (uint8_t)channel->sequence;
+        frame[3] = (uint8_t)(channel->sequence >> 8);
+        frame[4] = (uint8_t)now;
+        frame[5] = (uint8_t)(now >> 8);
+        frame[6] = (uint8_t)(now >> 16);
+        frame[7] = (uint8_t)(now >> 24);
+        frame[8] = (uint8_t)channel->period;
+        frame[9] = (uint8_t)(channel->period >> 8);
+    }
+
+    uint16_t sample = adc_read(channel->adcChannel);
+    uint8_t pos = TELEMETRY_HEADER_SIZE + 2 * channel->fill;
+
+    frame[pos]     = (uint8_t)sample;
+    frame[pos + 1] = (uint8_t)(sample >> 8);
+
+    if(++channel->fill < TELEMETRY_SAMPLES_PER_FRAME){
+        return;
+    }
+
+    /* frame complete: switch buffers, unless the previous frame is still
+    waiting; then this one is dropped and its buffer refilled */
+    if(channel->pending){
+        stats.framesDropped++;
+    }
+    else{
+        channel->pending = true;
+        channel->active ^= 1;
+    }
+    channel->sequence++;
+    channel->fill = 0;
+}
+
+static void telemetry_task(void * param) {
+
+    for(uint8_t i = 0; i < TELEMETRY_CHANNELS; i++){
+        telemetry_channel_t * channel = &channels[i];
+
+        if(channel->period != 0 && --channel->countdown == 0){
+            channel->countdown = channel->period;
+            telemetry_sample(channel);
+        }
+
+        telemetry_sendPending(channel);
+    }
+}
+
+void telemetry_init(void) {
+    static task_descriptor_t samplingTask;
+
+    samplingTask.task   = telemetry_task;
+    samplingTask.param  = NULL;
+    samplingTask.expire = TELEMETRY_TASK_EXEC_MS;
+    samplingTask.period = TELEMETRY_TASK_EXEC_MS;
+    scheduler_add(&samplingTask);
+}
+
+bool telemetry_setPeriod(uint8_t adc_channel, uint16_t period) {
+
+    for(uint8_t i = 0; i < TELEMETRY_CHANNELS; i++){
+        telemetry_channel_t * channel = &channels[i];
+
+        if(channel->adcChannel == adc_channel){
+            // restart with an empty frame, so all samples of a frame share the period
+            channel->period    = period;
+            channel->countdown = period;
+            channel->fill      = 0;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void telemetry_getStats(telemetry_stats_t * stats_out) {
+    if(stats_out == NULL){
+        return;
+    }
+
+    *stats_out = stats;
+}
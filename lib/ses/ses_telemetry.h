@@ -0,0 +1,64 @@
+#ifndef SES_TELEMETRY_H_
+#define SES_TELEMETRY_H_
+
+/* INCLUDES ******************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+/* DEFINES & MACROS **********************************************************/
+
+// first payload byte of a frame carrying telemetry samples
+#define TELEMETRY_FRAME_TYPE            0xD0
+
+// samples per frame, all frames have the same size
+#define TELEMETRY_SAMPLES_PER_FRAME     24
+
+/*
+ * Frame payload, little endian:
+ *  0     TELEMETRY_FRAME_TYPE
+ *  1     ADC channel
+ *  2-3   sequence number, counted per channel also for dropped frames
+ *  4-7   system time of the first sample in ms
+ *  8-9   sample period in ms
+ *  10-   TELEMETRY_SAMPLES_PER_FRAME raw ADC samples of 2 bytes
+ */
+#define TELEMETRY_HEADER_SIZE           10
+#define TELEMETRY_FRAME_SIZE            (TELEMETRY_HEADER_SIZE + 2 * TELEMETRY_SAMPLES_PER_FRAME)
+
+/* TYPES *********************************************************************/
+
+/**
+ * Statistics of the telemetry stream
+ */
+typedef struct {
+    uint16_t framesSent;        ///< frames handed to the USB serial TX buffer
+    uint16_t framesDropped;     ///< frames lost because the USB serial TX buffer stayed full
+} telemetry_stats_t;
+
+
+/* FUNCTION PROTOTYPES *******************************************************/
+
+/**
+ * Adds the 1ms sampling task to the scheduler. All channels start disabled.
+ * Requires adc_init and usbserial_bufferInit.
+ */
+void telemetry_init(void);
+
+/**
+ * Sets the sample period of an ADC channel.
+ *
+ * @param adc_channel	channel as element of the ADCChannels enum
+ * @param period		sample period in ms, 0 stops the channel
+ *
+ * @return			false, if the channel is not sampled by the telemetry
+ */
+bool telemetry_setPeriod(uint8_t adc_channel, uint16_t period);
+
+/**
+ * Gets a copy of the statistics of the telemetry stream.
+ *
+ * @param stats	pointer to store the statistics at
+ */
+void telemetry_getStats(telemetry_stats_t * stats);
+
+#endif /* SES_TELEMETRY_H_ */
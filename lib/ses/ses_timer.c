@@ -1,6 +1,7 @@
 /* INCLUDES ******************************************************************/
 #include <stdlib.h>
 #include <avr/interrupt.h>
+#include <util/atomic.h>
 
 #include "ses_timer.h"
 
@@ -18,10 +19,22 @@
 #define TIMER_PSC64				0x03
 #define TIMER_STOP				0x00
 
+// CPU cycles per timer 0 count with prescaler 64
+#define TIMER0_CYC_PER_COUNT	64
+// timer 0 counts per compare match
+#define TIMER0_COUNTS_PER_TICK	(TIMER0_CYC_FOR_1MILLISEC + 1)
+// timer 0 position range, 256 ticks
+#define TIMER0_COUNTS_WRAP		(256 * (uint16_t)TIMER0_COUNTS_PER_TICK)
+
 
 static pTimerCallback fp_Timer0_Callback;
 static pTimerCallback fp_Timer1_Callback;
 
+// compare matches of timer 0, counted to measure halts
+static volatile uint8_t timer0Ticks;
+// timer 0 position at timer0_beginHalt
+static uint16_t timer0HaltPosition;
+
 /*FUNCTION DEFINITION ********************************************************/
 
 void timer0_setCallback(pTimerCallback cb) {
@@ -52,6 +65,53 @@ void timer0_start() {
 }
 
 
+/**
+ * position of timer 0 in counts modulo TIMER0_COUNTS_WRAP, must be called atomically
+ */
+static uint16_t timer0_position(void) {
+	uint8_t ticks = timer0Ticks;
+	uint8_t counts = TCNT0;
+
+	// the counter already restarted but the tick is still pending
+	if((TIFR0 & (1 << OCF0A)) && counts < OCR0A){
+		ticks++;
+	}
+	return (uint16_t)ticks * TIMER0_COUNTS_PER_TICK + counts;
+}
+
+void timer0_beginHalt(void) {
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+		timer0HaltPosition = timer0_position();
+	}
+}
+
+void timer0_endHalt(uint16_t cycles) {
+	uint16_t expected = cycles / TIMER0_CYC_PER_COUNT;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+		uint16_t position = timer0_position();
+		uint16_t counted = (position >= timer0HaltPosition) ? position - timer0HaltPosition :
+						   position + TIMER0_COUNTS_WRAP - timer0HaltPosition;
+
+		// the timer ran at least as long as the halt lasted: nothing was missed
+		if(counted < expected){
+			uint16_t count = TCNT0 + (expected - counted);
+
+			/* run the missed compare matches here; the compare match is
+			blocked for one count after writing TCNT0, so a count equal to
+			OCR0A is handled as a match as well */
+			while(count >= OCR0A){
+				count = (count > OCR0A) ? count - TIMER0_COUNTS_PER_TICK : 0;
+				timer0Ticks++;
+				if(fp_Timer0_Callback != NULL){
+					fp_Timer0_Callback();
+				}
+			}
+			TCNT0 = count;
+		}
+	}
+}
+
 void timer0_stop() {
 	// Clear Prescaler bits (CS02-CS00)
 	TCCR0B &= ~(TIMER_PSC_MASK << TIMER_PSC_BIT_POS);
@@ -98,6 +158,7 @@ void timer1_stop() {
 }
 
 ISR(TIMER0_COMPA_vect) {
+	timer0Ticks++;
 	fp_Timer0_Callback();
 }
 
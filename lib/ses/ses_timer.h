@@ -1,6 +1,7 @@
 #ifndef SES_TIMER_H_
 #define SES_TIMER_H_
 
+#include <inttypes.h>
 
 
 /*PROTOTYPES *****************************************************************/
@@ -32,6 +33,23 @@ void timer0_start();
 void timer0_stop();
 
 
+/**
+ * Marks the start of a period in which the clock of timer 0 may be halted,
+ * e.g. by the ADC noise reduction sleep mode.
+ */
+void timer0_beginHalt(void);
+
+
+/**
+ * Marks the end of the period started with timer0_beginHalt. The counts the
+ * timer missed are added to it; compare matches it missed call the callback,
+ * so no 1 ms tick is lost.
+ *
+ * @param cycles  CPU cycles the period actually lasted
+ */
+void timer0_endHalt(uint16_t cycles);
+
+
 /**
  * Sets a function to be called when the timer fires.
  *
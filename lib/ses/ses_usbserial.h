@@ -4,8 +4,32 @@
 /*INCLUDES-------------------------------------------------------------------*/
 #include <stdio.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include <avr/interrupt.h>
 
+/* DEFINES & MACROS **********************************************************/
+
+// sizes of the transmit and receive ring buffers (power of two, at most 128)
+#define USBSERIAL_TX_BUFFER_SIZE    128
+#define USBSERIAL_RX_BUFFER_SIZE    64
+
+// returned by usbserial_getc if no character was received
+#define USBSERIAL_NO_DATA           (-1)
+
+/* TYPES *********************************************************************/
+
+/**
+ * Statistics of the buffered USB serial connection
+ */
+typedef struct {
+    uint32_t txBytes;       ///< bytes the USB endpoint took
+    uint32_t rxBytes;       ///< bytes taken from the USB endpoint
+    uint16_t txPackets;     ///< number of completed USB transfers
+    uint16_t txDropped;     ///< bytes rejected because the TX buffer was full or the endpoint failed
+    uint16_t rxOverflows;   ///< services with a full RX buffer, the usbserial library then discards a pending byte
+    uint16_t maxServiceUs;  ///< longest execution time of usbserial_service in us
+} usbserial_stats_t;
+
 /*EXTERNALS------------------------------------------------------------------*/
 
 /**
@@ -14,6 +38,13 @@
  */
 extern FILE * serialout;
 
+/**
+ * Non-blocking file descriptor for the buffered serial connection. Characters
+ * are only copied into the TX buffer and dropped if it is full.
+ * Example fprintf(serialbufout, "Hello World %d\n",2023);
+ */
+extern FILE * serialbufout;
+
 
 /*PROTOTYPES-----------------------------------------------------------------*/
 
@@ -34,10 +65,80 @@ void usbserial_update();
 void usbserial_putc(uint8_t chr);
 
 /**
- *	Reads a character from UART.
- *	@return character
+ * Initializes the TX and RX ring buffers of the buffered, non-blocking
+ * interface. Call after usbserial_init. The buffers are moved to and from
+ * the USB endpoint by usbserial_service.
+ */
+void usbserial_bufferInit(void);
+
+/**
+ * Moves received bytes from the USB endpoint into the RX buffer, sends the
+ * TX buffer in full USB packets and calls usbserial_update. A partly
+ * filled packet is sent if no new data was added since the last call.
+ * Data is only sent while the device is configured, until then it waits in
+ * the TX buffer. A configured host which does not read lets the LUFA stream
+ * write wait up to its stream timeout; the bytes of a failed write are
+ * counted as dropped. Must be called from task context only.
+ */
+void usbserial_service(void);
+
+/**
+ * Runs usbserial_service as a periodic scheduler task instead of the timer
+ * interrupt of the usbserial library, so USB transfers never block inside
+ * an interrupt.
+ *
+ * @param period	service period in ms; 0 only stops the timer interrupt,
+ *                  usbserial_serviceTask then runs in a slot of the frame table
+ */
+void usbserial_startTask(uint16_t period);
+
+/**
+ * usbserial_service as task function, for the frame table of the cyclic
+ * executive
+ *
+ * @param param	unused
+ */
+void usbserial_serviceTask(void * param);
+
+/**
+ * Writes a block of bytes to the TX buffer without blocking. The block is
+ * written completely or not at all. May be called from interrupts.
+ *
+ * @param data	bytes to send
+ * @param len	number of bytes
+ *
+ * @return		false, if the TX buffer had not enough space; the bytes
+ * 				are counted as dropped
+ */
+bool usbserial_write(const uint8_t * data, uint8_t len);
+
+/**
+ * Gets the number of bytes which can be written without being dropped.
+ */
+uint8_t usbserial_txFree(void);
+
+/**
+ * Reads up to len received bytes without blocking.
+ *
+ * @param data	buffer for the received bytes
+ * @param len	size of the buffer
+ *
+ * @return		number of bytes copied to data
+ */
+uint8_t usbserial_read(uint8_t * data, uint8_t len);
+
+/**
+ *	Reads a character from UART without blocking.
+ *	@return character, or USBSERIAL_NO_DATA if nothing was received
+ */
+int16_t usbserial_getc(void);
+
+/**
+ * Gets a copy of the statistics of the buffered interface.
+ *
+ * @param stats	pointer to store the statistics at
  */
-// uint8_t usbserial_getc(void); // TODO
+void usbserial_getStats(usbserial_stats_t * stats);
 
 
 #endif /* SES_USBSERIAL_H_ */
\ No newline at end of file
@@ -0,0 +1,205 @@
+/* INCLUDES ******************************************************************/
+#include <stdlib.h>
+#include <util/atomic.h>
+
+#include "ses_usbserial.h"
+#include "ses_ringbuffer.h"
+#include "ses_scheduler.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+// size of the CDC bulk IN endpoint, one USB packet
+#define USBSERIAL_PACKET_SIZE   64
+
+// DEVICE_STATE_Configured of USB_Device_States_t and ENDPOINT_RWSTREAM_NoError of LUFA
+#define USBSERIAL_DEVICE_CONFIGURED 4
+#define USBSERIAL_STREAM_NO_ERROR   0
+
+/* EXTERNALS *****************************************************************/
+
+/*
+ * Parts of the prebuilt usbserial and LUFA libraries which are not exported
+ * by ses_usbserial.h. The CDC interface is only passed on, so its type is
+ * kept opaque here.
+ */
+typedef struct USB_ClassInfo_CDC_Device usbserial_cdcInterface_t;
+extern usbserial_cdcInterface_t VirtualSerial_CDC_Interface;
+extern volatile uint8_t USB_DeviceState;
+
+uint8_t CDC_Device_SendData(usbserial_cdcInterface_t * const interface, const void * const buffer, const uint16_t length);
+int16_t CDC_Device_ReceiveByte(usbserial_cdcInterface_t * const interface);
+void timer4_stop(void);
+
+/* PRIVATE VARIABLES *********************************************************/
+
+static uint8_t txStorage[USBSERIAL_TX_BUFFER_SIZE];
+static uint8_t rxStorage[USBSERIAL_RX_BUFFER_SIZE];
+
+static ringbuffer_t txBuffer;
+static ringbuffer_t rxBuffer;
+
+// TX fill level after the last service, to detect that no more data is coming
+static uint8_t lastPending = 0;
+
+static usbserial_stats_t stats;
+
+static int usbserial_putcBuffered(char chr, FILE * stream);
+
+static FILE serialbufStream = FDEV_SETUP_STREAM(usbserial_putcBuffered, NULL, _FDEV_SETUP_WRITE);
+
+FILE * serialbufout = &serialbufStream;
+
+/*FUNCTION DEFINITION ********************************************************/
+
+static int usbserial_putcBuffered(char chr, FILE * stream) {
+    bool written;
+
+    // tasks and interrupts may write concurrently
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        written = ringbuffer_put(&txBuffer, (uint8_t)chr);
+        if(!written){
+            stats.txDropped++;
+        }
+    }
+
+    return 0;
+}
+
+void usbserial_serviceTask(void * param) {
+    usbserial_service();
+}
+
+void usbserial_bufferInit(void) {
+    ringbuffer_init(&txBuffer, txStorage, USBSERIAL_TX_BUFFER_SIZE);
+    ringbuffer_init(&rxBuffer, rxStorage, USBSERIAL_RX_BUFFER_SIZE);
+    lastPending = 0;
+}
+
+void usbserial_service(void) {
+    uint16_t start = scheduler_getMicros();
+
+    /* take all received bytes out of the endpoint first, usbserial_update
+    discards a byte which is still pending */
+    while(ringbuffer_free(&rxBuffer) > 0){
+        int16_t received = CDC_Device_ReceiveByte(&VirtualSerial_CDC_Interface);
+        if(received < 0){
+            break;
+        }
+        ringbuffer_put(&rxBuffer, (uint8_t)received);
+        stats.rxBytes++;
+    }
+    if(ringbuffer_free(&rxBuffer) == 0){
+        stats.rxOverflows++;
+    }
+
+    /* send full packets right away, a partial packet only if nothing was
+    added since the last service; without a configured device the bytes
+    wait in the buffer */
+    uint8_t pending = ringbuffer_count(&txBuffer);
+
+    if(USB_DeviceState == USBSERIAL_DEVICE_CONFIGURED &&
+       (pending >= USBSERIAL_PACKET_SIZE || (pending > 0 && pending == lastPending))){
+        uint8_t packet = (pending < USBSERIAL_PACKET_SIZE) ? pending : USBSERIAL_PACKET_SIZE;
+        bool sent = true;
+
+        // at most two contiguous parts if the packet wraps around the buffer end
+        while(packet > 0 && sent){
+            const uint8_t * chunk;
+            uint8_t len = ringbuffer_peekContiguous(&txBuffer, &chunk);
+
+            if(len > packet){
+                len = packet;
+            }
+
+            // a failed part may be partly sent, it is dropped rather than repeated
+            sent = (CDC_Device_SendData(&VirtualSerial_CDC_Interface, chunk, len) == USBSERIAL_STREAM_NO_ERROR);
+            ringbuffer_skip(&txBuffer, len);
+
+            if(sent){
+                stats.txBytes += len;
+            }
+            else{
+                stats.txDropped += len;
+            }
+            packet -= len;
+        }
+        if(sent){
+            stats.txPackets++;
+        }
+    }
+    lastPending = ringbuffer_count(&txBuffer);
+
+    // flush the endpoint and handle the USB device
+    usbserial_update();
+
+    uint16_t elapsed = scheduler_getMicros() - start;
+    if(elapsed > stats.maxServiceUs){
+        stats.maxServiceUs = elapsed;
+    }
+}
+
+void usbserial_startTask(uint16_t period) {
+    static task_descriptor_t serviceTask;
+
+    // the task replaces the timer interrupt of the usbserial library
+    timer4_stop();
+
+    scheduler_remove(&serviceTask);
+    if(period == 0){
+        return;
+    }
+    serviceTask.task   = usbserial_serviceTask;
+    serviceTask.param  = NULL;
+    serviceTask.expire = period;
+    serviceTask.period = period;
+    serviceTask.autoPhase = true;
+    scheduler_add(&serviceTask);
+}
+
+bool usbserial_write(const uint8_t * data, uint8_t len) {
+    bool written;
+
+    // tasks and interrupts may write concurrently
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        written = ringbuffer_write(&txBuffer, data, len);
+        if(!written){
+            stats.txDropped += len;
+        }
+    }
+
+    return written;
+}
+
+uint8_t usbserial_txFree(void) {
+    return ringbuffer_free(&txBuffer);
+}
+
+uint8_t usbserial_read(uint8_t * data, uint8_t len) {
+    uint8_t count = 0;
+
+    while(count < len && ringbuffer_get(&rxBuffer, &data[count])){
+        count++;
+    }
+
+    return count;
+}
+
+int16_t usbserial_getc(void) {
+    uint8_t chr;
+
+    if(!ringbuffer_get(&rxBuffer, &chr)){
+        return USBSERIAL_NO_DATA;
+    }
+
+    return chr;
+}
+
+void usbserial_getStats(usbserial_stats_t * stats_out) {
+    if(stats_out == NULL){
+        return;
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        *stats_out = stats;
+    }
+}
@@ -2,87 +2,122 @@
 #define ALARM_FSM_H_
 /* INCLUDES *****************************************************************/
 #include "ses_scheduler.h"
+#include "ses_fsm.h"
+#include "ses_active.h"
+#include "ses_alarm.h"
 
 /* TYPEDEFS ********************************************************************/
 
 typedef struct fsm_s fsm_t; //< typedef for alarm clock state machine
-typedef struct event_s event_t; //< event type for alarm clock fsm
-
-/** return values */
-enum return_values {
-    RET_HANDLED,    //< event was handled
-    RET_IGNORED,    //< event was ignored; not used in this implementation
-    RET_TRANSITION, //< event was handled and a state transition occurred
-    RET_ERROR		//< pointer containing event was empty (NULL)
+typedef fsm_event_t event_t; //< event type for alarm clock fsm
+
+/* keys of the values kept in the EEPROM store */
+enum {
+	STORE_KEY_CLOCK,	//< calendar timestamp of the system time, saved periodically
+	STORE_KEY_ALARM		//< alarm time and status
 };
 
-/* signals used by the Alarm Clock FSM */
+/* signals used by the Alarm Clock FSM, columns of the transition table */
 enum {
-	ENTRY,				//< entry event
-	EXIT,				//< exit event
 	ROTARY_BUTT_PRESS,	//< rotary button push event
 	PUSH_BUTT_PRESS,	//< push button push event
 	ALARM_TIME,			//< alarm event
 	TIMER_ELAPSED,		//< timing elapsed event
-	NO_EVENT			//< no event handling required
+	ROTARY_TURN,		//< rotary encoder turned, param holds the accelerated steps
+	ROTARY_BUTT_GESTURE,//< rotary button gesture, param holds the GESTURE_* value
+	CLOCK_TICK,			//< the second of the system time changed
+	REMOTE_SET_TIME,	//< system time set by the remote control
+	REMOTE_SET_ALARM,	//< alarm set by the remote control, param holds the FSM_REMOTE_ALARM_* value
+	NO_EVENT			//< no event handling required, number of signals
 };
 
-typedef enum return_values fsm_return_status_t; //< typedef return value
+/* param of REMOTE_SET_ALARM: minute of the day, flag of an enabled alarm */
+#define FSM_REMOTE_ALARM_MINUTES	0x07FF
+#define FSM_REMOTE_ALARM_ENABLE		0x0800
 
-/** typedef for state event handler functions */
-typedef fsm_return_status_t (*state_t)(fsm_t *, const event_t *);
+/* alarm clock state kept across a warm reset, see fsm_getSnapshot */
+typedef struct {
+	uint8_t state;			//< state to resume in
+	uint8_t alarmHour;		//< alarm time
+	uint8_t alarmMinute;
+	uint8_t alarmEnabled;	//< alarm status
+} fsm_snapshot_t;
 
 struct fsm_s {
-    state_t state; //< current state, pointer to event handler
-	bool isAlarmEnabled; //< flag for the alarm status
-    time_t timeSet; //< multi-purpose var for system or alarm time
+    active_t active; //< active object running the state machine, this struct is its context
+	alarm_id_t alarm; //< daily alarm of the alarm engine, enabled in the alarm enabled state
+    time_t timeSet; //< system or alarm time being set
 };
 
-struct event_s {
-    uint8_t signal; //< identifies the type of event
-};
-
-
-
-/* dispatches events to state machine, called in application*/
-inline static void fsm_dispatch(fsm_t * fsm, const event_t * event) {
-
-    const static event_t entryEvent = {.signal = ENTRY};
-    const static event_t exitEvent = {.signal = EXIT};
-
-    state_t last_state = fsm->state;
-    fsm_return_status_t r = fsm->state(fsm, event);
-
-    if (r == RET_TRANSITION) {
-        last_state(fsm, &exitEvent); //< call exit action of last state
-        fsm->state(fsm, &entryEvent); //< call entry action of new state
-    }
-}
 
+/* INIT FUNCTION PREDECLARATION *************************************************/
 
-/* sets and calls initial state of state machine */
-inline static void fsm_init(fsm_t * fsm, state_t init) {
-    //... other initialization
-    event_t entryEvent = {.signal = ENTRY};
-    fsm->state = init;
-    fsm->state(fsm, &entryEvent);
-}
+/**
+ * starts the alarm clock as an active object and subscribes the clock ticks; it resumes a
+ * snapshot, or restores the alarm from the store and starts with setting the system time
+ * hour unless the system time was restored; the alarm engine and the store must be
+ * initialized before
+ *
+ * @param fsm		pointer to the finite-state machine variable containing the state information
+ *
+ * @param priority	priority of the active object
+ *
+ * @param timeValid	true if the system time was restored, the clock starts in normal operation
+ *
+ * @param snapshot	state of before a warm reset, NULL after a cold reset
+ */
+void fsm_initAlarmClock(fsm_t * fsm, uint8_t priority, bool timeValid, const fsm_snapshot_t * snapshot);
 
+/**
+ * gets the state to resume in after a warm reset; a setting in progress is not kept, the alarm
+ * setting resumes in the clock and the system time setting starts over
+ *
+ * @param fsm		pointer to the finite-state machine variable containing the state information
+ *
+ * @param snapshot	stores the state
+ */
+void fsm_getSnapshot(fsm_t * fsm, fsm_snapshot_t * snapshot);
 
-fsm_t AlarmFSM;
+/**
+ * queues an event for the alarm clock, may be called from interrupts
+ *
+ * @param fsm	pointer to the finite-state machine variable containing the state information
+ *
+ * @param signal	signal of the event
+ *
+ * @param param		signal specific value
+ */
+void fsm_post(fsm_t * fsm, uint8_t signal, int16_t param);
 
-/*(INIT) STATE FUNCTION PREDECLARATION *************************************************/
+/* REMOTE CONTROL FUNCTION PREDECLARATION *************************************************/
 
 /**
- * system time hour setter state-function, also init function for the finite-state machnie
+ * sets the system time from outside of the button interface and posts REMOTE_SET_TIME;
+ * if the clock is still waiting for the system time to be set, it continues with normal
+ * operation when the event is dispatched
  *
  * @param fsm	pointer to the finite-state machine variable containing the state information
- * 
- * @param event pointer to an event variable containing the actual event to be handled
  *
- * @return		fsm status about the outcome of the state execution
+ * @param time	new system time
+ */
+void fsm_setSystemTime(fsm_t * fsm, time_t time);
+
+/**
+ * posts REMOTE_SET_ALARM to set the alarm time and enable or disable the alarm from outside
+ * of the button interface; the clock states apply it when the event is dispatched, a setting
+ * started by hand before ignores it
+ *
+ * @param fsm		pointer to the finite-state machine variable containing the state information
+ *
+ * @param hour		alarm hour
+ *
+ * @param minute	alarm minute
+ *
+ * @param enable	true to enable the alarm, false to disable it
+ *
+ * @return		false if a time is being entered by hand or the event queue is full
  */
-fsm_return_status_t state_setSystemTimeHour(fsm_t * fsm, const event_t * event);
+bool fsm_setAlarm(fsm_t * fsm, uint8_t hour, uint8_t minute, bool enable);
 
 
 
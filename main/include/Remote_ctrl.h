@@ -0,0 +1,66 @@
+#ifndef REMOTE_CTRL_H_
+#define REMOTE_CTRL_H_
+/* INCLUDES *****************************************************************/
+#include "Alarm_fsm.h"
+
+/* DEFINES ********************************************************************/
+
+/*
+ * Binary remote control protocol on the USB serial link. Every request and
+ * response is one frame of ses_frame (COBS, CRC-16, 0x00 delimiter).
+ * Request payload:  [command, arguments...]
+ * Response payload: [command | REMOTE_RESPONSE_FLAG, status, data...]
+ * Multi-byte values are little endian.
+ */
+
+/** commands */
+enum remote_commands {
+	REMOTE_CMD_GET_TIME  = 0x01,	//< -> hour, minute, second
+	REMOTE_CMD_SET_TIME  = 0x02,	//< hour, minute, second ->
+	REMOTE_CMD_SET_ALARM = 0x03,	//< hour, minute, enable ->
+	REMOTE_CMD_GET_STATS = 0x04,	//< -> tasks, executions (4), overruns (2), tx dropped (2), rx overflows (2), peak releases per tick
+	REMOTE_CMD_BUTTON    = 0x05,	//< button (REMOTE_BUTTON_*) ->
+	REMOTE_CMD_TELEMETRY = 0x06,	//< ADC channel, sample period in ms (2), 0 stops ->
+	REMOTE_CMD_ADC_NOISE = 0x07,	//< ADC channel, count, mode (REMOTE_ADC_*) -> sum (4), sum of squares (4), min (2), max (2), duration in us (2); not in cyclic builds
+	REMOTE_CMD_GET_DATE  = 0x08,	//< -> year (2), month, day, weekday (0 is Monday), timestamp (4)
+	REMOTE_CMD_SET_DATE  = 0x09,	//< year (2), month, day ->
+	REMOTE_CMD_GET_STORE = 0x0A		//< -> records written (4), EEPROM bytes programmed (4), keys restored at boot
+};
+
+/** response status */
+enum remote_status {
+	REMOTE_OK,				//< command executed
+	REMOTE_ERR_LENGTH,		//< wrong number of arguments
+	REMOTE_ERR_COMMAND,		//< unknown command
+	REMOTE_ERR_ARGUMENT,	//< argument out of range
+	REMOTE_ERR_BUSY			//< command not possible in the current state
+};
+
+/** buttons for REMOTE_CMD_BUTTON */
+enum remote_buttons {
+	REMOTE_BUTTON_PUSH,
+	REMOTE_BUTTON_ROTARY
+};
+
+/** conversion modes for REMOTE_CMD_ADC_NOISE */
+enum remote_adc_modes {
+	REMOTE_ADC_BUSY_WAIT,		//< CPU polls the conversion at full power
+	REMOTE_ADC_NOISE_REDUCED	//< CPU sleeps in ADC noise reduction mode
+};
+
+/** maximum number of conversions of REMOTE_CMD_ADC_NOISE */
+#define REMOTE_ADC_MAX_COUNT	64
+
+#define REMOTE_RESPONSE_FLAG	0x80
+
+/* FUNCTION PROTOTYPES *******************************************************/
+
+/**
+ * Remote_Task: decodes the received USB serial bytes frame by frame and
+ * executes the complete requests
+ *
+ * @param p receives an fsm_t pointer type pointing to the finite-state machine variable
+ */
+void Remote_Task(void * p);
+
+#endif  /* REMOTE_CTRL_H_ */
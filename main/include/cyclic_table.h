@@ -0,0 +1,67 @@
+/* generated by tools/gen_cyclic.py from main/cyclic_tasks.csv, do not edit */
+#ifndef CYCLIC_TABLE_H
+#define CYCLIC_TABLE_H
+
+#include <stddef.h>
+#include <avr/pgmspace.h>
+#include "ses_scheduler.h"
+
+/* minor frame of 1 ms, major frame of 10 ms, utilisation 63% */
+#define CYCLIC_FRAME_MS  1
+#define CYCLIC_FRAMES    10
+
+/* the table is defined only in the file which defines CYCLIC_TABLES */
+#ifdef CYCLIC_TABLES
+
+void ButtonDebouncer_Task(void *);
+void Remote_Task(void *);
+void active_dispatchOne(void *);
+void scheduler_runList(void *);
+void usbserial_serviceTask(void *);
+
+static const scheduler_slot_t cyclic_slots[] PROGMEM = {
+    /* frame 0, 0 ... 1 ms */
+    { scheduler_runList, NULL, 300 },      /* released at 0 ms */
+    { usbserial_serviceTask, NULL, 400 },  /* released at 0 ms */
+    { ButtonDebouncer_Task, NULL, 150 },   /* released at 0 ms */
+    /* frame 1, 1 ... 2 ms */
+    { scheduler_runList, NULL, 300 },      /* released at 1 ms */
+    { active_dispatchOne, NULL, 600 },     /* released at 0 ms */
+    /* frame 2, 2 ... 3 ms */
+    { scheduler_runList, NULL, 300 },      /* released at 2 ms */
+    { usbserial_serviceTask, NULL, 400 },  /* released at 2 ms */
+    /* frame 3, 3 ... 4 ms */
+    { scheduler_runList, NULL, 300 },      /* released at 3 ms */
+    { Remote_Task, &AlarmFSM, 400 },       /* released at 0 ms */
+    /* frame 4, 4 ... 5 ms */
+    { scheduler_runList, NULL, 300 },      /* released at 4 ms */
+    { usbserial_serviceTask, NULL, 400 },  /* released at 4 ms */
+    /* frame 5, 5 ... 6 ms */
+    { scheduler_runList, NULL, 300 },      /* released at 5 ms */
+    { ButtonDebouncer_Task, NULL, 150 },   /* released at 5 ms */
+    /* frame 6, 6 ... 7 ms */
+    { scheduler_runList, NULL, 300 },      /* released at 6 ms */
+    { usbserial_serviceTask, NULL, 400 },  /* released at 6 ms */
+    /* frame 7, 7 ... 8 ms */
+    { scheduler_runList, NULL, 300 },      /* released at 7 ms */
+    /* frame 8, 8 ... 9 ms */
+    { scheduler_runList, NULL, 300 },      /* released at 8 ms */
+    { usbserial_serviceTask, NULL, 400 },  /* released at 8 ms */
+    /* frame 9, 9 ... 10 ms */
+    { scheduler_runList, NULL, 300 },      /* released at 9 ms */
+};
+
+static const uint8_t cyclic_first[CYCLIC_FRAMES + 1] PROGMEM = {
+    0, 3, 5, 7, 9, 11, 13, 15, 16, 18, 19
+};
+
+static const scheduler_table_t cyclic_table = {
+    .frameMs = CYCLIC_FRAME_MS,
+    .frames  = CYCLIC_FRAMES,
+    .first   = cyclic_first,
+    .slots   = cyclic_slots,
+};
+
+#endif /* CYCLIC_TABLES */
+
+#endif /* CYCLIC_TABLE_H */
@@ -1,376 +1,393 @@
 #include "ses_led.h"
+#include "ses_ledpattern.h"
 #include "ses_scheduler.h"
 #include "ses_button.h"
 #include "ses_display.h"
+#include "ses_glyph.h"
+#include "ses_gesture.h"
 #include "ses_usbserial.h"
+#include "ses_store.h"
 #include "Alarm_fsm.h"
 
 /* MACRO *********************************************************/
 // task period time in ms:
 #define TIMER_TASK_EXEC_MS			5000    // 5000ms = 5s timing for the timer task
-#define REDLED_TOGGLER_TASK_EXEC_MS	125     // 125ms 
+#define EVENT_QUEUE_LENGTH			8		// events queued for the alarm clock
+
+/* TYPES *********************************************************/
+
+// value of STORE_KEY_ALARM
+typedef struct {
+	uint8_t hour;
+	uint8_t minute;
+	uint8_t enabled;
+} alarm_record_t;
 
 /* EXTERN FUNCTION DECLARATIONS *********************************/
 //these functions are defined in another file but here are used too 
-extern void RedLED_Toggler_Task();
 extern void Timer_Task();
 
 
 
-/* STATE FUNCTION PREDECLARATIONS *********************************************************/
-
-/**
- * system time minute setter state-function
- *
- * @param fsm	pointer to the finite-state machine variable containing the state information
- * 
- * @param event pointer to an event variable containing the actual event to be handled
- *
- * @return		fsm status about the outcome of the state execution
- */
-static fsm_return_status_t state_setSystemTimeMinute(fsm_t * fsm, const event_t * event);
-
-/**
- * state function for normal operation with disabled alarm
- *
- * @param fsm	pointer to the finite-state machine variable containing the state information
- * 
- * @param event pointer to an event variable containing the actual event to be handled
- *
- * @return		fsm status about the outcome of the state execution
- */
-static fsm_return_status_t state_normalOperationAlarmDisabled(fsm_t * fsm, const event_t * event);
-
-/**
- * state function for normal operation with enabled alarm
- *
- * @param fsm	pointer to the finite-state machine variable containing the state information
- * 
- * @param event pointer to an event variable containing the actual event to be handled
- *
- * @return		fsm status about the outcome of the state execution
- */
-static fsm_return_status_t state_normalOperationAlarmEnabled(fsm_t * fsm, const event_t * event);
-
-/**
- * state function for alarm 
- *
- * @param fsm	pointer to the finite-state machine variable containing the state information
- * 
- * @param event pointer to an event variable containing the actual event to be handled
- *
- * @return		fsm status about the outcome of the state execution
- */
-static fsm_return_status_t state_Alarm(fsm_t * fsm, const event_t * event);
-
-/**
- * state function for alarm time hour setting
- *
- * @param fsm	pointer to the finite-state machine variable containing the state information
- * 
- * @param event pointer to an event variable containing the actual event to be handled
- *
- * @return		fsm status about the outcome of the state execution
- */
-static fsm_return_status_t state_setAlarmTimeHour(fsm_t * fsm, const event_t * event);
+/* STATES *********************************************************************/
 
-/**
- * state function for alarm time minute setting
- *
- * @param fsm	pointer to the finite-state machine variable containing the state information
- * 
- * @param event pointer to an event variable containing the actual event to be handled
+/*
+ * states of the alarm clock, rows of the transition table:
  *
- * @return		fsm status about the outcome of the state execution
+ * SETTING                      rotary button and encoder adjust the time being set
+ *   SET_SYSTEM                 zeroes the time on entry, applies it on exit
+ *     SET_SYSTEM_HOUR          initial state
+ *     SET_SYSTEM_MINUTE
+ *   SET_ALARM                  loads the alarm time on entry, applies it on exit
+ *     SET_ALARM_HOUR
+ *     SET_ALARM_MINUTE
+ * CLOCK                        draws the clock, push button sets the alarm, has history
+ *   CLOCK_ALARM_DISABLED
+ *   CLOCK_ALARM_ENABLED
+ *   ALARM                      alarm is ringing
  */
-static fsm_return_status_t state_setAlarmTimeMinute(fsm_t * fsm, const event_t * event);
-
-
-
-// state function definitions
-
-fsm_return_status_t state_setSystemTimeHour(fsm_t * fsm, const event_t * event){
-
-    // parameter check
-	if(fsm == NULL || event == NULL)
-		return RET_ERROR;
+enum alarm_states {
+	STATE_SETTING,
+	STATE_SET_SYSTEM,
+	STATE_SET_SYSTEM_HOUR,
+	STATE_SET_SYSTEM_MINUTE,
+	STATE_SET_ALARM,
+	STATE_SET_ALARM_HOUR,
+	STATE_SET_ALARM_MINUTE,
+	STATE_CLOCK,
+	STATE_CLOCK_ALARM_DISABLED,
+	STATE_CLOCK_ALARM_ENABLED,
+	STATE_ALARM,
+	STATE_COUNT
+};
+
+
+// helper function definitions
+
+/* adds signed steps to a time field and wraps it into 0 ... modulo - 1 */
+static uint8_t fsm_addSteps(uint8_t value, int16_t steps, uint8_t modulo){
+	int16_t result = (value + steps) % modulo;
+
+	return (result < 0) ? result + modulo : result;
+}
 
-    // state transitions and entry/exit events
+/* steps of a setting event: a press counts one, a turn its detents, a held button sweeps */
+static int16_t fsm_settingSteps(const event_t * event){
 	switch(event->signal){
-		case ENTRY:
-			fsm->timeSet.hour   = 0;
-			fsm->timeSet.minute = 0;
-			break;
-
 		case ROTARY_BUTT_PRESS:
-			++fsm->timeSet.hour;
-			fsm->timeSet.hour %= HOUR_PER_DAY;
-			break;
+			return 1;
 
-		case PUSH_BUTT_PRESS:
-			fsm->state = state_setSystemTimeMinute;
-			return RET_TRANSITION;
-			break;
+		case ROTARY_TURN:
+			return event->param;
 
+		case ROTARY_BUTT_GESTURE:
+			// long press and repeats advance the value, the press itself already counted
+			return (event->param == GESTURE_LONG || event->param == GESTURE_REPEAT) ? 1 : 0;
+	}
+	return 0;
+}
+
+/* displays the time being set and the current setting state */
+static void fsm_drawSetting(fsm_t * fsm){
+	const char * title = "";
+
+	switch(fsm_getState(&fsm->active.machine)){
+		case STATE_SET_SYSTEM_HOUR:		title = "Set System Time: Hour";	break;
+		case STATE_SET_SYSTEM_MINUTE:	title = "Set System Time: Minute";	break;
+		case STATE_SET_ALARM_HOUR:		title = "Set Alarm Time:Hour";		break;
+		case STATE_SET_ALARM_MINUTE:	title = "Set Alarm Time: Minute";	break;
 	}
 
-    // display the time and the current state
 	display_clear();
 	display_setCursor(0,0);
-	fprintf(displayout, "Set System Time: Hour\n");
+	fprintf(displayout, "%s\n", title);
 	fprintf(displayout, "%02d:%02d\n", fsm->timeSet.hour, fsm->timeSet.minute);
 	display_update();
-
-	return RET_IGNORED;
 }
 
+/* keeps the alarm time and status across resets, an unchanged alarm is not written */
+static void fsm_saveAlarm(fsm_t * fsm){
+	time_t alarmTime;
+	alarm_getTime(fsm->alarm, &alarmTime);
 
-fsm_return_status_t state_setSystemTimeMinute(fsm_t * fsm, const event_t * event){
-
-    // parameter check
-	if(fsm == NULL || event == NULL)
-		return RET_ERROR;
-
-    // state transitions and entry/exit events
-	switch(event->signal){
-		case ROTARY_BUTT_PRESS:
-			++fsm->timeSet.minute;
-			fsm->timeSet.minute %= MIN_PER_HOUR;
-			break;
-
-		case PUSH_BUTT_PRESS:
-			fsm->state = state_normalOperationAlarmDisabled;
-			return RET_TRANSITION;
-			break;
-
-		case EXIT:
-			scheduler_setTime(time_wrapper_2_system_time(fsm->timeSet));
-			fsm->timeSet.hour   = 0;
-			fsm->timeSet.minute = 0;
-			break;
-
-	}
+	alarm_record_t record = {.hour = alarmTime.hour, .minute = alarmTime.minute, .enabled = alarm_isEnabled(fsm->alarm)};
+	store_set(STORE_KEY_ALARM, &record, sizeof(record));
+}
 
-   // display the time and the current state
+/* displays the title of a clock state and the whole clock */
+static void fsm_drawClockScreen(const char * title){
 	display_clear();
 	display_setCursor(0,0);
-	fprintf(displayout, "Set System Time: Minute\n");
-	fprintf(displayout, "%02d:%02d\n", fsm->timeSet.hour, fsm->timeSet.minute);
+	fprintf(displayout, "%s\n", title);
+	glyph_drawClock(scheduler_getClock(), true);
 	display_update();
-
-	return RET_IGNORED;
 }
 
 
-fsm_return_status_t state_normalOperationAlarmDisabled(fsm_t * fsm, const event_t * event){
-
-    // parameter check
-	if(fsm == NULL || event == NULL)
-		return RET_ERROR;
+// action definitions, called by the state machine engine with the fsm_t as context
 
+/* the hour setters adjust the hour, the minute setters the minute */
+static uint8_t action_adjust(void * context, const event_t * event){
+	fsm_t * fsm = context;
+	uint8_t state = fsm_getState(&fsm->active.machine);
 
-	fsm->isAlarmEnabled = false;
+	if(state == STATE_SET_SYSTEM_HOUR || state == STATE_SET_ALARM_HOUR)
+		fsm->timeSet.hour = fsm_addSteps(fsm->timeSet.hour, fsm_settingSteps(event), HOUR_PER_DAY);
+	else
+		fsm->timeSet.minute = fsm_addSteps(fsm->timeSet.minute, fsm_settingSteps(event), MIN_PER_HOUR);
 
-    // state transitions and entry/exit events
-	switch(event->signal){
-		case ENTRY:
-			led_yellowOff();
-			break;
-
-		case ROTARY_BUTT_PRESS:
-			fsm->state = state_normalOperationAlarmEnabled;
-			return RET_TRANSITION;
-			break;
+	fsm_drawSetting(fsm);
+	return FSM_STAY;
+}
 
-		case PUSH_BUTT_PRESS:
-			fsm->state = state_setAlarmTimeHour;
-			return RET_TRANSITION;
-			break;
+/* only the changed clock digits are drawn */
+static uint8_t action_drawClock(void * context, const event_t * event){
+	if(glyph_drawClock(scheduler_getClock(), false))
+		display_update();
+	return FSM_STAY;
+}
 
-	}
+/* the clock was waiting for the time: the exit action of the system time setting applies it */
+static uint8_t action_remoteTime(void * context, const event_t * event){
+	fsm_t * fsm = context;
 
-   // display the time and the current state
-	time_t actTime = system_time_wrapper_2_time(scheduler_getTime());
-	display_clear();
-	display_setCursor(0,0);
-	fprintf(displayout, "Clock, alarm disabled\n");
-	fprintf(displayout, "%02d:%02d:%02d\n", actTime.hour, actTime.minute, actTime.second);
-	display_update();
+	fsm->timeSet = scheduler_getClock();
+	return FSM_STAY;
+}
 
-	return RET_IGNORED;
+/* sets the alarm and changes to the clock state of the requested alarm status */
+static uint8_t action_remoteAlarm(void * context, const event_t * event){
+	fsm_t * fsm = context;
+	uint8_t state = fsm_getState(&fsm->active.machine);
+	uint16_t minutes = event->param & FSM_REMOTE_ALARM_MINUTES;
+	bool enable = (event->param & FSM_REMOTE_ALARM_ENABLE) != 0;
+
+	alarm_set(fsm->alarm, minutes / MIN_PER_HOUR, minutes % MIN_PER_HOUR, ALARM_DAILY);
+	fsm_saveAlarm(fsm);
+
+	if(enable && state == STATE_CLOCK_ALARM_DISABLED)
+		return STATE_CLOCK_ALARM_ENABLED;
+	if(!enable && state != STATE_CLOCK_ALARM_DISABLED)
+		return STATE_CLOCK_ALARM_DISABLED;
+	return FSM_STAY;
 }
 
 
-fsm_return_status_t state_normalOperationAlarmEnabled(fsm_t * fsm, const event_t * event){
+// entry and exit action definitions
 
-    // parameter check
-	if(fsm == NULL || event == NULL)
-		return RET_ERROR;
+static void entry_setSystemTime(void * context){
+	fsm_t * fsm = context;
 
-	fsm->isAlarmEnabled = true;
+	fsm->timeSet.hour   = 0;
+	fsm->timeSet.minute = 0;
+}
 
-    // state transitions and entry/exit events
-	switch(event->signal){
-		case ENTRY:
-			led_yellowOn();
-			break;
+static void entry_setting(void * context){
+	fsm_drawSetting(context);
+}
 
-		case ROTARY_BUTT_PRESS:
-			fsm->state = state_normalOperationAlarmDisabled;
-			return RET_TRANSITION;
-			break;
+static void exit_setSystemTime(void * context){
+	fsm_t * fsm = context;
 
-		case PUSH_BUTT_PRESS:
-			fsm->state = state_setAlarmTimeHour;
-			return RET_TRANSITION;
-			break;
+	scheduler_setTime(time_wrapper_2_system_time(fsm->timeSet));
+	fsm->timeSet.hour   = 0;
+	fsm->timeSet.minute = 0;
+}
 
-		case ALARM_TIME:
-			fsm->state = state_Alarm;
-			return RET_TRANSITION;
-			break;
+static void entry_setAlarmTime(void * context){
+	fsm_t * fsm = context;
 
-	}
+	alarm_getTime(fsm->alarm, &fsm->timeSet);
+}
 
-   // display the time and the current state
-	time_t actTime = system_time_wrapper_2_time(scheduler_getTime());
-	display_clear();
-	display_setCursor(0,0);
-	fprintf(displayout, "Clock, alarm enabled\n");
-	fprintf(displayout, "%02d:%02d:%02d\n", actTime.hour, actTime.minute, actTime.second);
-	display_update();
+static void exit_setAlarmTime(void * context){
+	fsm_t * fsm = context;
 
-	return RET_IGNORED;
+	alarm_set(fsm->alarm, fsm->timeSet.hour, fsm->timeSet.minute, ALARM_DAILY);
+	fsm_saveAlarm(fsm);
 }
 
+static void entry_clockAlarmDisabled(void * context){
+	fsm_t * fsm = context;
 
+	alarm_enable(fsm->alarm, false);
+	fsm_saveAlarm(fsm);
+	led_yellowOff();
+	fsm_drawClockScreen("Clock, alarm disabled");
+}
 
-fsm_return_status_t state_Alarm(fsm_t * fsm, const event_t * event){
+static void entry_clockAlarmEnabled(void * context){
+	fsm_t * fsm = context;
 
-    // parameter check
-	if(fsm == NULL || event == NULL)
-		return RET_ERROR;
+	alarm_enable(fsm->alarm, true);
+	fsm_saveAlarm(fsm);
+	led_yellowOn();
+	fsm_drawClockScreen("Clock, alarm enabled");
+}
 
-    // variables for the 5s timer task and the red LED task 
-    static task_descriptor_t Timer_task, RedLED_Toggler_task;
+// 5s timer task of the alarm state
+static task_descriptor_t Timer_task;
 
-	// Timer_task (re)initialization
+static void entry_alarm(void * context){
 	Timer_task.task 	= Timer_Task;
 	//Timer_task.param;	    // not used here
 	Timer_task.expire 	= TIMER_TASK_EXEC_MS;
 	Timer_task.period 	= 0;
+	scheduler_add(&Timer_task);
 
-	// RedLED_Toggler_task (re)initialization
-	RedLED_Toggler_task.task 	= RedLED_Toggler_Task;
-	//RedLED_Toggler_task.param;	// not used here	
-	RedLED_Toggler_task.expire 	= REDLED_TOGGLER_TASK_EXEC_MS;
-	RedLED_Toggler_task.period 	= REDLED_TOGGLER_TASK_EXEC_MS;
+	ledpattern_play(LED_RED, ledpattern_blinkFast);
+	fsm_drawClockScreen("Alarm");
+}
 
-    // state transitions and entry/exit events
-	switch(event->signal){
-		case ENTRY:
-        	scheduler_add(&RedLED_Toggler_task);
-			scheduler_add(&Timer_task);
-            led_redOn();
-			break;
+static void exit_alarm(void * context){
+	scheduler_remove(&Timer_task);
+	ledpattern_stop(LED_RED);
+}
 
-		case ROTARY_BUTT_PRESS:
-			fsm->state = state_normalOperationAlarmEnabled;
-			return RET_TRANSITION;
-			break;
-
-		case PUSH_BUTT_PRESS:
-			fsm->state = state_normalOperationAlarmEnabled;
-			return RET_TRANSITION;
-			break;
-
-		case TIMER_ELAPSED:
-			fsm->state = state_normalOperationAlarmEnabled;
-			return RET_TRANSITION;
-			break;
-
-		case EXIT:
-			scheduler_remove(&Timer_task);
-			scheduler_remove(&RedLED_Toggler_task);
-            led_redOff();
-			break;
 
+/* TRANSITION TABLE ***********************************************************/
+
+static const fsm_state_t alarmStates[STATE_COUNT] PROGMEM = {
+	[STATE_SETTING]					= FSM_COMPOSITE(FSM_NO_STATE, STATE_SET_SYSTEM, NULL, NULL),
+	[STATE_SET_SYSTEM]				= FSM_COMPOSITE(STATE_SETTING, STATE_SET_SYSTEM_HOUR, entry_setSystemTime, exit_setSystemTime),
+	[STATE_SET_SYSTEM_HOUR]			= FSM_STATE(STATE_SET_SYSTEM, entry_setting, NULL),
+	[STATE_SET_SYSTEM_MINUTE]		= FSM_STATE(STATE_SET_SYSTEM, entry_setting, NULL),
+	[STATE_SET_ALARM]				= FSM_COMPOSITE(STATE_SETTING, STATE_SET_ALARM_HOUR, entry_setAlarmTime, exit_setAlarmTime),
+	[STATE_SET_ALARM_HOUR]			= FSM_STATE(STATE_SET_ALARM, entry_setting, NULL),
+	[STATE_SET_ALARM_MINUTE]		= FSM_STATE(STATE_SET_ALARM, entry_setting, NULL),
+	[STATE_CLOCK]					= FSM_COMPOSITE(FSM_NO_STATE, STATE_CLOCK_ALARM_DISABLED, NULL, NULL),
+	[STATE_CLOCK_ALARM_DISABLED]	= FSM_STATE(STATE_CLOCK, entry_clockAlarmDisabled, NULL),
+	[STATE_CLOCK_ALARM_ENABLED]		= FSM_STATE(STATE_CLOCK, entry_clockAlarmEnabled, NULL),
+	[STATE_ALARM]					= FSM_STATE(STATE_CLOCK, entry_alarm, exit_alarm),
+};
+
+/* state x signal, missing cells are passed to the parent state, at the top ignored */
+static const fsm_cell_t alarmTable[STATE_COUNT][NO_EVENT] PROGMEM = {
+	[STATE_SETTING] = {
+		[ROTARY_BUTT_PRESS]		= FSM_ON(action_adjust),
+		[ROTARY_TURN]			= FSM_ON(action_adjust),
+		[ROTARY_BUTT_GESTURE]	= FSM_ON(action_adjust),
+	},
+	[STATE_SET_SYSTEM] = {
+		[REMOTE_SET_TIME]		= FSM_GOTO(action_remoteTime, STATE_CLOCK_ALARM_DISABLED),
+	},
+	[STATE_SET_SYSTEM_HOUR] = {
+		[PUSH_BUTT_PRESS]		= FSM_GOTO(NULL, STATE_SET_SYSTEM_MINUTE),
+	},
+	[STATE_SET_SYSTEM_MINUTE] = {
+		[PUSH_BUTT_PRESS]		= FSM_GOTO(NULL, STATE_CLOCK_ALARM_DISABLED),
+	},
+	[STATE_SET_ALARM_HOUR] = {
+		[PUSH_BUTT_PRESS]		= FSM_GOTO(NULL, STATE_SET_ALARM_MINUTE),
+	},
+	[STATE_SET_ALARM_MINUTE] = {
+		// back to the clock state the setting was started from
+		[PUSH_BUTT_PRESS]		= FSM_GOTO(NULL, FSM_HISTORY(STATE_CLOCK)),
+	},
+	[STATE_CLOCK] = {
+		[PUSH_BUTT_PRESS]		= FSM_GOTO(NULL, STATE_SET_ALARM),
+		[CLOCK_TICK]			= FSM_ON(action_drawClock),
+		[REMOTE_SET_ALARM]		= FSM_CHOOSE(action_remoteAlarm),
+	},
+	[STATE_CLOCK_ALARM_DISABLED] = {
+		[ROTARY_BUTT_PRESS]		= FSM_GOTO(NULL, STATE_CLOCK_ALARM_ENABLED),
+	},
+	[STATE_CLOCK_ALARM_ENABLED] = {
+		[ROTARY_BUTT_PRESS]		= FSM_GOTO(NULL, STATE_CLOCK_ALARM_DISABLED),
+		[ALARM_TIME]			= FSM_GOTO(NULL, STATE_ALARM),
+	},
+	[STATE_ALARM] = {
+		[ROTARY_BUTT_PRESS]		= FSM_GOTO(NULL, STATE_CLOCK_ALARM_ENABLED),
+		[PUSH_BUTT_PRESS]		= FSM_GOTO(NULL, STATE_CLOCK_ALARM_ENABLED),
+		[TIMER_ELAPSED]			= FSM_GOTO(NULL, STATE_CLOCK_ALARM_ENABLED),
+	},
+};
+
+// last active leaf below each composite state
+static uint8_t alarmHistory[STATE_COUNT];
+
+// event queue of the active object
+static event_t alarmQueue[EVENT_QUEUE_LENGTH];
+
+static const fsm_definition_t alarmDefinition = {
+	.table		 = &alarmTable[0][0],
+	.states		 = alarmStates,
+	.history	 = alarmHistory,
+	.stateCount	 = STATE_COUNT,
+	.signalCount = NO_EVENT,
+};
+
+
+void fsm_initAlarmClock(fsm_t * fsm, uint8_t priority, bool timeValid, const fsm_snapshot_t * snapshot){
+	alarm_record_t record = {.enabled = false};
+	uint8_t initial = STATE_SETTING;
+
+	// the alarm stays disabled until the alarm enabled state is entered
+	fsm->alarm = alarm_add(0, 0, ALARM_DAILY);
+	alarm_enable(fsm->alarm, false);
+
+	if(snapshot != NULL){
+		// the entry actions of the state resume it, a ringing alarm rings again
+		alarm_set(fsm->alarm, snapshot->alarmHour, snapshot->alarmMinute, ALARM_DAILY);
+		if(snapshot->state < STATE_COUNT)
+			initial = snapshot->state;
 	}
+	else{
+		if(store_get(STORE_KEY_ALARM, &record, sizeof(record)))
+			alarm_set(fsm->alarm, record.hour, record.minute, ALARM_DAILY);
 
-   // display the time and the current state
-	time_t actTime = system_time_wrapper_2_time(scheduler_getTime());
-	display_clear();
-	display_setCursor(0,0);
-	fprintf(displayout, "Alarm\n");
-	fprintf(displayout, "%02d:%02d:%02d\n", actTime.hour, actTime.minute, actTime.second);
-	display_update();
-
-	return RET_IGNORED;
+		// a restored system time needs no setting
+		if(timeValid)
+			initial = record.enabled ? STATE_CLOCK_ALARM_ENABLED : STATE_CLOCK_ALARM_DISABLED;
+	}
 
+	active_start(&fsm->active, priority, alarmQueue, EVENT_QUEUE_LENGTH, &alarmDefinition, fsm, initial);
+	active_subscribe(&fsm->active, CLOCK_TICK);
 }
 
 
-fsm_return_status_t state_setAlarmTimeHour(fsm_t * fsm, const event_t * event){
+void fsm_getSnapshot(fsm_t * fsm, fsm_snapshot_t * snapshot){
+	time_t alarmTime;
+	alarm_getTime(fsm->alarm, &alarmTime);
 
-    // parameter check
-	if(fsm == NULL || event == NULL)
-		return RET_ERROR;
+	snapshot->alarmHour    = alarmTime.hour;
+	snapshot->alarmMinute  = alarmTime.minute;
+	snapshot->alarmEnabled = alarm_isEnabled(fsm->alarm);
 
-    // state transitions and entry/exit events
-	switch(event->signal){
-		case ROTARY_BUTT_PRESS:
-			++fsm->timeSet.hour;
-			fsm->timeSet.hour %= HOUR_PER_DAY;
-			break;
+	if(fsm_isInState(&fsm->active.machine, STATE_CLOCK))
+		snapshot->state = fsm_getState(&fsm->active.machine);
+	else if(fsm_isInState(&fsm->active.machine, STATE_SET_ALARM))
+		snapshot->state = snapshot->alarmEnabled ? STATE_CLOCK_ALARM_ENABLED : STATE_CLOCK_ALARM_DISABLED;
+	else
+		snapshot->state = STATE_SETTING;
+}
 
-		case PUSH_BUTT_PRESS:
-			fsm->state = state_setAlarmTimeMinute;
-			return RET_TRANSITION;
-			break;
 
-	}
+void fsm_post(fsm_t * fsm, uint8_t signal, int16_t param){
+	event_t event = {.signal = signal, .param = param};
 
-   // display the time and the current state
-	display_clear();
-	display_setCursor(0,0);
-	fprintf(displayout, "Set Alarm Time:Hour\n");
-	fprintf(displayout, "%02d:%02d\n", fsm->timeSet.hour, fsm->timeSet.minute);
-	display_update();
-
-	return RET_IGNORED;
+	active_post(&fsm->active, &event);
 }
 
 
-fsm_return_status_t state_setAlarmTimeMinute(fsm_t * fsm, const event_t * event){
+// remote control function definitions
 
-    // parameter check
-	if(fsm == NULL || event == NULL)
-		return RET_ERROR;
+void fsm_setSystemTime(fsm_t * fsm, time_t time){
 
-    // state transitions and entry/exit events
-	switch(event->signal){
-		case ROTARY_BUTT_PRESS:
-			++fsm->timeSet.minute;
-			fsm->timeSet.minute %= MIN_PER_HOUR;
-			break;
+	scheduler_setTime(time_wrapper_2_system_time(time));
+	fsm_post(fsm, REMOTE_SET_TIME, 0);
+}
 
-		case PUSH_BUTT_PRESS:
-			if(fsm->isAlarmEnabled)
-				fsm->state = state_normalOperationAlarmEnabled;
-			else
-				fsm->state = state_normalOperationAlarmDisabled;
 
-			return RET_TRANSITION;
-			break;
+bool fsm_setAlarm(fsm_t * fsm, uint8_t hour, uint8_t minute, bool enable){
+	event_t event = {.signal = REMOTE_SET_ALARM, .param = hour * MIN_PER_HOUR + minute};
 
-	}
+	if(enable)
+		event.param |= FSM_REMOTE_ALARM_ENABLE;
 
-   // display the time and the current state
-	display_clear();
-	display_setCursor(0,0);
-	fprintf(displayout, "Set Alarm Time: Minute\n");
-	fprintf(displayout, "%02d:%02d\n", fsm->timeSet.hour, fsm->timeSet.minute);
-	display_update();
+	// a time being entered by hand would overwrite the alarm
+	if(!fsm_isInState(&fsm->active.machine, STATE_CLOCK))
+		return false;
 
-	return RET_IGNORED;
+	return active_post(&fsm->active, &event);
 }
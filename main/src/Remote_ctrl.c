@@ -0,0 +1,245 @@
+#include "ses_scheduler.h"
+#include "ses_usbserial.h"
+#include "ses_frame.h"
+#include "ses_telemetry.h"
+#include "ses_adc.h"
+#include "ses_calendar.h"
+#include "ses_alarm.h"
+#include "ses_store.h"
+#include "Remote_ctrl.h"
+
+/* EXTERN FUNCTION DECLARATIONS *********************************/
+//these functions are defined in another file but here are used too
+extern void PushButtonCallback();
+extern void RotaryButtonCallback();
+
+/* VARIABLES *****************************************************/
+
+// decoder state of the request frame being received
+static frame_decoder_t decoder;
+
+/* FUNCTION DEFINITIONS *****************************************************/
+
+/**
+ * encodes a response payload and queues it for sending; dropped if the USB TX buffer is full
+ */
+static void remote_respond(const uint8_t * payload, uint8_t len){
+	uint8_t frame[FRAME_ENCODED_SIZE(FRAME_MAX_PAYLOAD)];
+
+	len = frame_encode(payload, len, frame);
+	usbserial_write(frame, len);
+}
+
+
+#if SCHEDULER_MODE != SCHEDULER_CYCLIC
+/**
+ * converts an ADC channel count times in a row and appends the statistics
+ * of the results, for comparing the noise of the conversion modes
+ *
+ * @return	response status
+ */
+static uint8_t remote_adcNoise(const uint8_t * request, uint8_t * response, uint8_t * responseLen){
+	uint8_t channel = request[1], count = request[2], mode = request[3];
+	uint32_t sum = 0, sumSquares = 0;
+	uint16_t min = UINT16_MAX, max = 0;
+
+	if(count == 0 || count > REMOTE_ADC_MAX_COUNT || mode > REMOTE_ADC_NOISE_REDUCED)
+		return REMOTE_ERR_ARGUMENT;
+	if(adc_getLatest(channel) == ADC_INVALID_CHANNEL)
+		return REMOTE_ERR_ARGUMENT;
+
+	// busy waiting conversions need the ADC for themselves
+	if(mode == REMOTE_ADC_BUSY_WAIT)
+		adc_stopSampler();
+
+	uint16_t start = scheduler_getMicros();
+	for(uint8_t i = 0; i < count; i++){
+		uint16_t sample = (mode == REMOTE_ADC_BUSY_WAIT) ? adc_read(channel) : adc_readNoiseReduced(channel);
+
+		sum += sample;
+		sumSquares += (uint32_t)sample * sample;
+		if(sample < min)
+			min = sample;
+		if(sample > max)
+			max = sample;
+	}
+	uint16_t duration = scheduler_getMicros() - start;
+
+	if(mode == REMOTE_ADC_BUSY_WAIT)
+		adc_startSampler();
+
+	for(uint8_t i = 0; i < 4; i++)
+		response[(*responseLen)++] = (uint8_t)(sum >> (8 * i));
+	for(uint8_t i = 0; i < 4; i++)
+		response[(*responseLen)++] = (uint8_t)(sumSquares >> (8 * i));
+	response[(*responseLen)++] = (uint8_t)min;
+	response[(*responseLen)++] = (uint8_t)(min >> 8);
+	response[(*responseLen)++] = (uint8_t)max;
+	response[(*responseLen)++] = (uint8_t)(max >> 8);
+	response[(*responseLen)++] = (uint8_t)duration;
+	response[(*responseLen)++] = (uint8_t)(duration >> 8);
+	return REMOTE_OK;
+}
+#endif
+
+
+/**
+ * executes one request and appends the response data behind the status byte
+ *
+ * @return	response status
+ */
+static uint8_t remote_execute(fsm_t * fsm, const uint8_t * request, uint8_t len, uint8_t * response, uint8_t * responseLen){
+
+	switch(request[0]){
+		case REMOTE_CMD_GET_TIME: {
+			if(len != 1)
+				return REMOTE_ERR_LENGTH;
+
+			time_t actTime = scheduler_getClock();
+			response[(*responseLen)++] = actTime.hour;
+			response[(*responseLen)++] = actTime.minute;
+			response[(*responseLen)++] = actTime.second;
+			return REMOTE_OK;
+		}
+
+		case REMOTE_CMD_SET_TIME: {
+			if(len != 4)
+				return REMOTE_ERR_LENGTH;
+			if(request[1] >= HOUR_PER_DAY || request[2] >= MIN_PER_HOUR || request[3] >= SEC_PER_MIN)
+				return REMOTE_ERR_ARGUMENT;
+
+			time_t newTime = {.hour = request[1], .minute = request[2], .second = request[3], .milli = 0};
+			fsm_setSystemTime(fsm, newTime);
+			return REMOTE_OK;
+		}
+
+		case REMOTE_CMD_SET_ALARM:
+			if(len != 4)
+				return REMOTE_ERR_LENGTH;
+			if(request[1] >= HOUR_PER_DAY || request[2] >= MIN_PER_HOUR)
+				return REMOTE_ERR_ARGUMENT;
+
+			return fsm_setAlarm(fsm, request[1], request[2], request[3] != 0) ? REMOTE_OK : REMOTE_ERR_BUSY;
+
+		case REMOTE_CMD_GET_STATS: {
+			if(len != 1)
+				return REMOTE_ERR_LENGTH;
+
+			scheduler_stats_t schedStats;
+			usbserial_stats_t usbStats;
+			scheduler_getStats(&schedStats);
+			usbserial_getStats(&usbStats);
+
+			response[(*responseLen)++] = schedStats.tasks;
+			for(uint8_t i = 0; i < 4; i++)
+				response[(*responseLen)++] = (uint8_t)(schedStats.executions >> (8 * i));
+			response[(*responseLen)++] = (uint8_t)schedStats.overruns;
+			response[(*responseLen)++] = (uint8_t)(schedStats.overruns >> 8);
+			response[(*responseLen)++] = (uint8_t)usbStats.txDropped;
+			response[(*responseLen)++] = (uint8_t)(usbStats.txDropped >> 8);
+			response[(*responseLen)++] = (uint8_t)usbStats.rxOverflows;
+			response[(*responseLen)++] = (uint8_t)(usbStats.rxOverflows >> 8);
+			response[(*responseLen)++] = schedStats.peakReleases;
+			return REMOTE_OK;
+		}
+
+		case REMOTE_CMD_BUTTON:
+			if(len != 2)
+				return REMOTE_ERR_LENGTH;
+
+			// same path as a debounced button press
+			if(request[1] == REMOTE_BUTTON_PUSH)
+				PushButtonCallback();
+			else if(request[1] == REMOTE_BUTTON_ROTARY)
+				RotaryButtonCallback();
+			else
+				return REMOTE_ERR_ARGUMENT;
+			return REMOTE_OK;
+
+		case REMOTE_CMD_TELEMETRY:
+			if(len != 4)
+				return REMOTE_ERR_LENGTH;
+
+			return telemetry_setPeriod(request[1], request[2] | ((uint16_t)request[3] << 8)) ? REMOTE_OK : REMOTE_ERR_ARGUMENT;
+
+		case REMOTE_CMD_ADC_NOISE:
+			if(len != 4)
+				return REMOTE_ERR_LENGTH;
+
+#if SCHEDULER_MODE == SCHEDULER_CYCLIC
+			// the conversions take ms and the noise reduction halts the tick, frames of the table would be skipped
+			return REMOTE_ERR_COMMAND;
+#else
+			return remote_adcNoise(request, response, responseLen);
+#endif
+
+		case REMOTE_CMD_GET_DATE: {
+			if(len != 1)
+				return REMOTE_ERR_LENGTH;
+
+			date_t date;
+			calendar_getDate(&date);
+			calendar_timestamp_t timestamp = calendar_getTimestamp();
+			response[(*responseLen)++] = (uint8_t)date.year;
+			response[(*responseLen)++] = (uint8_t)(date.year >> 8);
+			response[(*responseLen)++] = date.month;
+			response[(*responseLen)++] = date.day;
+			response[(*responseLen)++] = date.weekday;
+			for(uint8_t i = 0; i < 4; i++)
+				response[(*responseLen)++] = (uint8_t)(timestamp >> (8 * i));
+			return REMOTE_OK;
+		}
+
+		case REMOTE_CMD_SET_DATE: {
+			if(len != 5)
+				return REMOTE_ERR_LENGTH;
+			if(!calendar_setDate(request[1] | ((uint16_t)request[2] << 8), request[3], request[4]))
+				return REMOTE_ERR_ARGUMENT;
+
+			// the weekday alarms follow the calendar
+			date_t date;
+			calendar_getDate(&date);
+			alarm_setWeekday(date.weekday);
+			return REMOTE_OK;
+		}
+
+		case REMOTE_CMD_GET_STORE: {
+			if(len != 1)
+				return REMOTE_ERR_LENGTH;
+
+			store_stats_t storeStats;
+			store_getStats(&storeStats);
+
+			for(uint8_t i = 0; i < 4; i++)
+				response[(*responseLen)++] = (uint8_t)(storeStats.records >> (8 * i));
+			for(uint8_t i = 0; i < 4; i++)
+				response[(*responseLen)++] = (uint8_t)(storeStats.bytes >> (8 * i));
+			response[(*responseLen)++] = storeStats.restored;
+			return REMOTE_OK;
+		}
+
+	}
+
+	return REMOTE_ERR_COMMAND;
+}
+
+
+void Remote_Task(void * p){
+	fsm_t * fsm = (fsm_t *)p;
+	int16_t received;
+
+	// at most the content of the RX buffer per call
+	while((received = usbserial_getc()) != USBSERIAL_NO_DATA){
+
+		uint8_t len = frame_decode(&decoder, (uint8_t)received);
+		if(len == 0)
+			continue;
+
+		uint8_t response[FRAME_MAX_PAYLOAD];
+		uint8_t responseLen = 2;
+
+		response[0] = decoder.data[0] | REMOTE_RESPONSE_FLAG;
+		response[1] = remote_execute(fsm, decoder.data, len, response, &responseLen);
+		remote_respond(response, responseLen);
+	}
+}
@@ -1,21 +1,65 @@
+#include <avr/wdt.h>
+
 #include "ses_led.h"
+#include "ses_ledpattern.h"
 #include "ses_scheduler.h"
 #include "ses_button.h"
+#include "ses_rotary.h"
 #include "ses_display.h"
 #include "ses_usbserial.h"
+#include "ses_log.h"
+#include "ses_adc.h"
+#include "ses_telemetry.h"
+#include "ses_alarm.h"
+#include "ses_calendar.h"
+#include "ses_active.h"
+#include "ses_store.h"
+#include "ses_snapshot.h"
 #include "Alarm_fsm.h"
+#include "Remote_ctrl.h"
 
 /* MACRO *********************************************************/
 // task period time in ms:
-#define BUTTON_TASK_EXEC_MS			5	// 5ms period time for the button debouncer task
-#define FSM_TASK_EXEC_MS			1	// 1ms period time for the FSM task running the finite-state machine
+#define BUTTON_TASK_EXEC_MS			BUTTON_CHECK_PERIOD_MS	// 5ms period time for the button debouncer task
+#define USBSERIAL_TASK_EXEC_MS		2	// 2ms period time for moving the USB serial buffers
+#define REMOTE_TASK_EXEC_MS			10	// 10ms period time for the remote control request handling
+#define LOG_TASK_EXEC_MS			10	// 10ms period time for sending the log records
+#define STORE_TASK_EXEC_MS			100	// 100ms period time for writing the changed values to the EEPROM
+
+// the system time is saved every CLOCK_SAVE_PERIOD_MIN minutes and when it is set
+#define CLOCK_SAVE_PERIOD_MIN		10
+
+// priority of the alarm clock active object
+#define ALARM_FSM_PRIORITY			1
+
+// the watchdog resets a scheduler loop which hangs for longer, the reset is warm
+#define WATCHDOG_TIMEOUT			WDTO_500MS
+
+// BUTT_DEBOUNCING_TASK polls the buttons all the time, BUTT_DEBOUNCING_EVENT only after a pin change;
+// the frame table of the cyclic executive polls them
+#if SCHEDULER_MODE == SCHEDULER_CYCLIC
+#define BUTTON_DEBOUNCING			BUTT_DEBOUNCING_TASK
+#else
+#define BUTTON_DEBOUNCING			BUTT_DEBOUNCING_EVENT
+#endif
+
+/* TYPES *********************************************************/
+
+// kept across a warm reset, saved every second
+typedef struct {
+	fsm_snapshot_t fsm;
+	date_t date;
+	uint16_t day;		// day of the scheduler clock the date belongs to
+	uint8_t clockValid;
+} warm_state_t;
 
 /* VARIABLES *****************************************************/
 
-// FSM event variables
-volatile event_t timerEvent;
-volatile event_t pushBtnEvent;
-volatile event_t rotBtnEvent;
+// the alarm clock, an active object fed by the callbacks below
+static fsm_t AlarmFSM;
+
+// the system time was set or restored, only then it is saved
+static bool clockValid = false;
 
 /*TASK FUNCTION DEFINITION *************************************************/
 
@@ -30,56 +74,76 @@ void ButtonDebouncer_Task(void* p){
 
 
 /**
-* FSM_Task: dispatches the finite-State machine 
-*
-* @param p receives an fsm_t pointer type pointing to the finite-state machine variable
+* Clock_Save: keeps the system time and date across resets as a calendar timestamp
 */
-void FSM_Task(void * p){
-	fsm_t* fsm = (fsm_t*)p;
-	event_t alarmEvent;
-
-	// get the current system time in human readable format
-	time_t actTime = system_time_wrapper_2_time(scheduler_getTime());
-
-	// green led blinks synchronously with the second counter
-	if(actTime.second % 2 == 0)
-		led_greenOn();
-	else
-		led_greenOff();
-	
-	// check the timer event
-	fsm_dispatch(fsm, (const event_t*)&timerEvent);
-	timerEvent.signal = NO_EVENT;
-	
-	// check the push button event
-	fsm_dispatch(fsm, (const event_t*)&pushBtnEvent);
-	pushBtnEvent.signal = NO_EVENT;
+static void Clock_Save(void){
+	calendar_timestamp_t now = calendar_getTimestamp();
 
-	// check the rotary button event
-	fsm_dispatch(fsm, (const event_t*)&rotBtnEvent);
-	rotBtnEvent.signal = NO_EVENT;
+	store_set(STORE_KEY_CLOCK, &now, sizeof(now));
+}
 
-	// check the alarm event
-	alarmEvent.signal = (actTime.hour == fsm->timeSet.hour && actTime.minute == fsm->timeSet.minute && actTime.second == fsm->timeSet.second) ? ALARM_TIME : NO_EVENT;
-	fsm_dispatch(fsm, (const event_t*)&alarmEvent);
+/**
+* Clock_Restore: sets the system time and date to the last saved timestamp, the clock
+*				did not run while the board was off
+*
+* @return true if a valid timestamp was restored
+*/
+static bool Clock_Restore(void){
+	calendar_timestamp_t saved;
+	date_t date;
+	time_t time;
 
+	if(!store_get(STORE_KEY_CLOCK, &saved, sizeof(saved)) || !calendar_unpack(saved, &date, &time))
+		return false;
 
+	calendar_setDate(date.year, date.month, date.day);
+	scheduler_setTime(time_wrapper_2_system_time(time));
+	return true;
 }
 
+
 /**
-* RedLED_Toggler_Task: toggles the red LED per call 
+* Timer_Task: sets an event for the FSM signaling the predefined time elapsed 
 */
-void RedLED_Toggler_Task(){
+void Timer_Task(){
+	fsm_post(&AlarmFSM, TIMER_ELAPSED, 0);
+}
 
-	led_redToggle();
 
+/**
+* AlarmCallback: called by the alarm engine when an alarm fires and sets an event for the FSM
+*/
+void AlarmCallback(alarm_id_t id){
+	fsm_post(&AlarmFSM, ALARM_TIME, id);
 }
 
+
 /**
-* Timer_Task: sets an event for the FSM signaling the predefined time elapsed 
+* ClockCallback: called by the scheduler when the second of the system time changed,
+*				publishes the clock tick
 */
-void Timer_Task(){
-	timerEvent.signal = TIMER_ELAPSED;
+void ClockCallback(uint8_t changed){
+	// the alarms fire relative to the new time
+	if(changed & SCHEDULER_CLOCK_SET){
+		alarm_reschedule();
+		clockValid = true;
+		Clock_Save();
+	}
+	else if(clockValid && (changed & SCHEDULER_CLOCK_MINUTE) && scheduler_getClock().minute % CLOCK_SAVE_PERIOD_MIN == 0){
+		Clock_Save();
+	}
+
+	if(!(changed & SCHEDULER_CLOCK_SECOND))
+		return;
+
+	event_t tick = {.signal = CLOCK_TICK};
+	active_publish(&tick);
+
+	warm_state_t warm;
+	fsm_getSnapshot(&AlarmFSM, &warm.fsm);
+	warm.day        = calendar_getDate(&warm.date);
+	warm.clockValid = clockValid;
+	snapshot_save(&warm, sizeof(warm));
 }
 
 
@@ -88,7 +152,7 @@ void Timer_Task(){
 *						and sets an event for the FSM
 */
 void PushButtonCallback(){
-	pushBtnEvent.signal = PUSH_BUTT_PRESS;
+	fsm_post(&AlarmFSM, PUSH_BUTT_PRESS, 0);
 
 }
 
@@ -97,13 +161,47 @@ void PushButtonCallback(){
 *						and sets an event for the FSM
 */
 void RotaryButtonCallback(){
-	rotBtnEvent.signal = ROTARY_BUTT_PRESS;
+	fsm_post(&AlarmFSM, ROTARY_BUTT_PRESS, 0);
 
 }
 
+/**
+* ButtonGestureCallback: called by the button driver if a gesture was recognized
+*						and sets an event for the FSM for the rotary button gestures
+*/
+void ButtonGestureCallback(uint8_t button, uint8_t gesture){
+	if(button == BUTTON_ROTARY)
+		fsm_post(&AlarmFSM, ROTARY_BUTT_GESTURE, gesture);
+}
+
+/**
+* RotaryCallback: called by the rotary encoder interrupt for every detent
+*				and sets an event for the FSM with the accelerated steps
+*/
+void RotaryCallback(int8_t steps){
+	fsm_post(&AlarmFSM, ROTARY_TURN, steps);
+}
+
+
+#if SCHEDULER_MODE == SCHEDULER_CYCLIC
+// the frame table generated from main/cyclic_tasks.csv refers to the tasks above
+#define CYCLIC_TABLES
+#include "cyclic_table.h"
+#endif
+
 
 int main(void) {
 
+	// the boot timer runs until the scheduler starts
+	snapshot_init();
+
+	// after a warm reset the clock runs on, nothing may read it before
+	warm_state_t state;
+	bool warm = snapshot_restore(&state, sizeof(state));
+	warm = scheduler_restoreTime(warm) && warm;
+	if(warm)
+		warm = calendar_restore(&state.date, state.day);
+
 	// LED initializations
 	led_redInit();
 	led_greenInit();
@@ -112,32 +210,87 @@ int main(void) {
 	// display initialization
 	display_init();
 
+	// buffered USB serial initialization
+	usbserial_init();
+	usbserial_bufferInit();
+#if SCHEDULER_MODE == SCHEDULER_CYCLIC
+	// the frame table runs the USB service, only the timer interrupt of the library stops
+	usbserial_startTask(0);
+#else
+	usbserial_startTask(USBSERIAL_TASK_EXEC_MS);
+#endif
+	log_startTask(LOG_TASK_EXEC_MS);
+
+	// sensor telemetry initialization, channels are started by the remote control
+	adc_init();
+	adc_startSampler();
+	telemetry_init();
+
 	// button initialization
-	button_init(BUTT_DEBOUNCING_TASK);
+	button_init(BUTTON_DEBOUNCING);
 	button_setPushButtonCallback(PushButtonCallback);
 	button_setRotaryButtonCallback(RotaryButtonCallback);
-
-	// FSM initialization
-	fsm_init((fsm_t*)&AlarmFSM, state_setSystemTimeHour);
-
-	// Task descriptors for the LED task and the ButtonDebouncer task
-	task_descriptor_t ButtonDebouncer_task, FSM_task;
-
-	// ButtonDebouncer task initialization
+	button_setGestureCallback(ButtonGestureCallback);
+	rotary_init();
+	rotary_setCallback(RotaryCallback);
+
+	// the saved clock and alarm are restored before the FSM starts, a warm reset kept them
+	store_init();
+	store_startTask(STORE_TASK_EXEC_MS);
+	bool restored;
+	if(warm){
+		clockValid = state.clockValid;
+		restored = clockValid;
+	}
+	else
+		restored = Clock_Restore();
+
+	// alarm engine and FSM initialization, the FSM owns the daily alarm and runs as an active object
+	alarm_init(AlarmCallback);
+	date_t today;
+	calendar_getDate(&today);
+	alarm_setWeekday(today.weekday);
+	fsm_initAlarmClock(&AlarmFSM, ALARM_FSM_PRIORITY, restored, warm ? &state.fsm : NULL);
+
+#if SCHEDULER_MODE == SCHEDULER_CYCLIC
+	// the button debouncer, the remote control, the USB service and the FSM dispatch run in the frames of the table
+	scheduler_setTable(&cyclic_table);
+#else
+	// Task descriptors for the ButtonDebouncer and remote control tasks
+	task_descriptor_t ButtonDebouncer_task, Remote_task;
+
+	// ButtonDebouncer task initialization, in event mode the button driver arms its own task
 	ButtonDebouncer_task.task 	= ButtonDebouncer_Task;
 	//ButtonDebouncer_task.param;	// parameter is empty here 
 	ButtonDebouncer_task.expire = BUTTON_TASK_EXEC_MS;
 	ButtonDebouncer_task.period = BUTTON_TASK_EXEC_MS;
-	scheduler_add(&ButtonDebouncer_task);
-
-	// FSM task initialization
-	FSM_task.task 	= FSM_Task;
-	FSM_task.param  = &AlarmFSM;
-	FSM_task.expire = FSM_TASK_EXEC_MS;
-	FSM_task.period = FSM_TASK_EXEC_MS;
-	scheduler_add(&FSM_task);
+	ButtonDebouncer_task.autoPhase = true;
+	if(BUTTON_DEBOUNCING == BUTT_DEBOUNCING_TASK)
+		scheduler_add(&ButtonDebouncer_task);
+
+	// remote control task initialization
+	Remote_task.task 	= Remote_Task;
+	Remote_task.param  	= &AlarmFSM;
+	Remote_task.expire 	= REMOTE_TASK_EXEC_MS;
+	Remote_task.period 	= REMOTE_TASK_EXEC_MS;
+	Remote_task.autoPhase = true;
+	scheduler_add(&Remote_task);
+#endif
+
+	// green LED is on in the even seconds, the pattern task drives all LEDs
+	ledpattern_playSynced(LED_GREEN, ledpattern_blinkSeconds, 2);
+	scheduler_setClockCallback(ClockCallback);
+
+	// the clock did not run during the reset and the initialization
+	uint16_t boot = snapshot_bootTime();
+	if(warm){
+		scheduler_advanceTime(SNAPSHOT_RESET_MS + boot);
+		alarm_reschedule();
+	}
+	LOG2(SNAPSHOT_BOOT, warm, boot);
 
 	scheduler_init();
+	wdt_enable(WATCHDOG_TIMEOUT);
 
 	// Enable global interrupt
 	sei();
@@ -0,0 +1,38 @@
+#ifndef HOST_TEST_H_
+#define HOST_TEST_H_
+
+/* INCLUDES ******************************************************************/
+#include <stdio.h>
+
+/* DEFINES & MACROS **********************************************************/
+
+/* counts and reports a failed condition, the test goes on */
+#define CHECK(cond, ...)                                                    \
+    do {                                                                    \
+        hostTestChecks++;                                                   \
+        if(!(cond)){                                                        \
+            if(hostTestFailures++ < HOST_TEST_MAX_REPORTS){                 \
+                printf("%s:%d: ", __FILE__, __LINE__);                      \
+                printf(__VA_ARGS__);                                        \
+                printf("\n");                                               \
+            }                                                               \
+        }                                                                   \
+    } while(0)
+
+/* failures printed, the rest is only counted */
+#define HOST_TEST_MAX_REPORTS   20
+
+/* PRIVATE VARIABLES *********************************************************/
+
+static unsigned long hostTestChecks = 0;
+static unsigned long hostTestFailures = 0;
+
+/* FUNCTION DEFINITION *******************************************************/
+
+/* prints the summary, the result is the exit code of the test */
+static inline int host_testResult(const char * name) {
+    printf("%s: %lu checks, %lu failed\n", name, hostTestChecks, hostTestFailures);
+    return hostTestFailures != 0;
+}
+
+#endif /* HOST_TEST_H_ */
@@ -0,0 +1,10 @@
+/* host stub of the avr-libc header for the host tests, the test which uses
+it defines the functions on its emulated EEPROM */
+#ifndef HOST_STUB_AVR_EEPROM_H_
+#define HOST_STUB_AVR_EEPROM_H_
+
+#include <stddef.h>
+
+void eeprom_read_block(void * dst, const void * src, size_t n);
+
+#endif /* HOST_STUB_AVR_EEPROM_H_ */
@@ -0,0 +1,10 @@
+/* host stub of the avr-libc header for the host tests, an interrupt service
+routine is an ordinary function the test calls */
+#ifndef HOST_STUB_AVR_INTERRUPT_H_
+#define HOST_STUB_AVR_INTERRUPT_H_
+
+#define ISR(vector)             void vector(void)
+#define sei()
+#define cli()
+
+#endif /* HOST_STUB_AVR_INTERRUPT_H_ */
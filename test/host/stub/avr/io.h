@@ -0,0 +1,29 @@
+/* host stub of the avr-libc header for the host tests, the registers used by
+the tested modules are ordinary variables */
+#ifndef HOST_STUB_AVR_IO_H_
+#define HOST_STUB_AVR_IO_H_
+
+#include <stdint.h>
+
+static volatile uint8_t DDRB, PORTB, PINB;
+static volatile uint8_t DDRD, PORTD, PIND;
+static volatile uint8_t DDRF, PORTF, PINF;
+static volatile uint8_t PCMSK0, PCICR;
+
+#define PCIE0                   0
+
+/* EEPROM of the ATmega32U4, a test which emulates the EEPROM defines EEDR
+itself before the module is included */
+static volatile uint8_t EECR;
+static volatile uint16_t EEAR;
+#ifndef EEDR
+static volatile uint8_t EEDR;
+#endif
+
+#define EERE                    0
+#define EEPE                    1
+#define EEMPE                   2
+#define EERIE                   3
+#define E2END                   0x3FF
+
+#endif /* HOST_STUB_AVR_IO_H_ */
@@ -0,0 +1,16 @@
+/* host stub of the avr-libc header for the host tests, flash is ordinary memory */
+#ifndef HOST_STUB_AVR_PGMSPACE_H_
+#define HOST_STUB_AVR_PGMSPACE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(s)                 (s)
+#define pgm_read_byte(p)        (*(const uint8_t *)(p))
+#define pgm_read_word(p)        (*(const uint16_t *)(p))
+#define pgm_read_dword(p)       (*(const uint32_t *)(p))
+#define pgm_read_ptr(p)         (*(void * const *)(p))
+#define memcpy_P                memcpy
+
+#endif /* HOST_STUB_AVR_PGMSPACE_H_ */
@@ -0,0 +1,10 @@
+/* host stub of the avr-libc header for the host tests, which run single-threaded */
+#ifndef HOST_STUB_UTIL_ATOMIC_H_
+#define HOST_STUB_UTIL_ATOMIC_H_
+
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_FORCEON
+
+#define ATOMIC_BLOCK(type)  for(int atomicOnce = 1; atomicOnce; atomicOnce = 0)
+
+#endif /* HOST_STUB_UTIL_ATOMIC_H_ */
@@ -0,0 +1,14 @@
+/* host stub of the avr-libc header for the host tests */
+#ifndef HOST_STUB_UTIL_CRC16_H_
+#define HOST_STUB_UTIL_CRC16_H_
+
+#include <stdint.h>
+
+/* same arithmetic as the avr-libc implementation */
+static inline uint16_t _crc_ccitt_update(uint16_t crc, uint8_t data) {
+    data ^= (uint8_t)crc;
+    data ^= (uint8_t)(data << 4);
+    return ((((uint16_t)data << 8) | (crc >> 8)) ^ (uint8_t)(data >> 4) ^ ((uint16_t)data << 3));
+}
+
+#endif /* HOST_STUB_UTIL_CRC16_H_ */
@@ -0,0 +1,194 @@
+/*
+ * Host bench of lib/ses/ses_adc_filter.c.
+ *
+ * Synthetic 10 bit streams run through the filter pipeline: a constant, a
+ * noisy level with full scale spikes, spikes among the first samples and a
+ * step. The noise reduction and the host time per sample of every
+ * configuration are printed; the cycles on the target are not measured here.
+ */
+
+/* INCLUDES ******************************************************************/
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "host_test.h"
+#include "ses_adc_filter.c"
+
+/* DEFINES & MACROS **********************************************************/
+
+#define BENCH_LEVEL             500
+#define BENCH_NOISE             10      /* uniform noise of +/- LSB */
+#define BENCH_SPIKE_PERIOD      97      /* a full scale spike every n samples */
+#define BENCH_SAMPLES           200000L
+#define BENCH_TIMING_SAMPLES    2000000L
+#define RAW_MAX                 1023
+
+/* PRIVATE VARIABLES *********************************************************/
+
+static const adc_filterConfig_t configs[] = {
+    { 0, 0, 0, 0 },
+    { 3, 0, 0, 0 },
+    { 5, 0, 0, 0 },
+    { 0, 2, 0, 0 },
+    { 0, 0, 3, 0 },
+    { 0, 0, 0, 3 },
+    { 5, 2, 3, 3 },
+    { 5, 3, 3, 7 },
+};
+
+#define CONFIGS                 (sizeof(configs) / sizeof(configs[0]))
+
+/* FUNCTION DEFINITION *******************************************************/
+
+static uint16_t bench_noisySample(long n) {
+    if(n % BENCH_SPIKE_PERIOD == BENCH_SPIKE_PERIOD - 1){
+        return (rand() & 1) ? RAW_MAX : 0;
+    }
+    return BENCH_LEVEL - BENCH_NOISE + rand() % (2 * BENCH_NOISE + 1);
+}
+
+static void bench_describe(const adc_filterConfig_t * config, char * text, size_t size) {
+    snprintf(text, size, "median %u oversample %u average %u iir %u",
+             config->medianSize, config->oversampleBits, config->averageShift, config->iirShift);
+}
+
+// a constant is passed unchanged, scaled by the oversampling
+static void test_constant(void) {
+    for(unsigned c = 0; c < CONFIGS; c++){
+        for(uint16_t level = 0; level <= RAW_MAX; level += 31){
+            adc_filter_t filter;
+            uint16_t output;
+            unsigned outputs = 0;
+
+            adc_filterInit(&filter, &configs[c]);
+            for(unsigned n = 0; n < 1000; n++){
+                if(adc_filterPush(&filter, level, &output)){
+                    outputs++;
+                    CHECK(output == level << configs[c].oversampleBits,
+                          "config %u: constant %u gives %u", c, level, output);
+                }
+            }
+            CHECK(outputs > 0, "config %u: no output", c);
+        }
+    }
+}
+
+// a spike among the first samples must not reach the average or the IIR
+static void test_startSpike(void) {
+    for(unsigned c = 0; c < CONFIGS; c++){
+        if(configs[c].medianSize == 0){
+            continue;
+        }
+        for(uint8_t position = 0; position < configs[c].medianSize / 2; position++){
+            adc_filter_t filter;
+            uint16_t output;
+            uint16_t expected = BENCH_LEVEL << configs[c].oversampleBits;
+
+            adc_filterInit(&filter, &configs[c]);
+            for(unsigned n = 0; n < 1000; n++){
+                uint16_t sample = (n == position) ? RAW_MAX : BENCH_LEVEL;
+                if(adc_filterPush(&filter, sample, &output)){
+                    CHECK(output == expected, "config %u: spike at %u gives %u at sample %u",
+                          c, position, output, n);
+                }
+            }
+        }
+    }
+}
+
+// a step settles without overshoot
+static void test_step(void) {
+    for(unsigned c = 0; c < CONFIGS; c++){
+        adc_filter_t filter;
+        uint16_t output;
+        uint16_t low = 200 << configs[c].oversampleBits;
+        uint16_t high = 800 << configs[c].oversampleBits;
+        uint16_t previous = low;
+
+        adc_filterInit(&filter, &configs[c]);
+        for(unsigned n = 0; n < 200000; n++){
+            if(adc_filterPush(&filter, (n < 100) ? 200 : 800, &output)){
+                CHECK(output >= previous && output <= high, "config %u: step gives %u after %u", c, output, previous);
+                previous = output;
+            }
+        }
+        CHECK(previous == high, "config %u: step settles at %u instead of %u", c, previous, high);
+    }
+}
+
+// standard deviation of the noisy stream before and after the pipeline
+static void bench_noise(unsigned c, double * inDeviation, double * outDeviation) {
+    adc_filter_t filter;
+    uint16_t output;
+    double scale = 1.0 / (1 << configs[c].oversampleBits);
+    double inSum = 0, inSquares = 0, outSum = 0, outSquares = 0;
+    long inputs = 0, outputs = 0;
+
+    adc_filterInit(&filter, &configs[c]);
+    srand(1);
+    for(long n = 0; n < BENCH_SAMPLES; n++){
+        uint16_t sample = bench_noisySample(n);
+        inSum += sample;
+        inSquares += (double)sample * sample;
+        inputs++;
+
+        // the settling of the IIR is left out
+        if(adc_filterPush(&filter, sample, &output) && n > BENCH_SAMPLES / 10){
+            double value = output * scale;
+            outSum += value;
+            outSquares += value * value;
+            outputs++;
+        }
+    }
+    *inDeviation = sqrt(inSquares / inputs - (inSum / inputs) * (inSum / inputs));
+    *outDeviation = sqrt(outSquares / outputs - (outSum / outputs) * (outSum / outputs));
+}
+
+static double bench_nsPerSample(unsigned c) {
+    static uint16_t stream[4096];
+    adc_filter_t filter;
+    uint16_t output = 0;
+    unsigned long sink = 0;
+
+    for(unsigned i = 0; i < sizeof(stream) / sizeof(stream[0]); i++){
+        stream[i] = bench_noisySample(i);
+    }
+    adc_filterInit(&filter, &configs[c]);
+
+    clock_t start = clock();
+    for(long n = 0; n < BENCH_TIMING_SAMPLES; n++){
+        if(adc_filterPush(&filter, stream[n & 4095], &output)){
+            sink += output;
+        }
+    }
+    clock_t stop = clock();
+
+    // keeps the loop from being optimized away
+    CHECK(sink != 1, "unexpected sum");
+    return 1e9 * (double)(stop - start) / CLOCKS_PER_SEC / BENCH_TIMING_SAMPLES;
+}
+
+int main(void) {
+    char text[64];
+
+    test_constant();
+    test_startSpike();
+    test_step();
+
+    printf("%-44s %9s %9s %7s\n", "pipeline", "in (LSB)", "out (LSB)", "ns/smp");
+    for(unsigned c = 0; c < CONFIGS; c++){
+        double in, out;
+
+        bench_noise(c, &in, &out);
+        bench_describe(&configs[c], text, sizeof(text));
+        printf("%-44s %9.2f %9.2f %7.1f\n", text, in, out, bench_nsPerSample(c));
+
+        // the full pipeline rejects the spikes and most of the noise
+        if(configs[c].medianSize != 0 && configs[c].iirShift != 0){
+            CHECK(out < in / 10, "config %u: noise only reduced from %.2f to %.2f", c, in, out);
+        }
+    }
+    return host_testResult("test_adc_filter");
+}
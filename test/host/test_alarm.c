@@ -0,0 +1,369 @@
+/*
+ * Host test of lib/ses/ses_alarm.c with thousands of alarms.
+ *
+ * The scheduler is replaced by a simulated clock: scheduler_getDay reads it
+ * and scheduler_setDeadline records when the alarm task is due. The clock
+ * runs minute by minute over several midnights while alarms are added,
+ * changed, snoozed, enabled, disabled and removed at random, the weekday is
+ * moved and the clock is set forwards and backwards. Every firing is
+ * compared with a brute force model which checks all alarms in every minute.
+ * ALARM_MAX can be set on the command line of the compiler.
+ */
+
+#ifndef ALARM_MAX
+#define ALARM_MAX               2000
+#endif
+
+/* INCLUDES ******************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_test.h"
+#include "ses_alarm.c"
+
+/* DEFINES & MACROS **********************************************************/
+
+#define MS_PER_MIN              60000UL
+#define TEST_START_DAY          10
+#define TEST_DAYS               6
+/* most alarms are close to midnight */
+#define TEST_MIDNIGHT_SHARE     2       /* one in n alarms at any time of the day */
+
+/* TYPES *********************************************************************/
+
+/* the alarm as the brute force model sees it */
+typedef struct {
+    bool used;
+    bool enabled;
+    bool snoozed;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t days;
+    uint32_t snoozeAt;      /* minute of the snooze */
+    uint32_t armedSince;    /* fires only after this minute */
+} model_alarm_t;
+
+/* PRIVATE VARIABLES *********************************************************/
+
+static model_alarm_t model[ALARM_MAX];
+static uint8_t modelWeekdayOffset = 0;
+
+static uint32_t nowMs;                  /* simulated time since day 0 */
+static task_descriptor_t * deadlineTask = NULL;
+static uint32_t deadlineAt;
+
+static alarm_id_t fired[ALARM_MAX];
+static unsigned firedCount;
+
+static unsigned long firings = 0;
+
+/* FUNCTION DEFINITION *******************************************************/
+
+uint16_t scheduler_getDay(time_t * clock) {
+    uint32_t msOfDay = nowMs % (ALARM_MIN_PER_DAY * MS_PER_MIN);
+
+    if(clock != NULL){
+        clock->hour   = msOfDay / (MIN_PER_HOUR * MS_PER_MIN);
+        clock->minute = msOfDay / MS_PER_MIN % MIN_PER_HOUR;
+        clock->second = msOfDay / 1000 % SEC_PER_MIN;
+        clock->milli  = msOfDay % 1000;
+    }
+    return nowMs / (ALARM_MIN_PER_DAY * MS_PER_MIN);
+}
+
+void scheduler_setDeadline(task_descriptor_t * td, uint32_t delay) {
+    deadlineTask = td;
+    deadlineAt = nowMs + delay;
+}
+
+static void test_callback(alarm_id_t id) {
+    CHECK(firedCount < ALARM_MAX, "more firings than alarms");
+    if(firedCount < ALARM_MAX){
+        fired[firedCount++] = id;
+    }
+}
+
+static uint32_t test_minute(void) {
+    return nowMs / MS_PER_MIN;
+}
+
+static bool model_matches(const model_alarm_t * alarm, uint32_t minute) {
+    uint32_t day = minute / ALARM_MIN_PER_DAY;
+
+    if(minute % ALARM_MIN_PER_DAY != (uint32_t)alarm->hour * MIN_PER_HOUR + alarm->minute){
+        return false;
+    }
+    return alarm->days == ALARM_ONCE || (alarm->days & (1 << ((day + modelWeekdayOffset) % 7)));
+}
+
+static bool model_fires(const model_alarm_t * alarm, uint32_t minute) {
+    if(!alarm->used || !alarm->enabled){
+        return false;
+    }
+    if(alarm->snoozed){
+        return minute == alarm->snoozeAt;
+    }
+    return minute > alarm->armedSince && model_matches(alarm, minute);
+}
+
+// next firing by trying the following days, UINT32_MAX if disabled
+static uint32_t model_next(const model_alarm_t * alarm) {
+    if(!alarm->used || !alarm->enabled){
+        return UINT32_MAX;
+    }
+    if(alarm->snoozed){
+        return alarm->snoozeAt;
+    }
+    uint32_t day = alarm->armedSince / ALARM_MIN_PER_DAY;
+    for(uint32_t d = day; d <= day + 8; d++){
+        uint32_t minute = d * ALARM_MIN_PER_DAY + alarm->hour * MIN_PER_HOUR + alarm->minute;
+        if(model_fires(alarm, minute)){
+            return minute;
+        }
+    }
+    return UINT32_MAX;
+}
+
+static void model_arm(model_alarm_t * alarm) {
+    alarm->snoozed = false;
+    alarm->armedSince = test_minute();
+}
+
+static int test_compareIds(const void * a, const void * b) {
+    return (int)*(const alarm_id_t *)a - (int)*(const alarm_id_t *)b;
+}
+
+static void test_randomTime(uint8_t * hour, uint8_t * minute) {
+    if(rand() % TEST_MIDNIGHT_SHARE == 0){
+        *hour   = rand() % HOUR_PER_DAY;
+        *minute = rand() % MIN_PER_HOUR;
+    }
+    else{
+        // 23:30 ... 00:29
+        int offset = rand() % MIN_PER_HOUR - 30;
+        *hour   = (offset < 0) ? 23 : 0;
+        *minute = (offset < 0) ? offset + MIN_PER_HOUR : offset;
+    }
+}
+
+static uint8_t test_randomDays(void) {
+    static const uint8_t days[] = { ALARM_ONCE, ALARM_DAILY, ALARM_WEEKDAYS, ALARM_WEEKEND, ALARM_MONDAY, ALARM_SUNDAY };
+
+    if(rand() % 2){
+        return days[rand() % sizeof(days)];
+    }
+    return rand() & ALARM_DAILY;
+}
+
+static void test_add(void) {
+    uint8_t hour, minute, days = test_randomDays();
+    alarm_id_t expected = ALARM_NONE;
+
+    test_randomTime(&hour, &minute);
+    for(alarm_id_t id = 0; id < ALARM_MAX; id++){
+        if(!model[id].used){
+            expected = id;
+            break;
+        }
+    }
+
+    alarm_id_t id = alarm_add(hour, minute, days);
+    CHECK(id == expected, "alarm_add gave slot %u instead of %u", (unsigned)id, (unsigned)expected);
+    if(id != ALARM_NONE && id < ALARM_MAX){
+        model[id] = (model_alarm_t){ .used = true, .enabled = true, .hour = hour, .minute = minute, .days = days };
+        model_arm(&model[id]);
+    }
+}
+
+// one random operation at the current time
+static void test_operation(void) {
+    alarm_id_t id = rand() % ALARM_MAX;
+    model_alarm_t * alarm = &model[id];
+    uint8_t hour, minute;
+
+    switch(rand() % 8){
+    case 0:
+        test_add();
+        break;
+    case 1:
+        CHECK(alarm_remove(id) == alarm->used, "alarm_remove of %u", (unsigned)id);
+        alarm->used = false;
+        break;
+    case 2:
+        test_randomTime(&hour, &minute);
+        {
+            uint8_t days = test_randomDays();
+            CHECK(alarm_set(id, hour, minute, days) == alarm->used, "alarm_set of %u", (unsigned)id);
+            if(alarm->used){
+                alarm->hour = hour;
+                alarm->minute = minute;
+                alarm->days = days;
+                model_arm(alarm);
+            }
+        }
+        break;
+    case 3:
+    case 4:
+        {
+            bool enable = rand() % 2;
+            CHECK(alarm_enable(id, enable) == alarm->used, "alarm_enable of %u", (unsigned)id);
+            if(alarm->used && enable && !alarm->enabled){
+                model_arm(alarm);
+            }
+            if(alarm->used){
+                alarm->snoozed = alarm->snoozed && enable;
+                alarm->enabled = enable;
+            }
+        }
+        break;
+    case 5:
+        {
+            uint8_t minutes = 1 + rand() % 30;
+            CHECK(alarm_snooze(id, minutes) == alarm->used, "alarm_snooze of %u", (unsigned)id);
+            if(alarm->used){
+                alarm->enabled = true;
+                alarm->snoozed = true;
+                alarm->snoozeAt = test_minute() + minutes;
+            }
+        }
+        break;
+    case 6:
+        CHECK(alarm_isEnabled(id) == (alarm->used && alarm->enabled), "alarm_isEnabled of %u", (unsigned)id);
+        {
+            time_t time = { 0 };
+            CHECK(alarm_getTime(id, &time) == alarm->used, "alarm_getTime of %u", (unsigned)id);
+            CHECK(!alarm->used || (time.hour == alarm->hour && time.minute == alarm->minute),
+                  "alarm_getTime of %u gave %02u:%02u", (unsigned)id, time.hour, time.minute);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+// a new weekday or a set clock drops every snooze
+static void test_reschedule(void) {
+    for(alarm_id_t id = 0; id < ALARM_MAX; id++){
+        if(model[id].used && model[id].enabled){
+            model_arm(&model[id]);
+        }
+    }
+}
+
+static void test_checkNext(void) {
+    uint32_t expected = UINT32_MAX, at = 0;
+
+    for(alarm_id_t id = 0; id < ALARM_MAX; id++){
+        uint32_t next = model_next(&model[id]);
+        expected = (next < expected) ? next : expected;
+    }
+
+    alarm_id_t id = alarm_getNext(&at);
+    if(expected == UINT32_MAX){
+        CHECK(id == ALARM_NONE, "alarm_getNext gave %u without enabled alarms", (unsigned)id);
+        return;
+    }
+    CHECK(id < ALARM_MAX && at == expected && model_next(&model[id]) == expected,
+          "alarm_getNext gave %u at %lu, expected %lu", (unsigned)id, (unsigned long)at, (unsigned long)expected);
+
+    // the heap property of all queued alarms
+    for(alarm_id_t position = 1; position < heapSize; position++){
+        CHECK(alarms[heap[(position - 1) / 2]].next <= alarms[heap[position]].next, "heap broken at %u", (unsigned)position);
+        CHECK(alarms[heap[position]].position == position, "position of %u wrong", (unsigned)heap[position]);
+    }
+}
+
+// runs the alarm task if it is due at the start of the minute, compares with the model
+static void test_minuteBoundary(void) {
+    uint32_t minute = test_minute();
+    unsigned expectedCount = 0;
+
+    firedCount = 0;
+    if(deadlineTask != NULL && deadlineAt <= nowMs){
+        CHECK(deadlineAt == nowMs, "deadline at %lu ms, not at the minute %lu",
+              (unsigned long)deadlineAt, (unsigned long)minute);
+        task_descriptor_t * task = deadlineTask;
+        deadlineTask = NULL;
+        task->task(task->param);
+    }
+    qsort(fired, firedCount, sizeof(fired[0]), test_compareIds);
+
+    for(alarm_id_t id = 0; id < ALARM_MAX; id++){
+        model_alarm_t * alarm = &model[id];
+        if(!model_fires(alarm, minute)){
+            continue;
+        }
+        CHECK(expectedCount < firedCount && fired[expectedCount] == id, "alarm %u (%02u:%02u days 0x%02x) missed at minute %lu",
+              (unsigned)id, alarm->hour, alarm->minute, alarm->days, (unsigned long)minute);
+        expectedCount++;
+
+        alarm->snoozed = false;
+        alarm->armedSince = minute;
+        if(alarm->days == ALARM_ONCE){
+            alarm->enabled = false;
+        }
+    }
+    CHECK(expectedCount == firedCount, "%u alarms fired at minute %lu, %u expected",
+          firedCount, (unsigned long)minute, expectedCount);
+    firings += firedCount;
+}
+
+static void test_midnights(void) {
+    uint32_t end = (TEST_START_DAY + TEST_DAYS) * ALARM_MIN_PER_DAY;
+    unsigned long minutes = 0, clockSets = 0;
+
+    srand(1);
+    memset(model, 0, sizeof(model));
+    nowMs = (TEST_START_DAY * ALARM_MIN_PER_DAY - 90) * MS_PER_MIN + 12345;
+    alarm_init(test_callback);
+    alarm_setWeekday(3);
+    modelWeekdayOffset = (3 + 7 - (TEST_START_DAY - 1) % 7) % 7;
+
+    for(alarm_id_t id = 0; id < ALARM_MAX; id++){
+        test_add();
+    }
+    CHECK(alarm_add(0, 0, ALARM_DAILY) == ALARM_NONE, "alarm added with all slots taken");
+    test_checkNext();
+
+    while(test_minute() < end){
+        nowMs = (test_minute() + 1) * MS_PER_MIN;
+        test_minuteBoundary();
+        minutes++;
+
+        // operations at random ms of the minute
+        uint32_t offset = 0;
+        for(uint8_t n = rand() % 8; n > 0; n--){
+            offset += rand() % (MS_PER_MIN / 8);
+            nowMs = test_minute() * MS_PER_MIN + offset;
+            test_operation();
+        }
+
+        if(rand() % 500 == 0){
+            uint8_t weekday = rand() % 7;
+            alarm_setWeekday(weekday);
+            modelWeekdayOffset = (weekday + 7 - scheduler_getDay(NULL) % 7) % 7;
+            test_reschedule();
+        }
+
+        // the clock is set up to half a day forwards or backwards, never before the start
+        if(rand() % 300 == 0){
+            int32_t jump = rand() % ALARM_MIN_PER_DAY - ALARM_MIN_PER_DAY / 2;
+            nowMs = (uint32_t)((int32_t)test_minute() + jump) * MS_PER_MIN + rand() % MS_PER_MIN;
+            alarm_reschedule();
+            test_reschedule();
+            clockSets++;
+        }
+
+        if(minutes % 97 == 0){
+            test_checkNext();
+        }
+    }
+    printf("test_alarm: %u alarms, %lu minutes, %lu firings, %lu clock sets\n",
+           (unsigned)ALARM_MAX, minutes, firings, clockSets);
+}
+
+int main(void) {
+    test_midnights();
+    return host_testResult("test_alarm");
+}
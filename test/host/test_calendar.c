@@ -0,0 +1,210 @@
+/*
+ * Host test of lib/ses/ses_calendar.c over its whole range of dates.
+ *
+ * The scheduler day counter is simulated and runs day by day from the 1st of
+ * January 1980 to the 31st of December 2107, more than a century including
+ * 2000, 2100 and 2107. Every date, weekday and month length is compared with
+ * a days-from-civil reference of the proleptic Gregorian calendar, every day
+ * is packed into a timestamp and unpacked again.
+ */
+
+/* INCLUDES ******************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "host_test.h"
+#include "ses_calendar.c"
+
+/* DEFINES & MACROS **********************************************************/
+
+/* days from 1970-01-01, a Thursday, to the 1st of January of CALENDAR_YEAR_MIN */
+#define REFERENCE_DAY_MIN       3652
+#define REFERENCE_WEEKDAY_EPOCH CALENDAR_THURSDAY
+
+/* PRIVATE VARIABLES *********************************************************/
+
+static uint16_t hostDay = 0;
+static time_t hostClock;
+
+/* FUNCTION DEFINITION *******************************************************/
+
+uint16_t scheduler_getDay(time_t * clock) {
+    if(clock != NULL){
+        *clock = hostClock;
+    }
+    return hostDay;
+}
+
+/* days since 1970-01-01 of a date, after H. Hinnant's days_from_civil */
+static long reference_daysFromCivil(long year, unsigned month, unsigned day) {
+    year -= month <= 2;
+    long era = (year >= 0 ? year : year - 399) / 400;
+    unsigned yearOfEra = (unsigned)(year - era * 400);
+    unsigned dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + (long)dayOfEra - 719468;
+}
+
+/* the date of days since 1970-01-01, the inverse of reference_daysFromCivil */
+static void reference_civilFromDays(long days, long * year, unsigned * month, unsigned * day) {
+    days += 719468;
+    long era = (days >= 0 ? days : days - 146096) / 146097;
+    unsigned dayOfEra = (unsigned)(days - era * 146097);
+    unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    unsigned shifted = (5 * dayOfYear + 2) / 153;
+
+    *day = dayOfYear - (153 * shifted + 2) / 5 + 1;
+    *month = shifted < 10 ? shifted + 3 : shifted - 9;
+    *year = (long)yearOfEra + era * 400 + (*month <= 2);
+}
+
+static uint8_t reference_weekday(long days) {
+    return (uint8_t)((days % 7 + 7 + REFERENCE_WEEKDAY_EPOCH) % 7);
+}
+
+static bool reference_isLeapYear(long year) {
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+static void test_reference(void) {
+    // the reference itself against known dates
+    CHECK(reference_daysFromCivil(CALENDAR_YEAR_MIN, 1, 1) == REFERENCE_DAY_MIN, "reference of 1980-01-01 wrong");
+    CHECK(reference_weekday(reference_daysFromCivil(2000, 1, 1)) == CALENDAR_SATURDAY, "2000-01-01 is a Saturday");
+    CHECK(reference_weekday(reference_daysFromCivil(2100, 3, 1)) == CALENDAR_MONDAY, "2100-03-01 is a Monday");
+    CHECK(reference_weekday(reference_daysFromCivil(2107, 12, 31)) == CALENDAR_SATURDAY, "2107-12-31 is a Saturday");
+}
+
+static void test_leapYears(void) {
+    for(uint16_t year = CALENDAR_YEAR_MIN; year <= CALENDAR_YEAR_MAX; year++){
+        CHECK(calendar_isLeapYear(year) == reference_isLeapYear(year), "leap year %u", year);
+
+        for(uint8_t month = 1; month <= 12; month++){
+            long first = reference_daysFromCivil(year, month, 1);
+            long next = (month == 12) ? reference_daysFromCivil(year + 1, 1, 1) : reference_daysFromCivil(year, month + 1, 1);
+            CHECK(calendar_daysOfMonth(year, month) == next - first, "days of %u-%02u", year, month);
+        }
+    }
+}
+
+// the scheduler passes midnight day by day, sometimes several days at once
+static void test_century(void) {
+    long last = reference_daysFromCivil(CALENDAR_YEAR_MAX, 12, 31);
+    calendar_timestamp_t previous = 0;
+    unsigned long days = 0;
+    date_t date;
+
+    srand(1);
+    hostDay = 0;
+    CHECK(calendar_setDate(CALENDAR_YEAR_MIN, 1, 1), "1980-01-01 rejected");
+
+    for(long reference = REFERENCE_DAY_MIN; reference <= last; ){
+        long year;
+        unsigned month, day;
+
+        reference_civilFromDays(reference, &year, &month, &day);
+        uint8_t weekday = reference_weekday(reference);
+
+        CHECK(calendar_getDate(&date) == hostDay, "day counter of %ld-%02u-%02u", year, month, day);
+        CHECK(date.year == year && date.month == month && date.day == day && date.weekday == weekday,
+              "day %u: %u-%02u-%02u weekday %u, expected %ld-%02u-%02u weekday %u",
+              hostDay, date.year, date.month, date.day, date.weekday, year, month, day, weekday);
+        CHECK(calendar_weekday(year, month, day) == weekday, "weekday of %ld-%02u-%02u", year, month, day);
+
+        // pack and unpack at a random time of the day
+        time_t time = { rand() % HOUR_PER_DAY, rand() % MIN_PER_HOUR, rand() % SEC_PER_MIN, rand() % 1000 };
+        calendar_timestamp_t timestamp = calendar_pack(&date, &time);
+        date_t unpackedDate;
+        time_t unpackedTime;
+
+        CHECK(calendar_unpack(timestamp, &unpackedDate, &unpackedTime), "%ld-%02u-%02u not unpacked", year, month, day);
+        CHECK(unpackedDate.year == date.year && unpackedDate.month == date.month &&
+              unpackedDate.day == date.day && unpackedDate.weekday == date.weekday,
+              "date of %ld-%02u-%02u changed by pack and unpack", year, month, day);
+        CHECK(unpackedTime.hour == time.hour && unpackedTime.minute == time.minute &&
+              unpackedTime.second == (time.second & ~1) && unpackedTime.milli == 0,
+              "time %02u:%02u:%02u changed by pack and unpack", time.hour, time.minute, time.second);
+        CHECK(calendar_pack(&unpackedDate, &unpackedTime) == timestamp, "timestamp of %ld-%02u-%02u not stable", year, month, day);
+        CHECK(timestamp > previous, "timestamps do not increase at %ld-%02u-%02u", year, month, day);
+
+        // the timestamps of the first and the last instant of a day
+        time_t first = { 0, 0, 0, 0 }, end = { 23, 59, 59, 999 };
+        CHECK(calendar_pack(&date, &first) <= timestamp && timestamp <= calendar_pack(&date, &end),
+              "timestamp outside of %ld-%02u-%02u", year, month, day);
+        previous = calendar_pack(&date, &end);
+
+        // a restored date continues like the running one
+        if(rand() % 100 == 0){
+            CHECK(calendar_restore(&date, hostDay), "%ld-%02u-%02u not restored", year, month, day);
+        }
+
+        uint8_t step = (rand() % 200 == 0) ? 1 + rand() % 40 : 1;
+        if(reference + step > last && reference != last){
+            step = (uint8_t)(last - reference);
+        }
+        reference += step;
+        hostDay += step;
+        days++;
+    }
+    printf("test_calendar: %lu days checked up to %u-%02u-%02u\n", days, date.year, date.month, date.day);
+    CHECK(date.year == CALENDAR_YEAR_MAX && date.month == 12 && date.day == 31, "the test ended before 2107-12-31");
+}
+
+static void test_invalid(void) {
+    date_t date;
+    time_t time = { 12, 0, 0, 0 };
+
+    CHECK(!calendar_setDate(2100, 2, 29), "2100-02-29 accepted");
+    CHECK(calendar_setDate(2104, 2, 29), "2104-02-29 rejected");
+    CHECK(calendar_setDate(2000, 2, 29), "2000-02-29 rejected");
+    CHECK(calendar_setDate(2107, 12, 31), "2107-12-31 rejected");
+    CHECK(!calendar_setDate(2108, 1, 1), "2108-01-01 accepted");
+    CHECK(!calendar_setDate(1979, 12, 31), "1979-12-31 accepted");
+    CHECK(!calendar_setDate(2024, 13, 1), "month 13 accepted");
+    CHECK(!calendar_setDate(2024, 4, 31), "2024-04-31 accepted");
+    CHECK(!calendar_setDate(2024, 1, 0), "day 0 accepted");
+
+    // a valid timestamp with one field out of range
+    date = (date_t){ .year = 2100, .month = 2, .day = 28 };
+    calendar_timestamp_t valid = calendar_pack(&date, &time);
+    CHECK(calendar_unpack(valid, NULL, NULL), "2100-02-28 not unpacked");
+    CHECK(!calendar_unpack(valid + (1UL << CALENDAR_TS_DAY), NULL, NULL), "2100-02-29 unpacked");
+    CHECK(!calendar_unpack(valid & ~(0x1FUL << CALENDAR_TS_DAY), NULL, NULL), "day 0 unpacked");
+    CHECK(!calendar_unpack((valid & ~(0x0FUL << CALENDAR_TS_MONTH)) | (13UL << CALENDAR_TS_MONTH), NULL, NULL), "month 13 unpacked");
+    CHECK(!calendar_unpack((valid & ~(0x1FUL << CALENDAR_TS_HOUR)) | (24UL << CALENDAR_TS_HOUR), NULL, NULL), "hour 24 unpacked");
+    CHECK(!calendar_unpack((valid & ~(0x3FUL << CALENDAR_TS_MINUTE)) | (60UL << CALENDAR_TS_MINUTE), NULL, NULL), "minute 60 unpacked");
+    CHECK(!calendar_unpack((valid & ~0x1FUL) | 30, NULL, NULL), "second 60 unpacked");
+
+    date = (date_t){ .year = 2104, .month = 2, .day = 29, .weekday = CALENDAR_SUNDAY + 1 };
+    CHECK(!calendar_restore(&date, 0), "weekday of a restored date not checked");
+    date = (date_t){ .year = 2100, .month = 2, .day = 29, .weekday = CALENDAR_MONDAY };
+    CHECK(!calendar_restore(&date, 0), "2100-02-29 restored");
+}
+
+static void test_timestamp(void) {
+    date_t date;
+    time_t time;
+
+    hostDay = 100;
+    hostClock = (time_t){ 23, 59, 59, 999 };
+    CHECK(calendar_setDate(2099, 12, 31), "2099-12-31 rejected");
+    CHECK(calendar_unpack(calendar_getTimestamp(), &date, &time), "current timestamp not unpacked");
+    CHECK(date.year == 2099 && date.month == 12 && date.day == 31 && time.hour == 23 && time.second == 58,
+          "current timestamp %u-%02u-%02u %02u:%02u:%02u", date.year, date.month, date.day, time.hour, time.minute, time.second);
+
+    // midnight passed, the timestamp belongs to the new day
+    hostDay++;
+    hostClock = (time_t){ 0, 0, 0, 0 };
+    CHECK(calendar_unpack(calendar_getTimestamp(), &date, &time), "timestamp after midnight not unpacked");
+    CHECK(date.year == 2100 && date.month == 1 && date.day == 1 && date.weekday == CALENDAR_FRIDAY,
+          "timestamp after midnight %u-%02u-%02u weekday %u", date.year, date.month, date.day, date.weekday);
+}
+
+int main(void) {
+    test_reference();
+    test_leapYears();
+    test_century();
+    test_invalid();
+    test_timestamp();
+    return host_testResult("test_calendar");
+}
@@ -0,0 +1,159 @@
+/*
+ * Host test of lib/ses/ses_frame.c.
+ *
+ * Without arguments it checks the encoder against the decoder. With --pipe it
+ * serves test_frame_loopback.py, which checks both against tools/ses_frame.py;
+ * it reads one command per line from stdin:
+ *   E <hex payload>   prints the encoded frame as hex
+ *   D <hex bytes>     feeds the bytes to one decoder kept across the lines and
+ *                     prints one word per delimiter: the payload as hex, or -
+ *                     if the frame was rejected
+ */
+
+/* INCLUDES ******************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_test.h"
+#include "ses_frame.c"
+
+/* DEFINES & MACROS **********************************************************/
+
+#define LINE_SIZE               1024
+
+/* FUNCTION DEFINITION *******************************************************/
+
+// decodes a whole buffer, returns the payload length of the last delimiter
+static uint8_t test_decodeAll(frame_decoder_t * decoder, const uint8_t * data, uint8_t len) {
+    uint8_t result = 0;
+
+    for(uint8_t i = 0; i < len; i++){
+        result = frame_decode(decoder, data[i]);
+    }
+    return result;
+}
+
+static void test_roundTrips(void) {
+    uint8_t payload[FRAME_MAX_ENCODE_PAYLOAD];
+    uint8_t encoded[FRAME_ENCODED_SIZE(FRAME_MAX_ENCODE_PAYLOAD)];
+    frame_decoder_t decoder;
+
+    frame_decoderReset(&decoder);
+    srand(1);
+
+    for(unsigned run = 0; run < 20000; run++){
+        uint8_t len = 1 + rand() % FRAME_MAX_PAYLOAD;
+
+        // zeros are frequent, runs of zeros and all-zero payloads included
+        for(uint8_t i = 0; i < len; i++){
+            payload[i] = (rand() % 3 == 0) ? 0 : (uint8_t)rand();
+        }
+        if(run % 100 == 0){
+            memset(payload, 0, len);
+        }
+
+        uint8_t size = frame_encode(payload, len, encoded);
+        CHECK(size == FRAME_ENCODED_SIZE(len), "run %u: encoded %u bytes for %u", run, size, len);
+        CHECK(memchr(encoded, FRAME_DELIMITER, size - 1) == NULL, "run %u: delimiter inside the frame", run);
+
+        uint8_t decoded = test_decodeAll(&decoder, encoded, size);
+        CHECK(decoded == len && memcmp(decoder.data, payload, len) == 0, "run %u: round trip failed", run);
+
+        // any single corrupted byte is rejected, the next frame still decodes
+        uint8_t position = rand() % (size - 1);
+        uint8_t original = encoded[position];
+        encoded[position] ^= 1 + rand() % 255;
+        uint8_t corrupted = test_decodeAll(&decoder, encoded, size);
+        CHECK(corrupted == 0, "run %u: corrupted byte %u accepted", run, position);
+        encoded[position] = original;
+        CHECK(test_decodeAll(&decoder, encoded, size) == len, "run %u: no recovery", run);
+    }
+}
+
+static void test_limits(void) {
+    uint8_t payload[FRAME_MAX_ENCODE_PAYLOAD + 1];
+    uint8_t encoded[FRAME_ENCODED_SIZE(FRAME_MAX_ENCODE_PAYLOAD + 1)];
+    frame_decoder_t decoder;
+
+    frame_decoderReset(&decoder);
+    memset(payload, 0xA5, sizeof(payload));
+
+    // the largest frame which is sent, and one byte more
+    CHECK(frame_encode(payload, FRAME_MAX_ENCODE_PAYLOAD, encoded) == FRAME_ENCODED_SIZE(FRAME_MAX_ENCODE_PAYLOAD),
+          "largest payload not encoded");
+    CHECK(frame_encode(payload, FRAME_MAX_ENCODE_PAYLOAD + 1, encoded) == 0, "too large payload encoded");
+
+    // the largest frame which is received, and one byte more
+    uint8_t size = frame_encode(payload, FRAME_MAX_PAYLOAD, encoded);
+    CHECK(test_decodeAll(&decoder, encoded, size) == FRAME_MAX_PAYLOAD, "largest received payload rejected");
+    size = frame_encode(payload, FRAME_MAX_PAYLOAD + 1, encoded);
+    CHECK(test_decodeAll(&decoder, encoded, size) == 0, "too long received payload accepted");
+    size = frame_encode(payload, 1, encoded);
+    CHECK(test_decodeAll(&decoder, encoded, size) == 1, "no recovery after a too long frame");
+
+    // empty frames and lone delimiters
+    CHECK(frame_decode(&decoder, FRAME_DELIMITER) == 0, "lone delimiter accepted");
+    CHECK(frame_encode(payload, 0, encoded) == FRAME_ENCODED_SIZE(0), "empty payload not encoded");
+    CHECK(test_decodeAll(&decoder, encoded, FRAME_ENCODED_SIZE(0)) == 0, "empty payload accepted");
+}
+
+static int test_hexToBytes(const char * hex, uint8_t * out, int max) {
+    int len = 0;
+    unsigned byte;
+
+    while(sscanf(hex, "%2x", &byte) == 1 && len < max){
+        out[len++] = (uint8_t)byte;
+        hex += 2;
+    }
+    return len;
+}
+
+static int test_pipe(void) {
+    char line[LINE_SIZE];
+    uint8_t data[LINE_SIZE / 2];
+    uint8_t encoded[FRAME_ENCODED_SIZE(FRAME_MAX_ENCODE_PAYLOAD)];
+    frame_decoder_t decoder;
+
+    frame_decoderReset(&decoder);
+
+    while(fgets(line, sizeof(line), stdin) != NULL){
+        line[strcspn(line, "\r\n")] = '\0';
+        int len = test_hexToBytes(line + 2, data, sizeof(data));
+
+        if(line[0] == 'E'){
+            uint8_t size = (len <= FRAME_MAX_ENCODE_PAYLOAD) ? frame_encode(data, (uint8_t)len, encoded) : 0;
+            for(uint8_t i = 0; i < size; i++){
+                printf("%02x", encoded[i]);
+            }
+        }
+        else if(line[0] == 'D'){
+            for(int i = 0; i < len; i++){
+                uint8_t payload = frame_decode(&decoder, data[i]);
+                if(data[i] != FRAME_DELIMITER){
+                    continue;
+                }
+                printf(" ");
+                if(payload == 0){
+                    printf("-");
+                }
+                for(uint8_t j = 0; j < payload; j++){
+                    printf("%02x", decoder.data[j]);
+                }
+            }
+        }
+        printf("\n");
+        fflush(stdout);
+    }
+    return 0;
+}
+
+int main(int argc, char ** argv) {
+    if(argc > 1 && strcmp(argv[1], "--pipe") == 0){
+        return test_pipe();
+    }
+
+    test_roundTrips();
+    test_limits();
+    return host_testResult("test_frame");
+}
@@ -0,0 +1,121 @@
+#!/usr/bin/env python3
+"""Loopback of the frame codec of lib/ses/ses_frame.c against tools/ses_frame.py.
+
+Frames encoded by the C encoder are decoded by the host tools and the other
+way round, through test_frame --pipe. Covers zeros in the payload, CRC errors,
+truncated frames and the largest payloads of both directions.
+
+Run by tools/run_host_tests.py, which passes the directory of the test
+binaries in HOST_TEST_BUILD.
+"""
+
+import os
+import random
+import subprocess
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..', 'tools'))
+from ses_frame import decode_frame, encode_frame  # noqa: E402
+
+# FRAME_MAX_PAYLOAD and FRAME_MAX_ENCODE_PAYLOAD of lib/ses/ses_frame.h
+MAX_RECEIVED = 16
+MAX_SENT = 120
+
+
+class Target:
+    def __init__(self, binary):
+        self.process = subprocess.Popen([binary, '--pipe'], stdin=subprocess.PIPE, stdout=subprocess.PIPE,
+                                        universal_newlines=True)
+
+    def command(self, kind, data):
+        self.process.stdin.write('%s %s\n' % (kind, data.hex()))
+        self.process.stdin.flush()
+        return self.process.stdout.readline().strip()
+
+    def encode(self, payload):
+        return bytes.fromhex(self.command('E', payload))
+
+    def decode(self, stream):
+        """One result per delimiter in stream: the payload, or None if rejected."""
+        words = self.command('D', stream).split()
+        return [None if word == '-' else bytes.fromhex(word) for word in words]
+
+    def close(self):
+        self.process.stdin.close()
+        self.process.wait()
+
+
+def payloads(rng, count, max_len):
+    yield bytes(max_len)
+    yield b'\x00'
+    yield bytes(range(1, max_len + 1))
+    for _ in range(count):
+        length = rng.randint(1, max_len)
+        yield bytes(0 if rng.random() < 0.3 else rng.randint(1, 255) for _ in range(length))
+
+
+def main():
+    binary = os.path.join(os.environ.get('HOST_TEST_BUILD', '.'), 'test_frame')
+    target = Target(binary)
+    rng = random.Random(1)
+    checks = failures = 0
+
+    def check(condition, message):
+        nonlocal checks, failures
+        checks += 1
+        if not condition:
+            failures += 1
+            if failures <= 20:
+                print('test_frame_loopback: ' + message)
+
+    # target -> host, up to the largest response
+    for payload in payloads(rng, 2000, MAX_SENT):
+        frame = target.encode(payload)
+        check(frame == encode_frame(payload), 'C and host encoding differ for %s' % payload.hex())
+        check(frame[-1] == 0 and 0 not in frame[:-1], 'delimiter misplaced for %s' % payload.hex())
+        try:
+            check(decode_frame(frame[:-1]) == payload, 'host decodes %s wrong' % payload.hex())
+        except ValueError as error:
+            check(False, 'host rejects %s: %s' % (payload.hex(), error))
+
+        # a flipped byte fails the CRC or the COBS structure on the host
+        corrupted = bytearray(frame[:-1])
+        position = rng.randrange(len(corrupted))
+        corrupted[position] ^= rng.randint(1, 255)
+        try:
+            decoded = decode_frame(bytes(corrupted))
+        except ValueError:
+            decoded = None
+        check(decoded != payload, 'host accepts a corrupted frame of %s' % payload.hex())
+
+    # host -> target, up to the largest request
+    for payload in payloads(rng, 2000, MAX_RECEIVED):
+        frame = encode_frame(payload)
+        check(target.decode(frame) == [payload], 'C decodes %s wrong' % payload.hex())
+
+        body = bytearray(frame[:-1])
+        body[rng.randrange(len(body))] ^= rng.randint(1, 255)
+        results = target.decode(bytes(body) + b'\x00')
+        check(payload not in results, 'C accepts a corrupted frame of %s' % payload.hex())
+
+        # a frame cut off by a delimiter is dropped, the next one decodes
+        cut = rng.randrange(1, len(frame) - 1)
+        results = target.decode(frame[:cut] + b'\x00' + frame)
+        check(results[-1] == payload and payload not in results[:-1], 'no recovery after a cut frame')
+
+    # a request longer than the receive buffer is dropped, the next one decodes
+    too_long = bytes(rng.randint(1, 255) for _ in range(MAX_RECEIVED + 1))
+    check(target.decode(encode_frame(too_long) + encode_frame(b'\x42')) == [None, b'\x42'],
+          'too long request not dropped')
+
+    # several frames in one stream
+    batch = [bytes([n, 0, n]) for n in range(1, 10)]
+    check(target.decode(b''.join(encode_frame(p) for p in batch)) == batch, 'batch of frames decoded wrong')
+
+    target.close()
+    print('test_frame_loopback: %d checks, %d failed' % (checks, failures))
+    return 1 if failures else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
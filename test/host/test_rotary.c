@@ -0,0 +1,180 @@
+/*
+ * Host test of lib/ses/ses_rotary.c.
+ *
+ * A simulated high-rate edge stream of the A and B inputs drives
+ * rotary_update like the pin change interrupt does: full quadrature
+ * sequences in both directions with contact bounce on every edge, turns
+ * reversed half way, noise on the other pins of port B and edges the
+ * interrupt missed because two of them came too fast. The detents, the
+ * accelerated steps and the callback are checked against the stream.
+ */
+
+/* INCLUDES ******************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "host_test.h"
+#include "ses_rotary.c"
+
+/* DEFINES & MACROS **********************************************************/
+
+#define TEST_DETENTS            100000L
+/* detents of one direction, the position must not wrap around */
+#define TEST_MISSED_DETENTS     20000L
+
+/* inputs (B << 1) | A of a clockwise detent, starting after the detent 11 */
+static const uint8_t clockwise[4] = { 0x1, 0x0, 0x2, 0x3 };
+
+/* PRIVATE VARIABLES *********************************************************/
+
+static system_time_t hostTime = 1000;
+static long callbackSteps = 0;
+static long callbackCalls = 0;
+
+/* FUNCTION DEFINITION *******************************************************/
+
+system_time_t scheduler_getTime(void) {
+    return hostTime;
+}
+
+static void test_callback(int8_t detentSteps) {
+    callbackSteps += detentSteps;
+    callbackCalls++;
+}
+
+// one pin change as PINB, the other pins of port B change at random
+static void test_edge(uint8_t input) {
+    uint8_t others = (uint8_t)rand() & ~(PIN_ROTARY_A_MASK | PIN_ROTARY_B_MASK);
+    uint8_t pins = others | (((input >> 1) & 1) << PIN_ROTARY_B_BIT) | ((input & 1) << PIN_ROTARY_A_BIT);
+
+    rotary_update(pins);
+}
+
+// an edge from one input to the next, bouncing an even number of times
+static void test_bouncingEdge(uint8_t from, uint8_t to, uint8_t bounces) {
+    test_edge(to);
+    for(uint8_t i = 0; i < bounces; i++){
+        test_edge(from);
+        test_edge(to);
+    }
+}
+
+static uint8_t test_input(int8_t direction, uint8_t index) {
+    // counter-clockwise runs the sequence backwards: 10, 00, 01, 11
+    return (direction > 0) ? clockwise[index] : (index == 3) ? 0x3 : clockwise[2 - index];
+}
+
+static int8_t test_expectedSteps(uint16_t interval) {
+    if(interval < ROTARY_ACCEL_FAST_MS){
+        return ROTARY_ACCEL_FAST_STEPS;
+    }
+    if(interval < ROTARY_ACCEL_MEDIUM_MS){
+        return ROTARY_ACCEL_MEDIUM_STEPS;
+    }
+    if(interval < ROTARY_ACCEL_SLOW_MS){
+        return ROTARY_ACCEL_SLOW_STEPS;
+    }
+    return 1;
+}
+
+// every full sequence counts one detent, however much the contacts bounce
+static void test_bouncingStream(void) {
+    long expectedPosition = 0;
+    long expectedSteps = 0;
+    long detents = 0;
+    // the module starts with its last detent at time 0
+    system_time_t lastTime = 0;
+
+    srand(1);
+    rotary_setCallback(test_callback);
+    rotary_takeSteps();
+
+    for(long n = 0; n < TEST_DETENTS; n++){
+        int8_t direction = (rand() % 4 == 0) ? -1 : 1;
+        uint8_t previous = 0x3;
+
+        // detents from less than a ms apart up to slow turns
+        hostTime += rand() % 150;
+
+        // a turn reversed half way back to the detent does not count
+        if(rand() % 8 == 0){
+            uint8_t depth = 1 + rand() % 2;
+            for(uint8_t i = 0; i < depth; i++){
+                uint8_t input = test_input(direction, i);
+                test_bouncingEdge(previous, input, rand() % 4);
+                previous = input;
+            }
+            for(int8_t i = depth - 2; i >= -1; i--){
+                uint8_t input = (i < 0) ? 0x3 : test_input(direction, i);
+                test_bouncingEdge(previous, input, rand() % 4);
+                previous = input;
+            }
+            continue;
+        }
+
+        for(uint8_t i = 0; i < 4; i++){
+            uint8_t input = test_input(direction, i);
+            test_bouncingEdge(previous, input, rand() % 4);
+            previous = input;
+        }
+
+        expectedPosition += direction;
+        expectedSteps += direction * test_expectedSteps((uint16_t)(hostTime - lastTime));
+        lastTime = hostTime;
+        detents++;
+    }
+
+    CHECK(rotary_getPosition() == (int16_t)expectedPosition, "position %d, expected %d",
+          rotary_getPosition(), (int16_t)expectedPosition);
+    CHECK(callbackCalls == detents, "%ld callbacks for %ld detents", callbackCalls, detents);
+    CHECK(callbackSteps == expectedSteps, "callback steps %ld, expected %ld", callbackSteps, expectedSteps);
+
+    // the steps are taken in int16_t portions in the firmware, here once at the end
+    CHECK(rotary_takeSteps() == (int16_t)expectedSteps, "taken steps differ from %ld", expectedSteps);
+    CHECK(rotary_takeSteps() == 0, "steps not reset");
+}
+
+// edges the interrupt misses lose detents, but never count the wrong direction
+static void test_missedEdges(void) {
+    long lost = 0;
+
+    srand(2);
+    rotary_setCallback(NULL);
+
+    for(int8_t direction = -1; direction <= 1; direction += 2){
+        int16_t start = rotary_getPosition();
+        long missed = 0;
+
+        for(long n = 0; n < TEST_MISSED_DETENTS; n++){
+            bool skipped = false;
+
+            hostTime += 1;
+            for(uint8_t i = 0; i < 4; i++){
+                // two edges within one interrupt latency: the first is never seen
+                if(i < 3 && rand() % 16 == 0){
+                    skipped = true;
+                    continue;
+                }
+                test_edge(test_input(direction, i));
+            }
+            missed += skipped;
+        }
+
+        int16_t moved = rotary_getPosition() - start;
+        CHECK(moved * direction >= 0, "direction %d: moved %d the wrong way", direction, moved);
+        CHECK(moved * direction >= TEST_MISSED_DETENTS - missed, "direction %d: moved %d, at least %ld expected",
+              direction, moved, TEST_MISSED_DETENTS - missed);
+        lost += TEST_MISSED_DETENTS - moved * direction;
+    }
+    printf("test_rotary: %ld of %ld detents lost to missed edges\n", lost, 2 * TEST_MISSED_DETENTS);
+}
+
+int main(void) {
+    rotary_init();
+    CHECK((PCMSK0 & (PIN_ROTARY_A_MASK | PIN_ROTARY_B_MASK)) == (PIN_ROTARY_A_MASK | PIN_ROTARY_B_MASK),
+          "pin change interrupt of A and B not enabled");
+
+    test_bouncingStream();
+    test_missedEdges();
+    return host_testResult("test_rotary");
+}
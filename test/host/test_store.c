@@ -0,0 +1,254 @@
+/*
+ * Host test of lib/ses/ses_store.c with power cuts.
+ *
+ * The EEPROM of the ATmega32U4 is emulated behind the EEPROM registers: a
+ * read after EERE loads EEDR, a byte started with EEPE is programmed after a
+ * few steps of the simulation and the EE_READY interrupt runs whenever the
+ * EEPROM is ready and EERIE is set. Random values of random keys are set,
+ * the store task writes them, and the power is cut at random steps, often
+ * while a record is being programmed; the byte being programmed then holds
+ * garbage. After every cut the RAM is lost and store_init must restore the
+ * last completed record of every key. The records per slot show how the
+ * wear spreads over the ring.
+ */
+
+/* INCLUDES ******************************************************************/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_test.h"
+
+/* the data register of the emulated EEPROM, defined before the module includes avr/io.h */
+static volatile uint8_t * host_eedr(void);
+#define EEDR                    (*host_eedr())
+
+#include "ses_store.c"
+
+/* DEFINES & MACROS **********************************************************/
+
+#define TEST_STEPS              2000000L
+#define TEST_KEYS               STORE_MAX_KEYS
+/* steps a byte takes to program, the task runs every TEST_TASK_STEPS */
+#define TEST_BYTE_STEPS         3
+#define TEST_TASK_STEPS         20
+/* one power cut in about so many steps, half of them while a record is programmed */
+#define TEST_CUT_STEPS          4000
+
+/* PRIVATE VARIABLES *********************************************************/
+
+static uint8_t hostEeprom[E2END + 1];
+static uint8_t hostData;
+static uint8_t hostProgramSteps = 0;
+
+// last completed record of every key, what store_init must restore
+static uint8_t expectedValue[TEST_KEYS][STORE_VALUE_SIZE];
+static uint8_t expectedLength[TEST_KEYS];
+
+static unsigned long slotRecords[STORE_SLOTS];
+static unsigned long cellPrograms[E2END + 1];
+static unsigned long cuts = 0, tornCuts = 0, records = 0;
+
+/* FUNCTION DEFINITION *******************************************************/
+
+static volatile uint8_t * host_eedr(void) {
+    if(EECR & (1 << EERE)){
+        EECR &= ~(1 << EERE);
+        hostData = hostEeprom[EEAR];
+    }
+    return &hostData;
+}
+
+void eeprom_read_block(void * dst, const void * src, size_t n) {
+    memcpy(dst, &hostEeprom[(uintptr_t)src], n);
+}
+
+bool scheduler_add(task_descriptor_t * td) {
+    return true;
+}
+
+void scheduler_remove(const task_descriptor_t * td) {
+}
+
+// the record being programmed is in the EEPROM completely
+static bool test_recordComplete(void) {
+    return writeState != STORE_WRITE_IDLE &&
+           memcmp(&hostEeprom[writeAddress], &writeRecord, STORE_RECORD_SIZE) == 0;
+}
+
+static void test_complete(uint8_t key) {
+    memcpy(expectedValue[key], writeRecord.value, STORE_VALUE_SIZE);
+    expectedLength[key] = writeRecord.length;
+}
+
+// one step of the EEPROM: a byte is programmed or the ready interrupt runs
+static void test_eepromStep(void) {
+    if(EECR & (1 << EEPE)){
+        if(--hostProgramSteps == 0){
+            hostEeprom[EEAR] = hostData;
+            cellPrograms[EEAR]++;
+            EECR &= ~((1 << EEPE) | (1 << EEMPE));
+        }
+        return;
+    }
+    if(EECR & (1 << EERIE)){
+        EE_READY_vect();
+        if(EECR & (1 << EEPE)){
+            CHECK(EECR & (1 << EEMPE), "EEPE set without EEMPE");
+            hostProgramSteps = TEST_BYTE_STEPS;
+        }
+        else if(writeState == STORE_WRITE_DONE){
+            test_complete(writeKey);
+        }
+    }
+}
+
+static void test_task(void) {
+    uint8_t before = writeState;
+
+    store_task(NULL);
+    if(before != STORE_WRITE_BUSY && writeState == STORE_WRITE_BUSY){
+        slotRecords[writeSlot]++;
+        records++;
+    }
+}
+
+// the power fails and comes back, only the EEPROM survives
+static void test_powerCut(void) {
+    cuts++;
+    if(EECR & (1 << EEPE)){
+        hostEeprom[EEAR] = (uint8_t)rand();
+        tornCuts++;
+    }
+    // a torn byte which happens to be right completes the record
+    if(test_recordComplete()){
+        test_complete(writeKey);
+    }
+
+    memset(cache, 0xA5, sizeof(cache));
+    memset(&writeRecord, 0, sizeof(writeRecord));
+    memset(&storeStats, 0, sizeof(storeStats));
+    writeState = STORE_WRITE_IDLE;
+    writeIndex = 0;
+    EECR = 0;
+    hostProgramSteps = 0;
+
+    store_init();
+
+    uint8_t restored = 0;
+    for(uint8_t key = 0; key < TEST_KEYS; key++){
+        uint8_t value[STORE_VALUE_SIZE];
+
+        if(expectedLength[key] == 0){
+            CHECK(cache[key].length == 0, "cut %lu: key %u restored without a completed record", cuts, key);
+            continue;
+        }
+        restored++;
+        CHECK(store_get(key, value, expectedLength[key]), "cut %lu: key %u not restored", cuts, key);
+        CHECK(memcmp(value, expectedValue[key], expectedLength[key]) == 0,
+              "cut %lu: key %u restored with an old or torn value", cuts, key);
+    }
+    CHECK(storeStats.restored == restored, "cut %lu: %u keys restored, expected %u", cuts, storeStats.restored, restored);
+    CHECK(!store_isPending(), "cut %lu: restored values are pending", cuts);
+}
+
+// a random value for a random key, the low keys change most often
+static void test_set(void) {
+    uint8_t key = (uint8_t)(rand() % TEST_KEYS) & (uint8_t)(rand() % TEST_KEYS);
+    uint8_t length = 1 + rand() % STORE_VALUE_SIZE;
+    uint8_t value[STORE_VALUE_SIZE];
+
+    for(uint8_t i = 0; i < length; i++){
+        value[i] = (uint8_t)rand();
+    }
+    CHECK(store_set(key, value, length), "key %u length %u rejected", key, length);
+}
+
+static void test_powerCuts(void) {
+    srand(1);
+    memset(hostEeprom, 0xFF, sizeof(hostEeprom));
+    store_init();
+    CHECK(storeStats.restored == 0, "an erased EEPROM restores %u keys", storeStats.restored);
+
+    for(long step = 0; step < TEST_STEPS; step++){
+        if(rand() % 50 == 0){
+            test_set();
+        }
+        if(step % TEST_TASK_STEPS == 0){
+            test_task();
+        }
+        test_eepromStep();
+
+        // half of the cuts hit a record being programmed
+        if(rand() % TEST_CUT_STEPS == 0 || (writeState == STORE_WRITE_BUSY && rand() % (2 * TEST_CUT_STEPS) == 0)){
+            test_powerCut();
+        }
+    }
+    test_powerCut();
+    printf("test_store: %lu records, %lu power cuts, %lu of them during a byte\n", records, cuts, tornCuts);
+}
+
+// the hot keys move over the whole ring, every slot takes its share
+static void test_wear(void) {
+    unsigned long least = slotRecords[0], most = slotRecords[0], cell = 0;
+
+    for(uint8_t slot = 1; slot < STORE_SLOTS; slot++){
+        if(slotRecords[slot] < least){
+            least = slotRecords[slot];
+        }
+        if(slotRecords[slot] > most){
+            most = slotRecords[slot];
+        }
+    }
+    for(uint16_t address = 0; address <= E2END; address++){
+        if(cellPrograms[address] > cell){
+            cell = cellPrograms[address];
+        }
+    }
+    printf("test_store: %u slots, %lu ... %lu records per slot, a cell programmed at most %lu times\n",
+           STORE_SLOTS, least, most, cell);
+
+    CHECK(least > 0, "a slot was never written");
+    CHECK(most <= 2 * records / STORE_SLOTS, "a slot took %lu of %lu records", most, records);
+    CHECK(cell <= most, "a cell was programmed more often than its slot was written");
+}
+
+// an unchanged value costs no record, changes before the write coalesce
+static void test_coalesce(void) {
+    uint8_t value[4] = { 1, 2, 3, 4 };
+
+    memset(hostEeprom, 0xFF, sizeof(hostEeprom));
+    store_init();
+    unsigned long before = records;
+
+    CHECK(store_set(0, value, sizeof(value)), "value rejected");
+    value[0] = 5;
+    CHECK(store_set(0, value, sizeof(value)), "value rejected");
+    for(int step = 0; step < 200; step++){
+        if(step % TEST_TASK_STEPS == 0){
+            test_task();
+        }
+        test_eepromStep();
+    }
+    CHECK(!store_isPending(), "the value is still pending");
+    CHECK(store_set(0, value, sizeof(value)), "value rejected");
+    CHECK(!store_isPending(), "an unchanged value is pending");
+    CHECK(records - before == 1, "%lu records for one coalesced value", records - before);
+
+    CHECK(!store_set(TEST_KEYS, value, 1), "key %u accepted", TEST_KEYS);
+    CHECK(!store_set(0, value, 0), "length 0 accepted");
+    CHECK(!store_set(0, value, STORE_VALUE_SIZE + 1), "length %u accepted", STORE_VALUE_SIZE + 1);
+}
+
+int main(void) {
+    test_coalesce();
+    memset(slotRecords, 0, sizeof(slotRecords));
+    memset(cellPrograms, 0, sizeof(cellPrograms));
+    memset(expectedLength, 0, sizeof(expectedLength));
+    records = 0;
+
+    test_powerCuts();
+    test_wear();
+    return host_testResult("test_store");
+}
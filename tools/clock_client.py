@@ -0,0 +1,185 @@
+#!/usr/bin/env python3
+"""Host client for the binary remote control protocol of the alarm clock.
+
+Requests and responses are frames of tools/ses_frame.py, see
+main/include/Remote_ctrl.h for the commands.
+
+Usage:
+    clock_client.py PORT get-time
+    clock_client.py PORT set-time HH:MM[:SS]
+    clock_client.py PORT get-date
+    clock_client.py PORT set-date YYYY-MM-DD
+    clock_client.py PORT set-alarm HH:MM [--disable]
+    clock_client.py PORT stats
+    clock_client.py PORT store-stats [--watch SECONDS]
+    clock_client.py PORT press push|rotary
+    clock_client.py PORT adc-noise light|poti|temp [--count N]
+"""
+
+import argparse
+import math
+import struct
+import sys
+import time
+
+import serial  # pyserial
+
+from ses_frame import decode_frame, encode_frame
+
+CMD_GET_TIME = 0x01
+CMD_SET_TIME = 0x02
+CMD_SET_ALARM = 0x03
+CMD_GET_STATS = 0x04
+CMD_BUTTON = 0x05
+CMD_ADC_NOISE = 0x07
+CMD_GET_DATE = 0x08
+CMD_SET_DATE = 0x09
+CMD_GET_STORE = 0x0A
+
+RESPONSE_FLAG = 0x80
+STATUS = ['ok', 'wrong length', 'unknown command', 'invalid argument', 'busy']
+BUTTONS = {'push': 0, 'rotary': 1}
+CHANNELS = {'light': 0, 'poti': 6, 'temp': 7}
+ADC_MODES = {'busy wait': 0, 'noise reduced': 1}
+WEEKDAYS = ['Mon', 'Tue', 'Wed', 'Thu', 'Fri', 'Sat', 'Sun']
+
+
+class Clock:
+    def __init__(self, port, timeout=1.0):
+        self.serial = serial.Serial(port, 115200, timeout=timeout)
+
+    def request(self, command, args=b''):
+        self.serial.write(encode_frame(bytes([command]) + args))
+        deadline = time.monotonic() + self.serial.timeout
+        while time.monotonic() < deadline:
+            frame = self.serial.read_until(b'\x00')
+            if not frame.endswith(b'\x00') or len(frame) < 2:
+                continue
+            try:
+                payload = decode_frame(frame[:-1])
+            except ValueError:
+                continue
+            if payload[0] != command | RESPONSE_FLAG:
+                continue
+            if payload[1] != 0:
+                raise RuntimeError(STATUS[payload[1]] if payload[1] < len(STATUS) else 'status %d' % payload[1])
+            return payload[2:]
+        raise TimeoutError('no response')
+
+    def get_time(self):
+        return tuple(self.request(CMD_GET_TIME))
+
+    def set_time(self, hour, minute, second=0):
+        self.request(CMD_SET_TIME, bytes([hour, minute, second]))
+
+    def get_date(self):
+        """Returns year, month, day, weekday (0 is Monday) and the packed timestamp."""
+        return struct.unpack('<HBBBI', self.request(CMD_GET_DATE))
+
+    def set_date(self, year, month, day):
+        self.request(CMD_SET_DATE, struct.pack('<HBB', year, month, day))
+
+    def set_alarm(self, hour, minute, enable=True):
+        self.request(CMD_SET_ALARM, bytes([hour, minute, int(enable)]))
+
+    def stats(self):
+        tasks, executions, overruns, tx_dropped, rx_overflows, peak = struct.unpack('<BIHHHB', self.request(CMD_GET_STATS))
+        return {'tasks': tasks, 'executions': executions, 'overruns': overruns,
+                'tx_dropped': tx_dropped, 'rx_overflows': rx_overflows, 'peak_releases': peak}
+
+    def store_stats(self):
+        records, programmed, restored = struct.unpack('<IIB', self.request(CMD_GET_STORE))
+        return {'records': records, 'bytes': programmed, 'restored': restored}
+
+    def press(self, button):
+        self.request(CMD_BUTTON, bytes([BUTTONS[button]]))
+
+    def adc_noise(self, channel, count, mode):
+        """Returns mean, standard deviation, min, max and duration in us of count conversions."""
+        total, squares, low, high, duration = struct.unpack(
+            '<IIHHH', self.request(CMD_ADC_NOISE, bytes([CHANNELS[channel], count, ADC_MODES[mode]])))
+        mean = total / count
+        return mean, math.sqrt(max(squares / count - mean * mean, 0.0)), low, high, duration
+
+
+def parse_time(text):
+    parts = [int(p) for p in text.split(':')]
+    if len(parts) not in (2, 3):
+        raise argparse.ArgumentTypeError('expected HH:MM[:SS]')
+    return parts + [0] * (3 - len(parts))
+
+
+def parse_date(text):
+    parts = [int(p) for p in text.split('-')]
+    if len(parts) != 3:
+        raise argparse.ArgumentTypeError('expected YYYY-MM-DD')
+    return parts
+
+
+def unpack_timestamp(timestamp):
+    """Splits a timestamp of ses_calendar (FAT layout) into year, month, day, hour, minute, second."""
+    return (1980 + (timestamp >> 25), (timestamp >> 21) & 0x0F, (timestamp >> 16) & 0x1F,
+            (timestamp >> 11) & 0x1F, (timestamp >> 5) & 0x3F, (timestamp & 0x1F) * 2)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('port')
+    sub = parser.add_subparsers(dest='command', required=True)
+    sub.add_parser('get-time')
+    p = sub.add_parser('set-time')
+    p.add_argument('time', type=parse_time)
+    sub.add_parser('get-date')
+    p = sub.add_parser('set-date')
+    p.add_argument('date', type=parse_date)
+    p = sub.add_parser('set-alarm')
+    p.add_argument('time', type=parse_time)
+    p.add_argument('--disable', action='store_true')
+    sub.add_parser('stats')
+    p = sub.add_parser('store-stats')
+    p.add_argument('--watch', type=float, metavar='SECONDS',
+                   help='sample twice and extrapolate the EEPROM writes per day')
+    p = sub.add_parser('press')
+    p.add_argument('button', choices=sorted(BUTTONS))
+    p = sub.add_parser('adc-noise')
+    p.add_argument('channel', choices=sorted(CHANNELS))
+    p.add_argument('--count', type=int, default=64, choices=range(1, 65), metavar='1..64')
+    args = parser.parse_args()
+
+    clock = Clock(args.port)
+    if args.command == 'get-time':
+        print('%02d:%02d:%02d' % clock.get_time())
+    elif args.command == 'set-time':
+        clock.set_time(*args.time)
+    elif args.command == 'get-date':
+        year, month, day, weekday, timestamp = clock.get_date()
+        print('%s %04d-%02d-%02d  timestamp 0x%08x (%04d-%02d-%02d %02d:%02d:%02d)'
+              % ((WEEKDAYS[weekday], year, month, day, timestamp) + unpack_timestamp(timestamp)))
+    elif args.command == 'set-date':
+        clock.set_date(*args.date)
+    elif args.command == 'set-alarm':
+        clock.set_alarm(args.time[0], args.time[1], not args.disable)
+    elif args.command == 'stats':
+        for key, value in clock.stats().items():
+            print('%-13s %d' % (key, value))
+    elif args.command == 'store-stats':
+        first = clock.store_stats()
+        for key, value in first.items():
+            print('%-13s %d' % (key, value))
+        if args.watch:
+            time.sleep(args.watch)
+            second = clock.store_stats()
+            scale = 86400.0 / args.watch
+            print('per day       %.0f records, %.0f bytes'
+                  % ((second['records'] - first['records']) * scale, (second['bytes'] - first['bytes']) * scale))
+    elif args.command == 'press':
+        clock.press(args.button)
+    elif args.command == 'adc-noise':
+        for mode in ADC_MODES:
+            mean, deviation, low, high, duration = clock.adc_noise(args.channel, args.count, mode)
+            print('%-13s mean %7.2f  std dev %5.2f  min %4d  max %4d  %6.1f us/conversion'
+                  % (mode, mean, deviation, low, high, duration / args.count))
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,233 @@
+#!/usr/bin/env python3
+"""Generates the ADC linearisation tables lib/ses/ses_adc_lut.h.
+
+Every table of lib/ses/ses_adc_calibration.csv becomes a flash array of
+breakpoints (raw ADC value, value, shift). The segment from a breakpoint to
+the next one is 2^shift raw counts wide, so the firmware interpolates with a
+multiply and a shift. The segments are found by halving the range 0 ... 1024
+until the interpolation stays within the allowed error of the calibration
+curve: the larger of a percentage of the value and a number of units. Steep
+parts of a curve, like the low end of the light sensor, get short segments,
+flat parts long ones. The calibration points may be spaced freely.
+
+The script runs as PlatformIO pre-build script (extra_scripts in
+main/platformio.ini) and only rewrites the header if its content changed.
+Run standalone it also prints the size and the interpolation error of every
+table. With --print it only prints a table as C initializer for
+adc_setCalibration and leaves the header alone.
+
+Usage:
+    gen_adc_lut.py [--percent P] [--units U] [--csv FILE] [--header FILE]
+    gen_adc_lut.py --print temperature [--percent P] [--units U]
+"""
+
+import argparse
+import os
+import sys
+
+CALIBRATION = os.path.join('lib', 'ses', 'ses_adc_calibration.csv')
+HEADER = os.path.join('lib', 'ses', 'ses_adc_lut.h')
+
+ADC_MAX = 1024
+ADC_SHIFT = 10
+DEFAULT_PERCENT = 2.0
+DEFAULT_UNITS = 2.0
+INT16_MIN, INT16_MAX = -32768, 32767
+# the firmware counts the breakpoints in an uint8_t
+MAX_POINTS = 255
+
+
+def load_calibration(path):
+    """Returns {table: [(raw, value), ...]} sorted by raw value, in file order of the tables."""
+    tables = {}
+    with open(path) as f:
+        for number, line in enumerate(f, 1):
+            line = line.split('#', 1)[0].strip()
+            if not line:
+                continue
+            fields = [field.strip() for field in line.split(',')]
+            if len(fields) != 3:
+                raise ValueError('%s:%d: expected table, raw, value' % (path, number))
+            raw, value = int(fields[1]), int(fields[2])
+            if not 0 <= raw < ADC_MAX:
+                raise ValueError('%s:%d: raw value out of range' % (path, number))
+            tables.setdefault(fields[0], []).append((raw, value))
+    for name, points in tables.items():
+        points.sort()
+        if len(set(raw for raw, _ in points)) != len(points):
+            raise ValueError('%s: table %s has two points with the same raw value' % (path, name))
+    return tables
+
+
+def curve(points, raw):
+    """Calibration curve: linear between the points, held outside of them."""
+    if raw <= points[0][0]:
+        return float(points[0][1])
+    for (x0, y0), (x1, y1) in zip(points, points[1:]):
+        if raw <= x1:
+            return y0 + (y1 - y0) * (raw - x0) / (x1 - x0)
+    return float(points[-1][1])
+
+
+def table_value(points, raw):
+    return min(max(int(round(curve(points, raw))), INT16_MIN), INT16_MAX)
+
+
+def interpolate(y0, y1, offset, shift):
+    """Same integer arithmetic as adc_linearize in ses_adc.c."""
+    return y0 + (((y1 - y0) * offset) >> shift)
+
+
+def allowed(value, percent, units):
+    return max(units, abs(value) * percent / 100.0)
+
+
+def build_table(points, percent, units):
+    """Breakpoints [(raw, value, shift), ...], the last one at 1024 with shift 0."""
+    table = []
+
+    def segment(start, shift):
+        end = start + (1 << shift)
+        y0, y1 = table_value(points, start), table_value(points, end)
+        fits = all(abs(interpolate(y0, y1, raw - start, shift) - curve(points, raw))
+                   <= allowed(curve(points, raw), percent, units)
+                   for raw in range(max(start, points[0][0]), min(end, points[-1][0] + 1)))
+        # a segment of one count is exact at its only raw value
+        if fits or shift == 0:
+            table.append((start, y0, shift))
+        else:
+            segment(start, shift - 1)
+            segment(start + (1 << (shift - 1)), shift - 1)
+
+    segment(0, ADC_SHIFT)
+    table.append((ADC_MAX, table_value(points, ADC_MAX), 0))
+    if len(table) > MAX_POINTS:
+        raise ValueError('more than %d breakpoints, allow a larger error' % MAX_POINTS)
+    return table
+
+
+def linearize(table, raw):
+    for (x0, y0, shift), (_, y1, _) in zip(table, table[1:]):
+        if raw < x0 + (1 << shift):
+            return interpolate(y0, y1, raw - x0, shift)
+    return table[-1][1]
+
+
+def max_error(points, table, percent, units):
+    """Largest deviation from the calibration curve inside the calibrated
+    range as (error, raw value), absolute and in percent of the value. The
+    percentage only counts where it is the allowed error, near 0 the units are."""
+    worst, worst_relative = (0.0, points[0][0]), (0.0, points[0][0])
+    for raw in range(points[0][0], points[-1][0] + 1):
+        value = curve(points, raw)
+        error = abs(linearize(table, raw) - value)
+        worst = max(worst, (error, raw))
+        if abs(value) * percent / 100.0 >= units:
+            worst_relative = max(worst_relative, (100.0 * error / abs(value), raw))
+    return worst, worst_relative
+
+
+def render(tables, source):
+    lines = [
+        '/* generated by tools/gen_adc_lut.py from %s, do not edit */' % source.replace(os.sep, '/'),
+        '#ifndef SES_ADC_LUT_H',
+        '#define SES_ADC_LUT_H',
+        '',
+        '#include <inttypes.h>',
+        '#include <avr/pgmspace.h>',
+        '',
+        '/* breakpoint of a lookup table, the segment up to the next breakpoint',
+        'is 2^shift raw counts wide */',
+        'typedef struct {',
+        '    uint16_t raw;',
+        '    int16_t value;',
+        '    uint8_t shift;',
+        '} adc_lutPoint_t;',
+        '',
+        '/* raw value of the first and the last breakpoint of every table */',
+        '#define ADC_LUT_START                0',
+        '#define ADC_LUT_END                  %d' % ADC_MAX,
+        '',
+        '/* breakpoints per table */',
+    ]
+    for name, table in tables.items():
+        lines.append('#define %-28s %d' % ('ADC_LUT_%s_SIZE' % name.upper(), len(table)))
+    lines += [
+        '',
+        '/* the tables are defined only in the file which defines ADC_LUT_TABLES */',
+        '#ifdef ADC_LUT_TABLES',
+    ]
+    for name, table in tables.items():
+        lines += ['', 'static const adc_lutPoint_t adc_lut_%s[ADC_LUT_%s_SIZE] PROGMEM = {' % (name, name.upper())]
+        for i in range(0, len(table), 4):
+            lines.append('    ' + ' '.join('{ %4d, %6d, %2d },' % point for point in table[i:i + 4]))
+        lines.append('};')
+    lines += ['', '#endif /* ADC_LUT_TABLES */', '', '#endif /* SES_ADC_LUT_H */', '']
+    return '\n'.join(lines)
+
+
+def build_tables(root, csv=CALIBRATION, percent=DEFAULT_PERCENT, units=DEFAULT_UNITS):
+    calibration = load_calibration(os.path.join(root, csv))
+    return calibration, {name: build_table(points, percent, units) for name, points in calibration.items()}
+
+
+def generate(root, csv=CALIBRATION, header=HEADER, percent=DEFAULT_PERCENT, units=DEFAULT_UNITS):
+    calibration, tables = build_tables(root, csv, percent, units)
+    content = render(tables, csv)
+
+    path = os.path.join(root, header)
+    try:
+        with open(path) as f:
+            unchanged = f.read() == content
+    except FileNotFoundError:
+        unchanged = False
+    if not unchanged:
+        with open(path, 'w') as f:
+            f.write(content)
+    return calibration, tables
+
+
+def report(calibration, tables, percent, units):
+    for name, points in calibration.items():
+        (error, raw), (relative, relative_raw) = max_error(points, tables[name], percent, units)
+        print('%-12s %2d points, raw %4d..%4d, %2d breakpoints, max error %.1f at raw %d, %.1f%% at raw %d'
+              % (name, len(points), points[0][0], points[-1][0], len(tables[name]),
+                 error, raw, relative, relative_raw))
+
+
+def main():
+    root = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--percent', type=float, default=DEFAULT_PERCENT,
+                        help='allowed error in percent of the value (default %g)' % DEFAULT_PERCENT)
+    parser.add_argument('--units', type=float, default=DEFAULT_UNITS,
+                        help='allowed error in units of the table, if larger (default %g)' % DEFAULT_UNITS)
+    parser.add_argument('--csv', default=CALIBRATION, help='calibration points, relative to the repository')
+    parser.add_argument('--header', default=HEADER, help='generated header, relative to the repository')
+    parser.add_argument('--print', metavar='TABLE', dest='table',
+                        help='only print a table as C initializer, the header is not written')
+    args = parser.parse_args()
+
+    if args.percent < 0 or args.units < 0:
+        parser.error('the allowed error must not be negative')
+
+    try:
+        if args.table is None:
+            report(*generate(root, args.csv, args.header, args.percent, args.units), args.percent, args.units)
+            return
+        _, tables = build_tables(root, args.csv, args.percent, args.units)
+    except ValueError as error:
+        sys.exit(str(error))
+    if args.table not in tables:
+        sys.exit('unknown table %s' % args.table)
+    table = tables[args.table]
+    print('/* %d breakpoints */' % len(table))
+    print('{ ' + ', '.join('{ %d, %d, %d }' % point for point in table) + ' }')
+
+
+if 'Import' in globals():
+    # run by PlatformIO as pre-build script, the project directory is main/
+    Import('env')  # noqa: F821
+    generate(os.path.join(env.subst('$PROJECT_DIR'), '..'))  # noqa: F821
+elif __name__ == '__main__':
+    main()
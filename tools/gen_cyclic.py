@@ -0,0 +1,299 @@
+#!/usr/bin/env python3
+"""Generates the frame table of the cyclic executive main/include/cyclic_table.h.
+
+The tasks of main/cyclic_tasks.csv (function, parameter, period, WCET) are laid
+out in a major frame of the lcm of the periods, divided into minor frames of
+equal length. The minor frame is the longest one which divides the major
+frame, is not shorter than any WCET and leaves a whole frame between the
+release and the deadline of every job (2 f - gcd(f, period) <= period). The
+jobs are assigned to the frames earliest deadline first; a job is placed in a
+frame which starts at or after its release if it finishes before its deadline
+with the WCETs of the jobs before it in the frame.
+
+Every slot carries the WCET of its task, scheduler_run times the slots on the
+target and logs the ones which run longer.
+
+The table is checked by simulating the executive before it is written: every
+job runs exactly once between its release and its deadline and no frame runs
+into the next. With --simulate the simulation is reported, optionally with
+random execution times up to the WCETs; shorter execution times only move the
+later jobs of a frame forward, so the WCET run is the worst case.
+
+The script runs as PlatformIO pre-build script (extra_scripts in
+main/platformio.ini) and only rewrites the header if its content changed; it
+fails the build if the tasks have no feasible table.
+
+Usage:
+    gen_cyclic.py [--csv FILE] [--header FILE] [--frame MS]
+    gen_cyclic.py --simulate [--cycles N] [--random FRACTION] [--seed N]
+"""
+
+import argparse
+import math
+import os
+import random
+import sys
+
+TASKS = os.path.join('main', 'cyclic_tasks.csv')
+HEADER = os.path.join('main', 'include', 'cyclic_table.h')
+
+US_PER_MS = 1000
+# frame length, frames and slots are uint8_t in the firmware
+UINT8_MAX = 255
+
+
+class Task:
+    def __init__(self, function, param, period, wcet, order):
+        self.function = function
+        self.param = param
+        self.period = period
+        self.wcet = wcet
+        self.order = order
+
+
+def load_tasks(path):
+    tasks = []
+    with open(path) as f:
+        for number, line in enumerate(f, 1):
+            line = line.split('#', 1)[0].strip()
+            if not line:
+                continue
+            fields = [field.strip() for field in line.split(',')]
+            if len(fields) != 4:
+                raise ValueError('%s:%d: expected function, parameter, period, WCET' % (path, number))
+            period, wcet = int(fields[2]), int(fields[3])
+            if period < 1 or wcet < 1 or wcet > period * US_PER_MS:
+                raise ValueError('%s:%d: period or WCET out of range' % (path, number))
+            tasks.append(Task(fields[0], fields[1], period, wcet, len(tasks)))
+    if not tasks:
+        raise ValueError('%s: no tasks' % path)
+    return tasks
+
+
+def frame_candidates(tasks, major):
+    """Valid minor frames in ms, the longest first."""
+    for frame in range(min(major, UINT8_MAX), 0, -1):
+        if major % frame != 0 or major // frame > UINT8_MAX:
+            continue
+        if any(frame * US_PER_MS < task.wcet for task in tasks):
+            continue
+        if all(2 * frame - math.gcd(frame, task.period) <= task.period for task in tasks):
+            yield frame
+
+
+def assign(tasks, major, frame):
+    """Returns the jobs of every frame as lists of (task, release), or None."""
+    pending = sorted(((release, release + task.period, task.order, task)
+                      for task in tasks for release in range(0, major, task.period)),
+                     key=lambda job: (job[1], job[2]))
+    frames = []
+    for index in range(major // frame):
+        start = index * frame * US_PER_MS
+        busy, jobs = 0, []
+        for job in list(pending):
+            release, deadline, _, task = job
+            if release * US_PER_MS > start:
+                continue
+            if start + busy + task.wcet > deadline * US_PER_MS:
+                # a job which does not fit here does not fit in a later frame either
+                return None
+            if busy + task.wcet <= frame * US_PER_MS:
+                jobs.append((task, release))
+                busy += task.wcet
+                pending.remove(job)
+        frames.append(jobs)
+    return frames if not pending else None
+
+
+def build(tasks, frame=None):
+    """Returns (minor frame in ms, frames) of the first feasible frame."""
+    major = math.lcm(*(task.period for task in tasks))
+    candidates = [frame] if frame is not None else list(frame_candidates(tasks, major))
+    for candidate in candidates:
+        if major % candidate != 0:
+            raise ValueError('the minor frame %d ms does not divide the major frame %d ms' % (candidate, major))
+        frames = assign(tasks, major, candidate)
+        if frames is not None:
+            if sum(len(jobs) for jobs in frames) > UINT8_MAX:
+                raise ValueError('more than %d slots' % UINT8_MAX)
+            return candidate, frames
+    raise ValueError('no frame table meets all deadlines (major frame %d ms, utilisation %.0f%%)'
+                     % (major, 100.0 * utilisation(tasks)))
+
+
+def utilisation(tasks):
+    return sum(task.wcet / (task.period * US_PER_MS) for task in tasks)
+
+
+def simulate(tasks, frame, frames, cycles=1, fraction=None, rng=None):
+    """Runs the table like scheduler_run and checks it from the start and
+    finish times alone. Returns (errors, per task [(start - release, finish - release)],
+    busy time per frame, largest spread of the start of a slot over the cycles)."""
+    frame_us = frame * US_PER_MS
+    major_us = frame_us * len(frames)
+    runs = {task.order: [] for task in tasks}
+    errors = []
+    busy = [0] * len(frames)
+    slots = {}
+
+    for cycle in range(cycles):
+        for index, jobs in enumerate(frames):
+            start = cycle * major_us + index * frame_us
+            now = start
+            for position, (task, _) in enumerate(jobs):
+                duration = task.wcet if fraction is None else rng.uniform(fraction, 1.0) * task.wcet
+                runs[task.order].append((now, now + duration))
+                slots.setdefault((index, position), []).append(now - start)
+                now += duration
+            busy[index] = max(busy[index], now - start)
+            if now > start + frame_us:
+                errors.append('frame %d of cycle %d runs %.0f us into the next frame'
+                              % (index, cycle, now - start - frame_us))
+
+    responses = {}
+    for task in tasks:
+        period_us = task.period * US_PER_MS
+        jobs = sorted(runs[task.order])
+        responses[task.order] = []
+        for number in range(cycles * major_us // period_us):
+            release = number * period_us
+            inside = [(s, e) for s, e in jobs if release <= s < release + period_us]
+            if len(inside) != 1:
+                errors.append('%s runs %d times in the period starting at %d us'
+                              % (task.function, len(inside), release))
+                continue
+            started, finished = inside[0]
+            if finished > release + period_us:
+                errors.append('%s released at %d us misses its deadline by %.0f us'
+                              % (task.function, release, finished - release - period_us))
+            responses[task.order].append((started - release, finished - release))
+    jitter = max(max(offsets) - min(offsets) for offsets in slots.values())
+    return errors, responses, busy, jitter
+
+
+def render(tasks, frame, frames, source):
+    major = frame * len(frames)
+    lines = [
+        '/* generated by tools/gen_cyclic.py from %s, do not edit */' % source.replace(os.sep, '/'),
+        '#ifndef CYCLIC_TABLE_H',
+        '#define CYCLIC_TABLE_H',
+        '',
+        '#include <stddef.h>',
+        '#include <avr/pgmspace.h>',
+        '#include "ses_scheduler.h"',
+        '',
+        '/* minor frame of %d ms, major frame of %d ms, utilisation %.0f%% */' % (frame, major, 100.0 * utilisation(tasks)),
+        '#define CYCLIC_FRAME_MS  %d' % frame,
+        '#define CYCLIC_FRAMES    %d' % len(frames),
+        '',
+        '/* the table is defined only in the file which defines CYCLIC_TABLES */',
+        '#ifdef CYCLIC_TABLES',
+        '',
+    ]
+    for function in sorted(set(task.function for task in tasks)):
+        lines.append('void %s(void *);' % function)
+    lines += ['', 'static const scheduler_slot_t cyclic_slots[] PROGMEM = {']
+    width = max(len('{ %s, %s, %d },' % (task.function, task.param, task.wcet)) for task in tasks)
+    first, slot = [], 0
+    for index, jobs in enumerate(frames):
+        first.append(slot)
+        lines.append('    /* frame %d, %d ... %d ms */' % (index, index * frame, (index + 1) * frame))
+        for task, release in jobs:
+            lines.append('    %-*s  /* released at %d ms */'
+                         % (width, '{ %s, %s, %d },' % (task.function, task.param, task.wcet), release))
+            slot += 1
+    first.append(slot)
+    lines += [
+        '};',
+        '',
+        'static const uint8_t cyclic_first[CYCLIC_FRAMES + 1] PROGMEM = {',
+        '    ' + ', '.join(str(value) for value in first),
+        '};',
+        '',
+        'static const scheduler_table_t cyclic_table = {',
+        '    .frameMs = CYCLIC_FRAME_MS,',
+        '    .frames  = CYCLIC_FRAMES,',
+        '    .first   = cyclic_first,',
+        '    .slots   = cyclic_slots,',
+        '};',
+        '',
+        '#endif /* CYCLIC_TABLES */',
+        '',
+        '#endif /* CYCLIC_TABLE_H */',
+        '',
+    ]
+    return '\n'.join(lines)
+
+
+def generate(root, csv=TASKS, header=HEADER, frame=None):
+    tasks = load_tasks(os.path.join(root, csv))
+    frame, frames = build(tasks, frame)
+    errors, _, _, _ = simulate(tasks, frame, frames)
+    if errors:
+        raise ValueError('the frame table fails the simulation: ' + errors[0])
+    content = render(tasks, frame, frames, csv)
+
+    path = os.path.join(root, header)
+    try:
+        with open(path) as f:
+            unchanged = f.read() == content
+    except FileNotFoundError:
+        unchanged = False
+    if not unchanged:
+        with open(path, 'w') as f:
+            f.write(content)
+    return tasks, frame, frames
+
+
+def report(tasks, frame, frames, cycles, fraction, seed):
+    errors, responses, busy, jitter = simulate(tasks, frame, frames, cycles, fraction, random.Random(seed))
+    print('minor frame %d ms, %d frames, major frame %d ms, utilisation %.1f%%'
+          % (frame, len(frames), frame * len(frames), 100.0 * utilisation(tasks)))
+    for index, jobs in enumerate(frames):
+        print('  frame %2d: %5.0f us busy  %s' % (index, busy[index], ' '.join(task.function for task, _ in jobs)))
+    print('%-24s %6s %6s %12s %12s' % ('task', 'period', 'WCET', 'start (us)', 'finish (us)'))
+    for task in tasks:
+        times = responses[task.order]
+        if not times:
+            continue
+        starts = [start for start, _ in times]
+        print('%-24s %4d ms %6d %5.0f..%5.0f %5.0f..%5.0f'
+              % (task.function, task.period, task.wcet, min(starts), max(starts),
+                 min(finish for _, finish in times), max(finish for _, finish in times)))
+    print('start and finish after the release; a slot starts at most %.0f us apart over the cycles' % jitter)
+    for error in errors:
+        print('error: ' + error)
+    print('%s: %d cycles of the major frame' % ('deadlines met' if not errors else 'deadlines MISSED', cycles))
+    return not errors
+
+
+def main():
+    root = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--csv', default=TASKS, help='task declarations, relative to the repository')
+    parser.add_argument('--header', default=HEADER, help='generated header, relative to the repository')
+    parser.add_argument('--frame', type=int, help='minor frame in ms instead of the longest valid one')
+    parser.add_argument('--simulate', action='store_true', help='report the simulation of the table')
+    parser.add_argument('--cycles', type=int, default=1, help='major frames to simulate (default 1)')
+    parser.add_argument('--random', type=float, metavar='FRACTION',
+                        help='execution times uniform between FRACTION * WCET and the WCET')
+    parser.add_argument('--seed', type=int, default=1)
+    args = parser.parse_args()
+
+    if args.random is not None and not 0.0 <= args.random <= 1.0:
+        parser.error('FRACTION must be between 0 and 1')
+
+    try:
+        tasks, frame, frames = generate(root, args.csv, args.header, args.frame)
+    except ValueError as error:
+        sys.exit(str(error))
+    if args.simulate and not report(tasks, frame, frames, args.cycles, args.random, args.seed):
+        sys.exit(1)
+
+
+if 'Import' in globals():
+    # run by PlatformIO as pre-build script, the project directory is main/
+    Import('env')  # noqa: F821
+    generate(os.path.join(env.subst('$PROJECT_DIR'), '..'))  # noqa: F821
+elif __name__ == '__main__':
+    main()
@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+"""Decodes the binary log records of lib/ses/ses_log.h into readable text.
+
+The message dictionary (ID, argument count, format string) is read from
+lib/ses/ses_log_ids.def, the same file the firmware enumerates its IDs from,
+so the decoder always matches the build. Log records arrive in frames of
+tools/ses_frame.py whose first payload byte is 0xC0.
+
+Usage:
+    log_decode.py PORT
+    log_decode.py --file capture.bin
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+from ses_frame import decode_frame, read_frames
+
+LOG_FRAME_TYPE = 0xC0
+DEFAULT_DICTIONARY = os.path.join(os.path.dirname(__file__), '..', 'lib', 'ses', 'ses_log_ids.def')
+
+MESSAGE = re.compile(r'^\s*LOG_MSG\(\s*(\w+)\s*,\s*(\d+)\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)', re.MULTILINE)
+
+
+def load_dictionary(path):
+    """Returns a list of (name, argument count, format) indexed by message ID."""
+    with open(path) as f:
+        return [(name, int(args), fmt) for name, args, fmt in MESSAGE.findall(f.read())]
+
+
+class Decoder:
+    def __init__(self, dictionary):
+        self.dictionary = dictionary
+        self.last_stamp = None
+        self.wraps = 0
+
+    def timestamp(self, stamp):
+        # the target sends the low 16 bits of its ms clock
+        if self.last_stamp is not None and stamp < self.last_stamp:
+            self.wraps += 1
+        self.last_stamp = stamp
+        return (self.wraps << 16) + stamp
+
+    def records(self, payload):
+        """Yields (time in ms, text) for every record of a log frame."""
+        i = 1
+        while i + 3 <= len(payload):
+            log_id, stamp = payload[i], struct.unpack_from('<H', payload, i + 1)[0]
+            i += 3
+            if log_id >= len(self.dictionary):
+                yield self.timestamp(stamp), 'unknown log ID %d' % log_id
+                return
+            name, count, fmt = self.dictionary[log_id]
+            args = list(struct.unpack_from('<%dH' % count, payload, i))
+            i += 2 * count
+            yield self.timestamp(stamp), self.format(fmt, args)
+
+    @staticmethod
+    def format(fmt, args):
+        # %d arguments were recorded as signed 16 bit values
+        specs = re.findall(r'%[-0-9]*([a-zA-Z])', fmt)
+        for n, spec in enumerate(specs[:len(args)]):
+            if spec in 'di' and args[n] >= 0x8000:
+                args[n] -= 0x10000
+        try:
+            return fmt % tuple(args)
+        except (TypeError, ValueError):
+            return '%s %s' % (fmt, args)
+
+
+def frames_from_file(path):
+    with open(path, 'rb') as f:
+        for raw in f.read().split(b'\x00'):
+            if raw:
+                try:
+                    yield decode_frame(raw)
+                except ValueError:
+                    continue
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('port', nargs='?')
+    parser.add_argument('--file', help='decode a captured byte stream instead of a serial port')
+    parser.add_argument('--dictionary', default=DEFAULT_DICTIONARY)
+    args = parser.parse_args()
+
+    if args.file:
+        frames = frames_from_file(args.file)
+    elif args.port:
+        import serial  # pyserial
+        frames = read_frames(serial.Serial(args.port, 115200))
+    else:
+        parser.error('either PORT or --file is required')
+
+    decoder = Decoder(load_dictionary(args.dictionary))
+    for payload in frames:
+        if payload[0] != LOG_FRAME_TYPE:
+            continue
+        for stamp, text in decoder.records(payload):
+            print('%10.3f  %s' % (stamp / 1000.0, text))
+
+
+if __name__ == '__main__':
+    sys.exit(main())
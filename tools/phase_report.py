@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+"""Reports the number of tasks the scheduler releases per tick, without and
+with the release offsets scheduler_add chooses for tasks with autoPhase set.
+
+The offsets are chosen like scheduler_choosePhase in lib/ses/ses_scheduler.c:
+the offset 1 ... period which shares release ticks with the fewest periodic
+tasks added before, the earliest of equal ones. Two tasks ever release in the
+same tick exactly if their offsets differ by a multiple of the gcd of their
+periods. The loads are counted over one hyperperiod (the lcm of the periods).
+
+A task is given as NAME:PERIOD, or NAME:PERIOD:fixed for a task which keeps
+expire == period; tasks are added in the given order, all before the
+scheduler starts. The default task set is the one of main/src/main.c.
+
+Usage:
+    phase_report.py [--tasks NAME:PERIOD[:fixed] ...] [--ticks N]
+"""
+
+import argparse
+import math
+import sys
+
+# task set of main.c in the order of the scheduler_add calls
+DEFAULT_TASKS = [
+    'usbserial:2',
+    'log:10',
+    'telemetry:1:fixed',
+    'store:100',
+    'remote:10',
+    'ledpattern:1:fixed',
+]
+
+
+def parse_task(text):
+    fields = text.split(':')
+    if len(fields) not in (2, 3) or (len(fields) == 3 and fields[2] != 'fixed'):
+        raise argparse.ArgumentTypeError('expected NAME:PERIOD[:fixed], got %r' % text)
+    period = int(fields[1])
+    if not 1 <= period <= 0xFFFF:
+        raise argparse.ArgumentTypeError('period of %s out of range' % fields[0])
+    return fields[0], period, len(fields) == 2
+
+
+def choose_phase(period, added):
+    """Mirror of scheduler_choosePhase, added is a list of (period, expire)."""
+    best, best_collisions = period, None
+    for offset in range(1, period + 1):
+        collisions = sum(1 for p, expire in added if (offset - expire) % math.gcd(period, p) == 0)
+        if best_collisions is None or collisions < best_collisions:
+            best, best_collisions = offset, collisions
+            if collisions == 0:
+                break
+    return best
+
+
+def schedule(tasks, phased):
+    """Returns the list of (name, period, expire) after adding all tasks."""
+    added = []
+    for name, period, auto in tasks:
+        expire = choose_phase(period, [(p, e) for _, p, e in added]) if phased and auto and period > 1 else period
+        added.append((name, period, expire))
+    return added
+
+
+def loads(added, ticks):
+    """Tasks released in each tick 1 ... ticks."""
+    load = [0] * (ticks + 1)
+    for _, period, expire in added:
+        for tick in range(expire, ticks + 1, period):
+            load[tick] += 1
+    return load[1:]
+
+
+def report(title, added, ticks):
+    load = loads(added, ticks)
+    peak = max(load)
+    print('%s: peak %u tasks per tick, mean %.2f' % (title, peak, sum(load) / len(load)))
+    print('  offsets: ' + ', '.join('%s %u/%u' % (name, expire, period) for name, period, expire in added))
+    for count in range(peak + 1):
+        ticks_with = load.count(count)
+        print('  %2u tasks: %6u ticks %s' % (count, ticks_with, '#' * round(40 * ticks_with / len(load))))
+    return peak
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--tasks', nargs='+', type=parse_task, default=[parse_task(t) for t in DEFAULT_TASKS])
+    parser.add_argument('--ticks', type=int, help='ticks to count, default one hyperperiod')
+    args = parser.parse_args()
+
+    ticks = args.ticks or math.lcm(*(period for _, period, _ in args.tasks))
+    before = report('expire == period', schedule(args.tasks, False), ticks)
+    after = report('autoPhase', schedule(args.tasks, True), ticks)
+    print('peak %u -> %u over %u ticks' % (before, after, ticks))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
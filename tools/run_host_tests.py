@@ -0,0 +1,71 @@
+#!/usr/bin/env python3
+"""Builds and runs the host tests of test/host.
+
+Every test_*.c is compiled with the host C compiler against the avr-libc
+stubs of test/host/stub; the tests include the module of lib/ses they test.
+The C tests run first, then every test_*.py with the directory of the test
+binaries in HOST_TEST_BUILD. A test fails with a nonzero exit code.
+
+Usage:
+    run_host_tests.py [--cc CC] [--build DIR] [-D NAME=VALUE ...] [TEST ...]
+    run_host_tests.py -D ALARM_MAX=5000 test_alarm
+"""
+
+import argparse
+import glob
+import os
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+TESTS = os.path.join(ROOT, 'test', 'host')
+
+CFLAGS = ['-std=c11', '-O2', '-Wall', '-Wextra', '-Wno-unused-function', '-Wno-unused-parameter',
+          '-I', os.path.join(TESTS, 'stub'), '-I', TESTS,
+          '-I', os.path.join(ROOT, 'lib', 'ses'), '-I', os.path.join(ROOT, 'main', 'include')]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--cc', default=os.environ.get('CC', 'cc'), help='host C compiler')
+    parser.add_argument('--build', default=os.path.join(tempfile.gettempdir(), 'ses_host_tests'), help='directory of the test binaries')
+    parser.add_argument('-D', dest='defines', action='append', default=[], metavar='NAME=VALUE',
+                        help='macro for the C tests, e.g. the size of a module')
+    parser.add_argument('tests', nargs='*', help='names of the tests to run, default all')
+    args = parser.parse_args()
+
+    os.makedirs(args.build, exist_ok=True)
+    sources = sorted(glob.glob(os.path.join(TESTS, 'test_*.c')))
+    scripts = sorted(glob.glob(os.path.join(TESTS, 'test_*.py')))
+    if args.tests:
+        wanted = set(args.tests)
+        sources = [s for s in sources if os.path.splitext(os.path.basename(s))[0] in wanted]
+        scripts = [s for s in scripts if os.path.splitext(os.path.basename(s))[0] in wanted]
+
+    failed = []
+    for source in sources:
+        name = os.path.splitext(os.path.basename(source))[0]
+        binary = os.path.join(args.build, name)
+        if subprocess.call([args.cc] + CFLAGS + ['-D' + define for define in args.defines]
+                           + ['-o', binary, source, '-lm']) != 0:
+            failed.append(name + ' (build)')
+        elif subprocess.call([binary]) != 0:
+            failed.append(name)
+
+    # the scripts drive the binaries, which are built even if not selected
+    environment = dict(os.environ, HOST_TEST_BUILD=args.build)
+    for script in scripts:
+        name = os.path.splitext(os.path.basename(script))[0]
+        if subprocess.call([sys.executable, script], env=environment) != 0:
+            failed.append(name)
+
+    if failed:
+        print('failed: ' + ', '.join(failed))
+        return 1
+    print('all %d host tests passed' % (len(sources) + len(scripts)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
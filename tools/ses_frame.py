@@ -0,0 +1,79 @@
+"""Frame format of lib/ses/ses_frame.h for host tools.
+
+Frames are COBS encoded, terminated by 0x00 and carry a CRC-16 (reflected
+polynomial 0x1021, start value 0xFFFF, little endian) behind the payload.
+"""
+
+import struct
+
+
+def crc16(data):
+    crc = 0xFFFF
+    for byte in data:
+        byte ^= crc & 0xFF
+        byte = (byte ^ (byte << 4)) & 0xFF
+        crc = ((byte << 8) | (crc >> 8)) ^ (byte >> 4) ^ (byte << 3)
+        crc &= 0xFFFF
+    return crc
+
+
+def cobs_encode(data):
+    out = bytearray([0])
+    code_index, code = 0, 1
+    for byte in data:
+        if byte == 0:
+            out[code_index] = code
+            code_index, code = len(out), 1
+            out.append(0)
+        else:
+            out.append(byte)
+            code += 1
+            if code == 0xFF:
+                out[code_index] = code
+                code_index, code = len(out), 1
+                out.append(0)
+    out[code_index] = code
+    return bytes(out)
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0:
+            raise ValueError('zero inside frame')
+        if i + code > len(data):
+            raise ValueError('block runs past the end of the frame')
+        out += data[i + 1:i + code]
+        i += code
+        if code != 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def encode_frame(payload):
+    body = payload + struct.pack('<H', crc16(payload))
+    return cobs_encode(body) + b'\x00'
+
+
+def decode_frame(frame):
+    body = cobs_decode(frame)
+    if len(body) < 3:
+        raise ValueError('frame too short')
+    payload, crc = body[:-2], struct.unpack('<H', body[-2:])[0]
+    if crc16(payload) != crc:
+        raise ValueError('CRC mismatch')
+    return payload
+
+
+def read_frames(port):
+    """Yields the payloads of all valid frames received on a serial port."""
+    while True:
+        frame = port.read_until(b'\x00')
+        if not frame.endswith(b'\x00') or len(frame) < 2:
+            continue
+        try:
+            yield decode_frame(frame[:-1])
+        except ValueError:
+            continue
@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+"""Receives the sensor telemetry stream of lib/ses/ses_telemetry.h.
+
+Optionally starts the channels through the remote control protocol, then
+prints once per second the achieved sample rate per channel and the frames
+lost on the way (gaps in the per-channel sequence numbers).
+
+Usage:
+    telemetry_rx.py PORT [--light MS] [--poti MS] [--temp MS] [--csv FILE]
+"""
+
+import argparse
+import struct
+import sys
+import time
+
+import serial  # pyserial
+
+from ses_frame import encode_frame, read_frames
+
+TELEMETRY_FRAME_TYPE = 0xD0
+HEADER = struct.Struct('<BBHIH')
+CMD_TELEMETRY = 0x06
+CHANNELS = {'light': 0, 'poti': 6, 'temp': 7}
+
+
+class ChannelStats:
+    def __init__(self):
+        self.next_sequence = None
+        self.frames = 0
+        self.dropped = 0
+        self.samples = 0
+
+    def update(self, sequence, samples):
+        if self.next_sequence is not None:
+            self.dropped += (sequence - self.next_sequence) & 0xFFFF
+        self.next_sequence = (sequence + 1) & 0xFFFF
+        self.frames += 1
+        self.samples += samples
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('port')
+    for name in CHANNELS:
+        parser.add_argument('--' + name, type=int, metavar='MS', help='start the %s channel with this sample period' % name)
+    parser.add_argument('--csv', help='append all samples as channel,time_ms,value')
+    args = parser.parse_args()
+
+    port = serial.Serial(args.port, 115200, timeout=0.5)
+    for name, channel in CHANNELS.items():
+        period = getattr(args, name)
+        if period is not None:
+            port.write(encode_frame(struct.pack('<BBH', CMD_TELEMETRY, channel, period)))
+
+    csv = open(args.csv, 'a') if args.csv else None
+    stats = {}
+    start = last_report = time.monotonic()
+
+    for payload in read_frames(port):
+        if payload[0] != TELEMETRY_FRAME_TYPE or len(payload) < HEADER.size:
+            continue
+        _, channel, sequence, stamp, period = HEADER.unpack_from(payload)
+        samples = struct.unpack_from('<%dH' % ((len(payload) - HEADER.size) // 2), payload, HEADER.size)
+        stats.setdefault(channel, ChannelStats()).update(sequence, len(samples))
+        if csv:
+            for n, value in enumerate(samples):
+                csv.write('%d,%d,%d\n' % (channel, stamp + n * period, value))
+
+        now = time.monotonic()
+        if now - last_report >= 1.0:
+            elapsed = now - start
+            total = 0.0
+            for ch in sorted(stats):
+                s = stats[ch]
+                total += s.samples / elapsed
+                print('ch%d: %8.1f samples/s  %6d frames  %4d dropped' % (ch, s.samples / elapsed, s.frames, s.dropped))
+            print('aggregate: %.1f samples/s' % total)
+            last_report = now
+
+
+if __name__ == '__main__':
+    sys.exit(main())